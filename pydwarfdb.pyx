@@ -8,11 +8,12 @@
 
 cimport pydwarfdb_c as sym
 
+from cython.operator cimport dereference as deref
+from cpython.bytes cimport PyBytes_FromStringAndSize
 from libcpp.string cimport string
 from libcpp cimport bool
 from libcpp cimport vector
 from libcpp cimport pair
-from libcpp.cast cimport dynamic_cast
 
 from libc.stdint cimport uintptr_t
 from libc.stdint cimport int8_t
@@ -52,15 +53,13 @@ ctypedef sym.Typedef* TypedefPtr;
 cdef ConvBaseType(sym.BaseType* ptr):
 	if not ptr:
 		return
-	cdef StructPtr ps = dynamic_cast[StructPtr](ptr)
-	if ps:
-		return Struct(<uintptr_t> ps)
-	cdef UnionPtr pu = dynamic_cast[UnionPtr](ptr)
-	if pu:
-		return Union(<uintptr_t> pu)
-	cdef TypedefPtr pt = dynamic_cast[TypedefPtr](ptr)
-	if pt:
-		return Typedef(<uintptr_t> pt)
+	cdef sym.SymbolKind kind = ptr.getKind()
+	if kind == sym.KIND_STRUCT:
+		return Struct(<uintptr_t> <StructPtr> ptr)
+	if kind == sym.KIND_UNION:
+		return Union(<uintptr_t> <UnionPtr> ptr)
+	if kind == sym.KIND_TYPEDEF:
+		return Typedef(<uintptr_t> <TypedefPtr> ptr)
 	return BaseType(<uintptr_t> ptr)
 
 class InstantiationNotAllowed(Exception):
@@ -92,6 +91,10 @@ cdef class SymbolManager:
 		"""Returns a L{Function} with the given name or None"""
 		cdef sym.Function* ptr = self.sm_ptr.findFunctionByName(name)
 		return Function(<uintptr_t> ptr) if ptr else None
+	def findFunctionByAddress(self, uint64_t address):
+		"""Returns the L{Function} whose code contains address or None"""
+		cdef sym.Function* ptr = self.sm_ptr.findFunctionByAddress(address)
+		return Function(<uintptr_t> ptr) if ptr else None
 	def findVariableByName(self, string name):
 		"""Returns a L{Variable} with the given name or None"""
 		cdef sym.Variable* ptr = self.sm_ptr.findVariableByName(name)
@@ -126,6 +129,24 @@ cdef class SymbolManager:
 		return self.sm_ptr.numberOfSymbols()
 	def getVarNames(self):
 		return self.sm_ptr.getVarNames()
+	def getWarnings(self):
+		"""Returns the problems that did not stop the parses, e.g. missing split DWARF files"""
+		return self.sm_ptr.getWarnings()
+	def saveDatabase(self, string filename, string binary):
+		"""Writes all symbols to the symbol database filename, keyed by the binary they were parsed from"""
+		self.sm_ptr.saveDatabase(filename, sym.DatabaseKey.fromFilename(binary))
+	def loadDatabase(self, string filename, string binary):
+		"""Loads the symbol database filename, returns False if it is missing or was not created from binary"""
+		return self.sm_ptr.loadDatabase(filename, sym.DatabaseKey.fromFilename(binary))
+	def loadElfSymbols(self, string filename):
+		"""Adds the symbols of the .symtab and .dynsym sections of the elf file filename, returns their number"""
+		return self.sm_ptr.loadElfSymbols(filename)
+	def freeze(self):
+		"""Makes the manager read-only, afterwards queries take no locks and adding symbols raises an error"""
+		self.sm_ptr.freeze()
+	def isFrozen(self):
+		"""Returns True once freeze() was called"""
+		return self.sm_ptr.isFrozen()
 
 #		uint64_t getSystemMapAddress(const string &name, bool priv);
 #		uint64_t getSymbolAddress(const string &name,
@@ -147,11 +168,120 @@ cdef class SymbolManager:
 
 	def getContainingSymbol(self, uint64_t address):
 		return self.sm_ptr.getContainingSymbol(address)
+	def symbolize(self, addresses):
+		"""Returns (name, offset, L{Function} or None) for each address in addresses, None where no symbol contains it"""
+		cdef vector.vector[uint64_t] caddresses = addresses
+		cdef vector.vector[sym.AddressInfo] infos = self.sm_ptr.symbolize(caddresses)
+		result = []
+		for info in infos:
+			if not info.name:
+				result.append(None)
+				continue
+			fun = Function(<uintptr_t> info.function) if info.function else None
+			result.append((deref(info.name), info.offset, fun))
+		return result
 
 cdef class DwarfParser:
 	@staticmethod
-	def parseDwarfFromFilename(string filename, SymbolManager mgr):
-		return sym.DwarfParser.parseDwarfFromFilename(filename, mgr.sm_ptr)
+	def parseDwarfFromFilename(string filename, SymbolManager mgr, unsigned int threads = 1, bint native = False):
+		"""Parses all compilation units of filename into mgr, using threads workers (0: one per core) and the built-in decoder instead of libdwarf if native is set"""
+		return sym.DwarfParser.parseDwarfFromFilename(filename, mgr.sm_ptr, threads, native)
+	@staticmethod
+	def parseDwarfFromFilenames(filenames, SymbolManager mgr, unsigned int threads = 1, bint native = False):
+		"""Parses several files into mgr, types equal to ones of earlier files are shared"""
+		cdef vector.vector[string] names = filenames
+		sym.DwarfParser.parseDwarfFromFilenames(names, mgr.sm_ptr, threads, native)
+	@staticmethod
+	def parseDwarfFromFilenameCached(string filename, string dbFilename, SymbolManager mgr, unsigned int threads = 1, bint native = False):
+		"""Like parseDwarfFromFilename, but loads mgr from the symbol database dbFilename if it is up to date and writes it otherwise"""
+		return sym.DwarfParser.parseDwarfFromFilenameCached(filename, dbFilename, mgr.sm_ptr, threads, native)
+	@staticmethod
+	def parseDwarfFromFilenameLazy(string filename, SymbolManager mgr):
+		"""Only indexes the names of filename, mgr creates the symbols on first lookup by name or id"""
+		return sym.DwarfParser.parseDwarfFromFilenameLazy(filename, mgr.sm_ptr)
+
+
+cdef class DebugFile:
+	@staticmethod
+	def setDebugDirectories(dirs):
+		"""Sets the directories searched for separate debug files (default: /usr/lib/debug)"""
+		cdef vector.vector[string] cdirs = dirs
+		sym.DebugFile.setDebugDirectories(cdirs)
+	@staticmethod
+	def getDebugDirectories():
+		return sym.DebugFile.getDebugDirectories()
+	@staticmethod
+	def find(string filename):
+		"""Returns the separate debug file of filename found by build id or .gnu_debuglink, or filename itself"""
+		return sym.DebugFile.find(filename)
+
+
+cdef class SymbolStore:
+	"""Read only symbols served directly from a mapped symbol database"""
+	cdef sym.SymbolStore* store_ptr
+	def __cinit__(self, string filename):
+		self.store_ptr = new sym.SymbolStore(filename)
+	def __dealloc__(self):
+		del self.store_ptr
+	cdef wrap(self, sym.StoredSymbol symbol):
+		if not symbol.isValid():
+			return None
+		result = StoredSymbol(self)
+		(<StoredSymbol> result).symbol = symbol
+		return result
+	def matches(self, string binary):
+		"""Returns True if the database was created from the current version of binary"""
+		return self.store_ptr.matches(sym.DatabaseKey.fromFilename(binary))
+	def findSymbolByID(self, uint64_t typeID):
+		return self.wrap(self.store_ptr.findSymbolByID(typeID))
+	def findBaseTypeByName(self, string name):
+		return self.wrap(self.store_ptr.findBaseTypeByName(name))
+	def findRefBaseTypeByName(self, string name):
+		return self.wrap(self.store_ptr.findRefBaseTypeByName(name))
+	def findFunctionByName(self, string name):
+		return self.wrap(self.store_ptr.findFunctionByName(name))
+	def findVariableByName(self, string name):
+		return self.wrap(self.store_ptr.findVariableByName(name))
+	def getSymbolAddress(self, const string &name):
+		return self.store_ptr.getSymbolAddress(name)
+	def numberOfSymbols(self):
+		return self.store_ptr.numberOfSymbols()
+
+cdef class StoredSymbol:
+	"""A symbol of a L{SymbolStore}, keeps the store alive"""
+	cdef sym.StoredSymbol symbol
+	cdef SymbolStore store
+	def __cinit__(self, SymbolStore store):
+		self.store = store
+	def getID(self):
+		return self.symbol.getID()
+	def getKind(self):
+		return self.symbol.getKindName()
+	def getName(self):
+		return self.symbol.getName()
+	def getByteSize(self):
+		return self.symbol.getByteSize()
+	def getEncoding(self):
+		return self.symbol.getEncoding()
+	def getType(self):
+		return self.store.wrap(self.symbol.getType())
+	def getAddress(self):
+		return self.symbol.getAddress()
+	def getLength(self):
+		return self.symbol.getLength()
+	def getMemberLocation(self):
+		return self.symbol.getMemberLocation()
+	def getBitSize(self):
+		return self.symbol.getBitSize()
+	def getBitOffset(self):
+		return self.symbol.getBitOffset()
+	def getMembers(self):
+		return [self.store.wrap(self.symbol.getMember(i))
+		        for i in range(self.symbol.getMemberCount())]
+	def memberByName(self, string name):
+		return self.store.wrap(self.symbol.memberByName(name))
+	def memberByOffset(self, uint32_t offset):
+		return self.store.wrap(self.symbol.memberByOffset(offset))
 
 
 cdef class Symbol:
@@ -213,10 +343,11 @@ cdef class BaseType(Symbol):
 			del self.BaseType_ptr
 	def getEncoding(self):
 		return self.BaseType_ptr.getEncoding()
-	def getInstance(self, uint64_t typeID):
-		instance = self.BaseType_ptr.getInstance(typeID)
+	def getInstance(self, uint64_t typeID, MemoryReader reader = None):
+		"""Returns an L{Instance} at address typeID that reads its values from reader"""
+		instance = self.BaseType_ptr.getInstance(typeID, reader.reader_ptr if reader is not None else NULL)
 		p_instance = Instance()
-		p_instance.setInstance(instance)
+		p_instance.setInstance(instance, reader)
 		return p_instance
 	#def getValue(self, uint64_t va, uint64_t pid = 0):
 	#	 encoding = self.BaseType_ptr.getEncoding()
@@ -382,6 +513,11 @@ cdef class Function(BaseType):
 
 	def getAddress(self):
 		return self.Function_ptr.getAddress()
+	def getRanges(self):
+		"""Returns the [begin, end) address ranges of the code as a list of tuples"""
+		return self.Function_ptr.getRanges()
+	def containsAddress(self, uint64_t address):
+		return self.Function_ptr.containsAddress(address)
 #	vector[pair[string, uint64_t]] getParamList() const;
 #	vector[pair[string, BaseType]] getFullParamList() const;
 	def getParamByName(self, const string& name):
@@ -485,18 +621,21 @@ cdef class Variable(Symbol):
 		return self.Variable_ptr.getLocation()
 	def setLocation(self, uint64_t location):
 		self.Variable_ptr.setLocation(location)
-	def getInstance(self):
-		instance = self.Variable_ptr.getInstance()
+	def getInstance(self, MemoryReader reader = None):
+		"""Returns an L{Instance} of this Variable that reads its values from reader"""
+		instance = self.Variable_ptr.getInstance(reader.reader_ptr if reader is not None else NULL)
 		p_instance = Instance()
-		p_instance.setInstance(instance)
+		p_instance.setInstance(instance, reader)
 		return p_instance
 
 cdef class Instance:
 	cdef sym.Instance instance
+	cdef MemoryReader reader
 	def __cinit__(self):
 		pass
-	cdef setInstance(self, sym.Instance new_instance):
-		instance = new_instance
+	cdef setInstance(self, sym.Instance new_instance, MemoryReader reader = None):
+		self.instance = new_instance
+		self.reader = reader
 	def getType(self):
 		cdef sym.BaseType* ptr = self.instance.getType()
 		return BaseType(<uintptr_t> ptr)
@@ -505,6 +644,12 @@ cdef class Instance:
 		return BaseType(<uintptr_t> ptr)
 	def getAddress(self):
 		return self.instance.getAddress()
+	def setMemoryReader(self, MemoryReader reader):
+		"""Read the values of this Instance and the ones derived from it from reader"""
+		self.instance.setMemoryReader(reader.reader_ptr if reader is not None else NULL)
+		self.reader = reader
+	def getMemoryReader(self):
+		return self.reader
 	def getLength(self):
 		return self.instance.getLength()
 	def isNULL(self):
@@ -512,22 +657,31 @@ cdef class Instance:
 	def changeBaseType(self, const string& newType, const string fieldname):
 		instance = self.instance.changeBaseType(newType, fieldname)
 		p_instance = Instance()
-		p_instance.setInstance(instance)
+		p_instance.setInstance(instance, self.reader)
 		return p_instance
 	def arrayElem(self, uint64_t index):
 		instance = self.instance.arrayElem(index)
 		p_instance = Instance()
-		p_instance.setInstance(instance)
+		p_instance.setInstance(instance, self.reader)
 		return p_instance
 	def memberByName(self, const string& name, bool ptr = False, bool expectZero = False):
 		instance = self.instance.memberByName(name, ptr, expectZero)
 		p_instance = Instance()
-		p_instance.setInstance(instance)
+		p_instance.setInstance(instance, self.reader)
 		return p_instance
 	def memberByOffset(self, uint64_t offset, bool ptr = False):
 		instance = self.instance.memberByOffset(offset, ptr)
 		p_instance = Instance()
-		p_instance.setInstance(instance)
+		p_instance.setInstance(instance, self.reader)
+		return p_instance
+	def memberByPath(self, path):
+		"""Returns the Instance at path, a L{FieldPath} or a path string like "mm->pgd" """
+		if isinstance(path, FieldPath):
+			instance = self.instance.memberByPath(deref((<FieldPath> path).path_ptr))
+		else:
+			instance = self.instance.memberByPath(<string> path)
+		p_instance = Instance()
+		p_instance.setInstance(instance, self.reader)
 		return p_instance
 	def memberName(self, uint64_t offset):
 		return self.instance.memberName(offset)
@@ -538,27 +692,154 @@ cdef class Instance:
 	def dereference(self):
 		instance = self.instance.dereference()
 		p_instance = Instance()
-		p_instance.setInstance(instance)
+		p_instance.setInstance(instance, self.reader)
 		return p_instance
 	def getValue(self):
-		address = self.instance.getAddress()
-		baseType_ptr = self.instance.getRealType()
-		baseType = BaseType(<uintptr_t> baseType_ptr)
-		return baseType.getValue(address)
-	#def getRawValueInt64_t(self, bool dereference = True):
-	#	 return self.instance.getRawValue[int64_t](dereference);
-	#def getRawValueUint64_t(self, bool dereference = True):
-	#	 return self.instance.getRawValue[uint64_t](dereference);
-	#def getRawValueInt32_t(self, bool dereference = True):
-	#	 return self.instance.getRawValue[int32_t](dereference);
-	#def getRawValueUint32_t(self, bool dereference = True):
-	#	 return self.instance.getRawValue[uint32_t](dereference);
-	#def getRawValueInt16_t(self, bool dereference = True):
-	#	 return self.instance.getRawValue[int16_t](dereference);
-	#def getRawValueUint16_t(self, bool dereference = True):
-	#	 return self.instance.getRawValue[uint16_t](dereference);
-	#def getRawValueInt8_t(self, bool dereference = True):
-	#	 return self.instance.getRawValue[int8_t](dereference);
-	#def getRawValueUint8_t(self, bool dereference = True):
-	#	 return self.instance.getRawValue[uint8_t](dereference);
-
+		"""Returns the value of a base type according to its encoding, None for other encodings"""
+		encoding = self.instance.getRealType().getEncoding()
+		if encoding == DW_ATE_boolean:
+			return self.instance.getValue[bool]()
+		if encoding == DW_ATE_float:
+			return self.instance.getValue[double]()
+		if encoding == DW_ATE_signed or encoding == DW_ATE_signed_char:
+			return self.instance.getValue[int64_t]()
+		if encoding == DW_ATE_unsigned or encoding == DW_ATE_unsigned_char:
+			return self.instance.getValue[uint64_t]()
+		return None
+	def getBytes(self):
+		"""Returns the memory of the whole Instance, e.g. a struct or array, as bytes"""
+		cdef string data = self.instance.getBytes()
+		return PyBytes_FromStringAndSize(data.data(), data.size())
+	def getRawValueInt64_t(self, bool dereference = True):
+		return self.instance.getRawValue[int64_t](dereference);
+	def getRawValueUint64_t(self, bool dereference = True):
+		return self.instance.getRawValue[uint64_t](dereference);
+	def getRawValueInt32_t(self, bool dereference = True):
+		return self.instance.getRawValue[int32_t](dereference);
+	def getRawValueUint32_t(self, bool dereference = True):
+		return self.instance.getRawValue[uint32_t](dereference);
+	def getRawValueInt16_t(self, bool dereference = True):
+		return self.instance.getRawValue[int16_t](dereference);
+	def getRawValueUint16_t(self, bool dereference = True):
+		return self.instance.getRawValue[uint16_t](dereference);
+	def getRawValueInt8_t(self, bool dereference = True):
+		return self.instance.getRawValue[int8_t](dereference);
+	def getRawValueUint8_t(self, bool dereference = True):
+		return self.instance.getRawValue[uint8_t](dereference);
+
+def readInstances(instances):
+	"""Returns the memory of each L{Instance} in instances as bytes, read in one batch per reader"""
+	cdef vector.vector[sym.Instance] cinstances
+	cdef vector.vector[string] data
+	for instance in instances:
+		cinstances.push_back((<Instance> instance).instance)
+	data = sym.Instance.readBatch(cinstances)
+	return [PyBytes_FromStringAndSize(d.data(), d.size()) for d in data]
+
+
+cdef class FieldPath:
+	"""A member path like "files.fdt.fd[3]" compiled against a type, see L{Instance.memberByPath}"""
+	cdef sym.FieldPath* path_ptr
+	def __cinit__(self, BaseType root, string path):
+		self.path_ptr = new sym.FieldPath(root.BaseType_ptr, path)
+	def __dealloc__(self):
+		del self.path_ptr
+	def resolve(self, uint64_t address):
+		"""Returns the address of the field for the object at address"""
+		return self.path_ptr.resolve(address)
+	def getRootType(self):
+		return ConvBaseType(self.path_ptr.getRootType())
+	def getType(self):
+		return ConvBaseType(self.path_ptr.getType())
+	def getPath(self):
+		return self.path_ptr.getPath()
+	def getOffsets(self):
+		return self.path_ptr.getOffsets()
+	def getDereferenceCount(self):
+		return self.path_ptr.getDereferenceCount()
+
+
+cdef class MemoryReader:
+	"""Memory an L{Instance} reads its values from"""
+	cdef sym.MemoryReader* reader_ptr
+	def __cinit__(self, *args, **kwargs):
+		self.reader_ptr = NULL
+	def __dealloc__(self):
+		del self.reader_ptr
+	def read(self, uint64_t address, size_t length):
+		"""Returns up to length bytes at address"""
+		cdef string data = string(length, 0)
+		got = self.reader_ptr.read(address, &data[0], length)
+		return PyBytes_FromStringAndSize(data.data(), got)
+	def readBatch(self, requests):
+		"""Reads a list of (address, length) tuples in one batch, returns a list of bytes"""
+		cdef vector.vector[sym.MemoryRequest] batch
+		cdef vector.vector[string] data = vector.vector[string](len(requests))
+		cdef sym.MemoryRequest request
+		for i, (address, length) in enumerate(requests):
+			data[i].resize(length)
+			request.address = address
+			request.buffer = &data[i][0]
+			request.length = length
+			request.result = 0
+			batch.push_back(request)
+		self.reader_ptr.readBatch(batch)
+		return [PyBytes_FromStringAndSize(data[i].data(), batch[i].result)
+		        for i in range(batch.size())]
+	def prefetch(self, uint64_t address, size_t length):
+		"""Hint that length bytes at address will be read soon"""
+		self.reader_ptr.prefetch(address, length)
+	def readPointer(self, uint64_t address):
+		return self.reader_ptr.readPointer(address)
+	def readString(self, uint64_t address, size_t maxLength = 4096):
+		return self.reader_ptr.readString(address, maxLength)
+	def getPointerSize(self):
+		return self.reader_ptr.getPointerSize()
+	def setPointerSize(self, size_t pointerSize):
+		self.reader_ptr.setPointerSize(pointerSize)
+	def setBatchGap(self, size_t gap):
+		self.reader_ptr.setBatchGap(gap)
+
+cdef class FileMemoryReader(MemoryReader):
+	"""Raw memory image, the byte at file offset 0 has the address base"""
+	def __cinit__(self, string filename, uint64_t base = 0):
+		self.reader_ptr = new sym.FileMemoryReader(filename, base)
+
+cdef class ElfCoreMemoryReader(MemoryReader):
+	"""ELF core file, addresses are looked up in its PT_LOAD segments"""
+	def __cinit__(self, string filename):
+		self.reader_ptr = new sym.ElfCoreMemoryReader(filename)
+
+cdef class BufferMemoryReader(MemoryReader):
+	"""Memory in a bytes object, its first byte has the address base"""
+	cdef bytes data
+	def __cinit__(self, bytes data, uint64_t base = 0):
+		self.data = data
+		self.reader_ptr = new sym.BufferMemoryReader(<const char*> self.data, len(self.data), base)
+
+cdef class CachedMemoryReader(MemoryReader):
+	"""LRU page cache of capacity pages in front of the reader backend"""
+	cdef MemoryReader backend
+	def __cinit__(self, MemoryReader backend not None, size_t capacity = 1024, size_t pageSize = 4096):
+		self.backend = backend
+		self.reader_ptr = new sym.CachedMemoryReader(backend.reader_ptr, capacity, pageSize)
+	def getBackend(self):
+		return self.backend
+	def setCapacity(self, size_t capacity):
+		(<sym.CachedMemoryReader*> self.reader_ptr).setCapacity(capacity)
+	def getCapacity(self):
+		return (<sym.CachedMemoryReader*> self.reader_ptr).getCapacity()
+	def setReadAhead(self, size_t pages):
+		"""Number of pages read ahead on a sequential miss, 0 disables read-ahead"""
+		(<sym.CachedMemoryReader*> self.reader_ptr).setReadAhead(pages)
+	def getPageSize(self):
+		return (<sym.CachedMemoryReader*> self.reader_ptr).getPageSize()
+	def invalidate(self):
+		"""Drop all cached pages"""
+		(<sym.CachedMemoryReader*> self.reader_ptr).invalidate()
+	def getHits(self):
+		return (<sym.CachedMemoryReader*> self.reader_ptr).getHits()
+	def getMisses(self):
+		return (<sym.CachedMemoryReader*> self.reader_ptr).getMisses()
+	def resetStatistics(self):
+		(<sym.CachedMemoryReader*> self.reader_ptr).resetStatistics()
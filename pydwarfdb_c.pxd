@@ -26,6 +26,13 @@ from libc.stdint cimport uint64_t
 
 ctypedef void* ptr_type
 
+cdef extern from "addressindex.h":
+	cdef cppclass AddressInfo:
+		const string *name
+		Function *function
+		uint64_t start
+		uint64_t offset
+
 cdef extern from "symbolmanager.h":
 	cdef cppclass symbol_source:
 		pass
@@ -33,22 +40,24 @@ cdef extern from "symbolmanager.h":
 	cdef cppclass SymbolManager:
 		SymbolManager()
 
-		ptr_type findSymbolByName[T](const string &name)
-		Symbol* findSymbolByID(uint64_t ID)
-		ptr_type findBaseTypeByName[T](const string &name)
-		BaseType* findBaseTypeByID(uint64_t ID)
-		RefBaseType *findRefBaseTypeByName(const string &name);
-		RefBaseType *findRefBaseTypeByID(uint64_t symId);
-		Array *findArrayByID(uint64_t id);
+		ptr_type findSymbolByName[T](const string &name) except +
+		Symbol* findSymbolByID(uint64_t ID) except +
+		ptr_type findBaseTypeByName[T](const string &name) except +
+		BaseType* findBaseTypeByID(uint64_t ID) except +
+		RefBaseType *findRefBaseTypeByName(const string &name) except +
+		RefBaseType *findRefBaseTypeByID(uint64_t symId) except +
+		Array *findArrayByID(uint64_t id) except +
 		Array *findArrayByTypeID(uint64_t id, uint64_t length);
-		Function* findFunctionByName(const string &name)
-		Function* findFunctionByID(uint64_t ID)
-		Variable* findVariableByName(const string &name)
-		Variable* findVariableByID(uint64_t ID)
+		Function* findFunctionByName(const string &name) except +
+		Function* findFunctionByAddress(uint64_t address)
+		Function* findFunctionByID(uint64_t ID) except +
+		Variable* findVariableByName(const string &name) except +
+		Variable* findVariableByID(uint64_t ID) except +
 
 		uint64_t getSymbolAddress(const string &name)
 		uint64_t numberOfSymbols();
 		vector[string] getVarNames();
+		vector[string] getWarnings();
 
 
 		uint64_t getSystemMapAddress(const string &name, bool priv);
@@ -65,20 +74,92 @@ cdef extern from "symbolmanager.h":
 		string getFunctionName(uint64_t address);
 
 		uint64_t getContainingSymbol(uint64_t address);
+		vector[AddressInfo] symbolize(const vector[uint64_t] &addresses);
+
+		void saveDatabase(const string &filename, const DatabaseKey &key) except +
+		bool loadDatabase(const string &filename, const DatabaseKey &key) except +
 
+		void freeze() except +
+		bool isFrozen()
+		size_t loadElfSymbols(const string &filename) except +
+
+cdef extern from "symboldatabase.h":
+	cdef cppclass DatabaseKey:
+		@staticmethod
+		DatabaseKey fromFilename(const string &filename) except +
+
+cdef extern from "symbolstore.h":
+	cdef cppclass StoredSymbol:
+		StoredSymbol()
+		bool isValid() const
+		uint64_t getID() const
+		const char *getKindName() const
+		const char *getName() const
+		uint32_t getByteSize() const
+		uint32_t getEncoding() const
+		StoredSymbol getType() const
+		uint64_t getAddress() const
+		uint64_t getLength() const
+		uint64_t getMemberLocation() const
+		uint32_t getBitSize() const
+		uint32_t getBitOffset() const
+		uint32_t getMemberCount() const
+		StoredSymbol getMember(uint32_t index) const
+		StoredSymbol memberByName(const string &name) const
+		StoredSymbol memberByOffset(uint32_t offset) const
+
+	cdef cppclass SymbolStore:
+		SymbolStore(const string &filename) except +
+		bool matches(const DatabaseKey &key) const
+		StoredSymbol findSymbolByID(uint64_t id) const
+		StoredSymbol findBaseTypeByName(const string &name) const
+		StoredSymbol findRefBaseTypeByName(const string &name) const
+		StoredSymbol findFunctionByName(const string &name) const
+		StoredSymbol findVariableByName(const string &name) const
+		uint64_t getSymbolAddress(const string &name) const
+		uint64_t numberOfSymbols() const
 
 cdef extern from "dwarfparser.h":
 	cdef cppclass DwarfParser:
 		@staticmethod
-		void parseDwarfFromFilename(const string &filename, SymbolManager *mgr)
+		void parseDwarfFromFilename(const string &filename, SymbolManager *mgr, unsigned int threads, bint native) except +
+		@staticmethod
+		void parseDwarfFromFilenames(const vector[string] &filenames, SymbolManager *mgr, unsigned int threads, bint native) except +
+		@staticmethod
+		void parseDwarfFromFilenameCached(const string &filename, const string &dbFilename, SymbolManager *mgr, unsigned int threads, bint native) except +
+		@staticmethod
+		void parseDwarfFromFilenameLazy(const string &filename, SymbolManager *mgr) except +
+
+cdef extern from "debugfile.h":
+	cdef cppclass DebugFile:
+		@staticmethod
+		void setDebugDirectories(const vector[string] &dirs)
+		@staticmethod
+		vector[string] getDebugDirectories()
+		@staticmethod
+		string find(const string &filename)
 
 cdef extern from "symbol.h":
+	cdef enum SymbolKind "SymbolKind":
+		KIND_BASETYPE "SymbolKind::BaseType"
+		KIND_TYPEDEF "SymbolKind::Typedef"
+		KIND_CONSTTYPE "SymbolKind::ConstType"
+		KIND_FUNCPOINTER "SymbolKind::FuncPointer"
+		KIND_POINTER "SymbolKind::Pointer"
+		KIND_ARRAY "SymbolKind::Array"
+		KIND_STRUCT "SymbolKind::Struct"
+		KIND_UNION "SymbolKind::Union"
+		KIND_ENUM "SymbolKind::Enum"
+		KIND_FUNCTION "SymbolKind::Function"
+		KIND_VARIABLE "SymbolKind::Variable"
+		KIND_MEMBER "SymbolKind::Member"
+
 	cdef cppclass Symbol:
 		uint32_t getByteSize() const
 		uint64_t getID() const
 		const string &getName() const
 		void print() const
-		void *getKind() const
+		SymbolKind getKind() const
 ctypedef Symbol* Symbol_ptr
 
 cdef extern from "referencingtype.h":
@@ -90,9 +171,9 @@ ctypedef ReferencingType* ReferincingType_ptr
 cdef extern from "basetype.h":
 	cdef cppclass BaseType(Symbol):
 		uint64_t getEncoding()
-		Instance getInstance(uint64_t)
-		#T getValue[T] (uint64_t, uint64_t)
-		#T getRawValue[T] (uint64_t, uint64_t)
+		Instance getInstance(uint64_t, MemoryReader*)
+		T getValue[T](MemoryReader*, uint64_t) except +
+		T getRawValue[T](MemoryReader*, uint64_t) except +
 		void print() const
 		void Kind()
 ctypedef BaseType* BaseType_ptr
@@ -145,6 +226,8 @@ ctypedef Enum* Enum_ptr
 cdef extern from "function.h":
 	cdef cppclass Function(BaseType):
 		uint64_t getAddress();
+		const vector[pair[uint64_t, uint64_t]] &getRanges() const;
+		bool containsAddress(uint64_t address) const;
 		void updateTypes();
 		vector[pair[string, uint64_t]] getParamList() const;
 		vector[pair[string, BaseType]] getFullParamList() const;
@@ -191,7 +274,7 @@ cdef extern from "variable.h":
 	cdef cppclass Variable(Symbol, ReferencingType):
 		uint64_t getLocation();
 		void setLocation(uint64_t location);
-		Instance getInstance();
+		Instance getInstance(MemoryReader*);
 		void print() const;
 ctypedef Variable* Variable_ptr
 
@@ -202,19 +285,73 @@ cdef extern from "instance.h":
 		BaseType *getType()
 		BaseType *getRealType()
 		uint64_t getAddress()
+		void setMemoryReader(MemoryReader*)
+		MemoryReader *getMemoryReader() const
 		uint64_t getLength()
 		bool isNULL()
 		Instance changeBaseType(const string &newType, const string fieldname) const;
 		Instance arrayElem(uint64_t) const;
-		Instance memberByName(const string&, bool, bool) const;
-		Instance memberByOffset(uint64_t, bool) const;
+		Instance memberByName(const string&, bool, bool) except +
+		Instance memberByOffset(uint64_t, bool) except +
+		Instance memberByPath(const FieldPath&) except +
+		Instance memberByPath(const string&) except +
 		string memberName(uint64_t) const;
 		uint32_t size() const;
 		uint32_t memberOffset(const string&) const;
-		Instance dereference() const;
-		T getValue[T]();
-		T getRawValue[T](bool);
+		Instance dereference() except +
+		T getValue[T]() except +
+		T getRawValue[T](bool) except +
+		string getBytes() except +
+		@staticmethod
+		vector[string] readBatch(const vector[Instance]&) except +
 		bool operator ==(const Instance&) const;
 		bool operator !=(const Instance&) const;
 		void print() const;
 ctypedef Instance* Instance_ptr
+
+cdef extern from "fieldpath.h":
+	cdef cppclass FieldPath:
+		FieldPath(BaseType *root, const string &path) except +
+		uint64_t resolve(uint64_t address) except +
+		BaseType *getRootType() const
+		BaseType *getType() const
+		const string &getPath() const
+		const vector[uint64_t] &getOffsets() const
+		size_t getDereferenceCount() const
+
+cdef extern from "memoryreader.h":
+	cdef struct MemoryRequest:
+		uint64_t address
+		void *buffer
+		size_t length
+		size_t result
+
+	cdef cppclass MemoryReader:
+		size_t read(uint64_t address, void *buffer, size_t length) except +
+		void readBatch(vector[MemoryRequest] &requests) except +
+		void prefetch(uint64_t address, size_t length) except +
+		uint64_t readPointer(uint64_t address) except +
+		string readString(uint64_t address, size_t maxLength) except +
+		size_t getPointerSize() const
+		void setPointerSize(size_t pointerSize) except +
+		void setBatchGap(size_t gap)
+
+	cdef cppclass FileMemoryReader(MemoryReader):
+		FileMemoryReader(const string &filename, uint64_t base) except +
+
+	cdef cppclass ElfCoreMemoryReader(FileMemoryReader):
+		ElfCoreMemoryReader(const string &filename) except +
+
+	cdef cppclass BufferMemoryReader(MemoryReader):
+		BufferMemoryReader(const void *data, size_t size, uint64_t base)
+
+	cdef cppclass CachedMemoryReader(MemoryReader):
+		CachedMemoryReader(MemoryReader *backend, size_t capacity, size_t pageSize) except +
+		void setCapacity(size_t capacity)
+		size_t getCapacity() const
+		void setReadAhead(size_t pages)
+		size_t getPageSize() const
+		void invalidate()
+		uint64_t getHits() const
+		uint64_t getMisses() const
+		void resetStatistics()
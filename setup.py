@@ -4,28 +4,41 @@ from Cython.Build import cythonize
 
 extensions = [
 	Extension('pydwarfdb', ['pydwarfdb.pyx',
+		'src/acceleratortable.cpp',
+		'src/addressindex.cpp',
 		'src/array.cpp',
 		'src/basetype.cpp',
 		'src/consttype.cpp',
+		'src/debugfile.cpp',
+		'src/dwarfdecoder.cpp',
 		'src/dwarfexception.cpp',
 		'src/dwarfparser.cpp',
 		'src/enum.cpp',
+		'src/fieldpath.cpp',
 		'src/funcpointer.cpp',
 		'src/function.cpp',
+		'src/idtable.cpp',
 		'src/instance.cpp',
+		'src/memoryreader.cpp',
 		'src/pointer.cpp',
 		'src/refbasetype.cpp',
 		'src/referencingtype.cpp',
+		'src/stringtable.cpp',
 		'src/struct.cpp',
 		'src/structured.cpp',
 		'src/structuredmember.cpp',
 		'src/symbol.cpp',
+		'src/symbolarena.cpp',
+		'src/symboldatabase.cpp',
 		'src/symbolmanager.cpp',
+		'src/symbolstore.cpp',
+		'src/symboltable.cpp',
 		'src/typedef.cpp',
 		'src/union.cpp',
 		'src/variable.cpp'],
 		language='c++',
-		extra_compile_args=['-std=c++14'],
+		extra_compile_args=['-std=c++14', '-pthread'],
+		extra_link_args=['-pthread'],
 		include_dirs = ['src'],
 		libraries = ['dwarf', 'elf']
 	)
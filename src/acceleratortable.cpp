@@ -0,0 +1,405 @@
+#include "acceleratortable.h"
+
+#include <cstring>
+#include <gelf.h>
+#include <libdwarf/dwarf.h>
+#include <unordered_map>
+#include <utility>
+
+namespace {
+
+/**
+ * Index attributes of .debug_names abbreviations.
+ */
+enum {
+	IDX_COMPILE_UNIT = 1,
+	IDX_TYPE_UNIT    = 2,
+	IDX_DIE_OFFSET   = 3,
+	IDX_PARENT       = 4,
+};
+
+/**
+ * Bounds checked reader of section data. Reading past the end yields 0
+ * and clears ok.
+ */
+class SectionReader {
+public:
+	SectionReader(const uint8_t *begin, size_t size, bool bigEndian)
+		:
+		begin{begin},
+		pos{begin},
+		end{begin + size},
+		bigEndian{bigEndian},
+		ok{true} {}
+
+	uint64_t read(size_t size) {
+		if (size > this->remaining()) {
+			this->fail();
+			return 0;
+		}
+		uint64_t value = 0;
+		for (size_t i = 0; i < size; i++) {
+			value = (value << 8) | this->pos[this->bigEndian ? i : size - 1 - i];
+		}
+		this->pos += size;
+		return value;
+	}
+
+	uint64_t readULEB() {
+		uint64_t value = 0;
+		for (unsigned shift = 0; this->pos < this->end; shift += 7) {
+			uint8_t byte = *this->pos++;
+			if (shift < 64) {
+				value |= (uint64_t)(byte & 0x7f) << shift;
+			}
+			if (!(byte & 0x80)) {
+				return value;
+			}
+		}
+		this->fail();
+		return 0;
+	}
+
+	/**
+	 * Read an attribute value of a .debug_names entry.
+	 */
+	uint64_t readForm(uint64_t form, size_t offsetSize) {
+		switch (form) {
+		case DW_FORM_flag_present:
+			return 1;
+		case DW_FORM_data1:
+		case DW_FORM_ref1:
+		case DW_FORM_flag:
+			return this->read(1);
+		case DW_FORM_data2:
+		case DW_FORM_ref2:
+			return this->read(2);
+		case DW_FORM_data4:
+		case DW_FORM_ref4:
+			return this->read(4);
+		case DW_FORM_data8:
+		case DW_FORM_ref8:
+			return this->read(8);
+		case DW_FORM_udata:
+		case DW_FORM_ref_udata:
+			return this->readULEB();
+		case DW_FORM_sec_offset:
+			return this->read(offsetSize);
+		default:
+			this->fail();
+			return 0;
+		}
+	}
+
+	void skip(uint64_t size) {
+		if (size > this->remaining()) {
+			this->fail();
+		} else {
+			this->pos += size;
+		}
+	}
+
+	void seek(uint64_t offset) {
+		if (offset > (uint64_t)(this->end - this->begin)) {
+			this->fail();
+		} else {
+			this->pos = this->begin + offset;
+		}
+	}
+
+	uint64_t tell() const {
+		return this->pos - this->begin;
+	}
+
+	uint64_t remaining() const {
+		return this->end - this->pos;
+	}
+
+	bool isOK() const {
+		return this->ok;
+	}
+
+private:
+	void fail() {
+		this->ok = false;
+		this->pos = this->end;
+	}
+
+	const uint8_t *begin;
+	const uint8_t *pos;
+	const uint8_t *end;
+	bool bigEndian;
+	bool ok;
+};
+
+/**
+ * @return The NUL terminated string at offset of data, nullptr if it is
+ * not terminated within the data.
+ */
+const char *getString(const uint8_t *data, size_t size, uint64_t offset) {
+	if (offset >= size || !memchr(data + offset, 0, size - offset)) {
+		return nullptr;
+	}
+	return (const char *)data + offset;
+}
+
+}  // namespace
+
+AcceleratorTable::AcceleratorTable(int fd)
+	:
+	elf{nullptr},
+	bigEndian{false} {
+	elf_version(EV_CURRENT);
+	this->elf = elf_begin(fd, ELF_C_READ, nullptr);
+	GElf_Ehdr ehdr;
+	if (this->elf && gelf_getehdr(this->elf, &ehdr)) {
+		this->bigEndian = (ehdr.e_ident[EI_DATA] == ELFDATA2MSB);
+	}
+}
+
+AcceleratorTable::~AcceleratorTable() {
+	if (this->elf) {
+		elf_end(this->elf);
+	}
+}
+
+bool AcceleratorTable::read(std::vector<Entry> &entries) {
+	size_t oldSize = entries.size();
+	if (this->readDebugNames(entries)) {
+		return true;
+	}
+	entries.resize(oldSize);
+	if (this->readGdbIndex(entries)) {
+		return true;
+	}
+	entries.resize(oldSize);
+	return false;
+}
+
+bool AcceleratorTable::getSection(const char *name,
+                                  const uint8_t *&data, size_t &size) {
+	size_t shstrndx;
+	if (!this->elf || elf_getshdrstrndx(this->elf, &shstrndx) != 0) {
+		return false;
+	}
+	Elf_Scn *scn = nullptr;
+	while ((scn = elf_nextscn(this->elf, scn)) != nullptr) {
+		GElf_Shdr shdr;
+		if (!gelf_getshdr(scn, &shdr)) {
+			continue;
+		}
+		const char *scnName = elf_strptr(this->elf, shstrndx, shdr.sh_name);
+		if (!scnName || strcmp(scnName, name) != 0) {
+			continue;
+		}
+		if (shdr.sh_type == SHT_NOBITS || (shdr.sh_flags & SHF_COMPRESSED)) {
+			return false;
+		}
+		Elf_Data *scnData = elf_getdata(scn, nullptr);
+		if (!scnData || !scnData->d_buf) {
+			return false;
+		}
+		data = (const uint8_t *)scnData->d_buf;
+		size = scnData->d_size;
+		return true;
+	}
+	return false;
+}
+
+/**
+ * Read all name indices of .debug_names, see section 6.1.1 of DWARF 5.
+ * Entries of type units and of DIEs with an indexed parent are skipped,
+ * only the top level DIEs of compilation units are of interest.
+ */
+bool AcceleratorTable::readDebugNames(std::vector<Entry> &entries) {
+	const uint8_t *data, *strData;
+	size_t size, strSize;
+	if (!this->getSection(".debug_names", data, size) ||
+	    !this->getSection(".debug_str", strData, strSize)) {
+		return false;
+	}
+
+	SectionReader section{data, size, this->bigEndian};
+	while (section.remaining()) {
+		size_t offsetSize = 4;
+		uint64_t length = section.read(4);
+		if (length == 0xffffffff) {
+			length = section.read(8);
+			offsetSize = 8;
+		}
+		if (!section.isOK() || length > section.remaining()) {
+			return false;
+		}
+		SectionReader unit{data + section.tell(), length, this->bigEndian};
+		section.skip(length);
+
+		uint64_t version         = unit.read(2);
+		unit.read(2);  // padding
+		uint64_t cuCount         = unit.read(4);
+		uint64_t localTUCount    = unit.read(4);
+		uint64_t foreignTUCount  = unit.read(4);
+		uint64_t bucketCount     = unit.read(4);
+		uint64_t nameCount       = unit.read(4);
+		uint64_t abbrevSize      = unit.read(4);
+		uint64_t augmentSize     = unit.read(4);
+		unit.skip(augmentSize);
+		if (!unit.isOK() || version != 5 ||
+		    cuCount * offsetSize > unit.remaining()) {
+			return false;
+		}
+
+		std::vector<uint64_t> cus(cuCount);
+		for (auto &cu : cus) {
+			cu = unit.read(offsetSize);
+		}
+		// type unit lists and the hash table are not needed
+		unit.skip(localTUCount * offsetSize + foreignTUCount * 8 +
+		          (bucketCount ? bucketCount * 4 + nameCount * 4 : 0));
+
+		uint64_t stringsOffset = unit.tell();
+		uint64_t entriesOffset = stringsOffset + nameCount * offsetSize;
+		uint64_t abbrevOffset  = entriesOffset + nameCount * offsetSize;
+		uint64_t poolOffset    = abbrevOffset + abbrevSize;
+
+		struct Abbrev {
+			uint64_t tag;
+			std::vector<std::pair<uint64_t, uint64_t>> attributes;
+		};
+		std::unordered_map<uint64_t, Abbrev> abbrevs;
+		unit.seek(abbrevOffset);
+		while (unit.isOK()) {
+			uint64_t code = unit.readULEB();
+			if (!code) {
+				break;
+			}
+			Abbrev &abbrev = abbrevs[code];
+			abbrev.tag = unit.readULEB();
+			while (unit.isOK()) {
+				uint64_t index = unit.readULEB();
+				uint64_t form = unit.readULEB();
+				if (!index && !form) {
+					break;
+				}
+				abbrev.attributes.emplace_back(index, form);
+			}
+		}
+		if (!unit.isOK()) {
+			return false;
+		}
+
+		for (uint64_t i = 0; i < nameCount; i++) {
+			unit.seek(stringsOffset + i * offsetSize);
+			const char *name = getString(strData, strSize, unit.read(offsetSize));
+			unit.seek(entriesOffset + i * offsetSize);
+			unit.seek(poolOffset + unit.read(offsetSize));
+			if (!unit.isOK() || !name) {
+				return false;
+			}
+
+			while (true) {
+				uint64_t code = unit.readULEB();
+				if (!code || !unit.isOK()) {
+					break;
+				}
+				auto abbrev = abbrevs.find(code);
+				if (abbrev == abbrevs.end()) {
+					return false;
+				}
+				// the unit may be omitted if there is only one
+				uint64_t cu = (cus.size() == 1) ? 0 : cus.size();
+				uint64_t die = 0;
+				bool found = false;
+				bool skip = false;
+				for (auto &attribute : abbrev->second.attributes) {
+					uint64_t value = unit.readForm(attribute.second, offsetSize);
+					switch (attribute.first) {
+					case IDX_COMPILE_UNIT:
+						cu = value;
+						break;
+					case IDX_TYPE_UNIT:
+						skip = true;
+						break;
+					case IDX_DIE_OFFSET:
+						die = value;
+						found = true;
+						break;
+					case IDX_PARENT:
+						// flag_present marks an entry without indexed parent
+						skip |= (attribute.second != DW_FORM_flag_present);
+						break;
+					}
+				}
+				// enumerators are created with their enumeration
+				if (found && !skip && cu < cus.size() &&
+				    abbrev->second.tag != DW_TAG_enumerator) {
+					entries.push_back(Entry{name, cus[cu] + die, false});
+				}
+			}
+			if (!unit.isOK()) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+/**
+ * Read the symbol table of .gdb_index version 7 or 8. It only names the
+ * compilation units of every symbol.
+ */
+bool AcceleratorTable::readGdbIndex(std::vector<Entry> &entries) {
+	const uint8_t *data;
+	size_t size;
+	if (!this->getSection(".gdb_index", data, size)) {
+		return false;
+	}
+
+	// .gdb_index is always little endian
+	SectionReader index{data, size, false};
+	uint64_t version       = index.read(4);
+	uint64_t cuListOffset  = index.read(4);
+	uint64_t typesOffset   = index.read(4);
+	index.read(4);  // address area
+	uint64_t symbolsOffset = index.read(4);
+	uint64_t poolOffset    = index.read(4);
+	if (!index.isOK() || version < 7 || version > 8 ||
+	    cuListOffset > typesOffset || typesOffset > size ||
+	    symbolsOffset > poolOffset || poolOffset > size) {
+		return false;
+	}
+
+	// pairs of unit offset and length
+	std::vector<uint64_t> cus((typesOffset - cuListOffset) / 16);
+	index.seek(cuListOffset);
+	for (auto &cu : cus) {
+		cu = index.read(8);
+		index.read(8);
+	}
+
+	// hash table of name and CU vector offsets into the constant pool
+	for (uint64_t slot = symbolsOffset; slot + 8 <= poolOffset; slot += 8) {
+		index.seek(slot);
+		uint64_t nameOffset = index.read(4);
+		uint64_t vectorOffset = index.read(4);
+		if (!nameOffset && !vectorOffset) {
+			continue;
+		}
+		const char *name = getString(data, size, poolOffset + nameOffset);
+		index.seek(poolOffset + vectorOffset);
+		uint64_t count = index.read(4);
+		if (!index.isOK() || !name) {
+			return false;
+		}
+		for (uint64_t i = 0; i < count && index.isOK(); i++) {
+			// the lower 24 bits are the unit, type units follow the CUs
+			uint64_t cu = index.read(4) & 0xffffff;
+			if (cu < cus.size()) {
+				entries.push_back(Entry{name, cus[cu], true});
+			}
+		}
+		if (!index.isOK()) {
+			return false;
+		}
+	}
+	return true;
+}
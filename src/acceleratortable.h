@@ -0,0 +1,50 @@
+#ifndef _ACCELERATORTABLE_H_
+#define _ACCELERATORTABLE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <libelf.h>
+
+/**
+ * Reader of the name accelerator tables of an ELF file.
+ *
+ * .debug_names (DWARF 5) maps names to DIE offsets, .gdb_index maps them
+ * to the compilation units that define them. Both are read directly from
+ * the section data, compressed sections are not supported.
+ */
+class AcceleratorTable {
+public:
+	struct Entry {
+		const char *name;  ///< Points into the section data.
+		uint64_t offset;   ///< .debug_info offset of the DIE or the unit header.
+		bool unit;         ///< Only the compilation unit of the name is known.
+	};
+
+	/**
+	 * Open the tables of the ELF file fd, the fd is not closed.
+	 */
+	AcceleratorTable(int fd);
+	virtual ~AcceleratorTable();
+
+	AcceleratorTable(const AcceleratorTable &other) = delete;
+	AcceleratorTable &operator =(const AcceleratorTable &other) = delete;
+
+	/**
+	 * Append the entries of .debug_names, or of .gdb_index if there is none.
+	 * The names stay valid for the lifetime of this object.
+	 * @return false if the file has no usable table.
+	 */
+	bool read(std::vector<Entry> &entries);
+
+private:
+	bool readDebugNames(std::vector<Entry> &entries);
+	bool readGdbIndex(std::vector<Entry> &entries);
+	bool getSection(const char *name, const uint8_t *&data, size_t &size);
+
+	Elf *elf;
+	bool bigEndian;
+};
+
+#endif /* _ACCELERATORTABLE_H_ */
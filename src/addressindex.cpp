@@ -0,0 +1,135 @@
+#include "addressindex.h"
+
+#include <algorithm>
+#include <numeric>
+
+AddressIndex::AddressIndex() {}
+
+AddressIndex::~AddressIndex() {}
+
+void AddressIndex::add(uint64_t start, uint64_t end, const std::string *name,
+                       Function *function) {
+	this->entries.push_back(Entry{start, end, name, function});
+}
+
+void AddressIndex::clear() {
+	this->entries.clear();
+	this->segments.clear();
+}
+
+size_t AddressIndex::size() const {
+	return this->segments.size();
+}
+
+void AddressIndex::build() {
+	this->segments.clear();
+
+	std::sort(this->entries.begin(), this->entries.end(),
+	          [](const Entry &a, const Entry &b) {
+		return a.start < b.start;
+	});
+
+	// an unsized symbol covers the largest symbol with the same start, or
+	// extends to the next symbol
+	for (size_t i = 0; i < this->entries.size();) {
+		size_t next = i;
+		uint64_t end = 0;
+		while (next < this->entries.size() &&
+		       this->entries[next].start == this->entries[i].start) {
+			end = std::max(end, this->entries[next].end);
+			next++;
+		}
+		if (end <= this->entries[i].start) {
+			end = (next < this->entries.size()) ?
+			      this->entries[next].start : this->entries[i].start + 1;
+		}
+		for (; i < next; i++) {
+			if (this->entries[i].end <= this->entries[i].start) {
+				this->entries[i].end = end;
+			}
+		}
+	}
+
+	// outer symbols first, among equal ranges the ones with a function last
+	std::sort(this->entries.begin(), this->entries.end(),
+	          [](const Entry &a, const Entry &b) {
+		if (a.start != b.start) {
+			return a.start < b.start;
+		}
+		if (a.end != b.end) {
+			return a.end > b.end;
+		}
+		return !a.function && b.function;
+	});
+
+	// sweep, the innermost open symbol owns the address space
+	std::vector<uint32_t> open;
+	uint64_t cursor = 0;
+	auto emitUntil = [this, &open, &cursor](uint64_t limit) {
+		while (!open.empty() && cursor < limit) {
+			const Entry &top = this->entries[open.back()];
+			uint64_t end = std::min(top.end, limit);
+			if (cursor < end) {
+				this->segments.push_back(Segment{cursor, end, open.back()});
+			}
+			if (top.end <= limit) {
+				cursor = std::max(cursor, top.end);
+				open.pop_back();
+			} else {
+				cursor = limit;
+			}
+		}
+	};
+	for (uint32_t i = 0; i < this->entries.size(); i++) {
+		emitUntil(this->entries[i].start);
+		open.push_back(i);
+		cursor = this->entries[i].start;
+	}
+	emitUntil(UINT64_MAX);
+}
+
+AddressInfo AddressIndex::makeInfo(const Segment &segment,
+                                   uint64_t address) const {
+	const Entry &entry = this->entries[segment.symbol];
+	return AddressInfo{entry.name, entry.function, entry.start,
+	                   address - entry.start};
+}
+
+AddressInfo AddressIndex::find(uint64_t address) const {
+	auto segment = std::upper_bound(
+		this->segments.begin(), this->segments.end(), address,
+		[](uint64_t address, const Segment &segment) {
+			return address < segment.begin;
+		});
+	if (segment == this->segments.begin() || address >= (--segment)->end) {
+		return AddressInfo{nullptr, nullptr, 0, 0};
+	}
+	return this->makeInfo(*segment, address);
+}
+
+std::vector<AddressInfo> AddressIndex::find(
+		const std::vector<uint64_t> &addresses) const {
+	std::vector<AddressInfo> result(addresses.size(),
+	                                AddressInfo{nullptr, nullptr, 0, 0});
+
+	std::vector<uint32_t> order(addresses.size());
+	std::iota(order.begin(), order.end(), 0);
+	std::sort(order.begin(), order.end(), [&addresses](uint32_t a, uint32_t b) {
+		return addresses[a] < addresses[b];
+	});
+
+	auto segment = this->segments.begin();
+	for (auto &index : order) {
+		uint64_t address = addresses[index];
+		while (segment != this->segments.end() && segment->end <= address) {
+			segment++;
+		}
+		if (segment == this->segments.end()) {
+			break;
+		}
+		if (segment->begin <= address) {
+			result[index] = this->makeInfo(*segment, address);
+		}
+	}
+	return result;
+}
@@ -0,0 +1,90 @@
+#ifndef _ADDRESSINDEX_H_
+#define _ADDRESSINDEX_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class Function;
+
+/**
+ * Result of an address lookup.
+ */
+struct AddressInfo {
+	const std::string *name;  ///< Containing symbol, nullptr if there is none.
+	Function *function;       ///< Its DWARF function, if known.
+	uint64_t start;           ///< Start address of the containing symbol.
+	uint64_t offset;          ///< Address - start.
+};
+
+/**
+ * Sorted interval index from addresses to the symbols that contain them.
+ *
+ * Symbols are added with add() and become visible with build(), which
+ * flattens them into a sorted array of disjoint segments. A symbol without
+ * a size extends to the next symbol. Where symbols overlap the innermost
+ * one wins, so a function inside a larger section symbol is found.
+ */
+class AddressIndex {
+public:
+	AddressIndex();
+	virtual ~AddressIndex();
+
+	/**
+	 * Add the symbol name at [start, end), end 0 if the size is unknown.
+	 * name must stay valid for the lifetime of the index.
+	 */
+	void add(uint64_t start, uint64_t end, const std::string *name,
+	         Function *function=nullptr);
+
+	/**
+	 * Build the segments from all added symbols.
+	 */
+	void build();
+
+	/**
+	 * Remove all symbols and segments.
+	 */
+	void clear();
+
+	/**
+	 * @return The symbol containing address.
+	 */
+	AddressInfo find(uint64_t address) const;
+
+	/**
+	 * Look up all addresses at once. The addresses are sorted internally
+	 * and resolved in a single pass over the segments.
+	 * @return One result per address, in the order of addresses.
+	 */
+	std::vector<AddressInfo> find(const std::vector<uint64_t> &addresses) const;
+
+	/**
+	 * @return Number of segments.
+	 */
+	size_t size() const;
+
+private:
+	struct Entry {
+		uint64_t start;
+		uint64_t end;
+		const std::string *name;
+		Function *function;
+	};
+
+	/**
+	 * Part [begin, end) of the address space that belongs to symbol.
+	 */
+	struct Segment {
+		uint64_t begin;
+		uint64_t end;
+		uint32_t symbol;  ///< Index in entries.
+	};
+
+	AddressInfo makeInfo(const Segment &segment, uint64_t address) const;
+
+	std::vector<Entry> entries;
+	std::vector<Segment> segments;
+};
+
+#endif /* _ADDRESSINDEX_H_ */
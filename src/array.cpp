@@ -6,21 +6,34 @@
 
 #include "dwarfparser.h"
 #include "helpers.h"
+#include "symboldatabase.h"
 #include "symbolmanager.h"
 
 Array::Array(SymbolManager *mgr,
              DwarfParser *parser,
-             const Dwarf_Die &object,
+             const DieInfo &info,
              const std::string &name)
 	:
-	Pointer(mgr, parser, object, name),
+	Pointer(mgr, parser, info, name),
 	length(0),
 	lengthType(0),
 	lengthTypeBT(0) {
 
+	this->kind = SymbolKind::Array;
 	this->manager->addArray(this);
 }
 
+Array::Array(SymbolManager *mgr,
+             const DatabaseSymbol &record,
+             const DatabaseReader &db)
+	:
+	Pointer(mgr, record, db),
+	length(record.value),
+	lengthType(record.value2),
+	lengthTypeBT(0) {
+	this->kind = SymbolKind::Array;
+}
+
 Array::~Array() {}
 
 uint64_t Array::getLength() {
@@ -32,17 +45,16 @@ uint32_t Array::getByteSize() {
 	return this->length * symbol->getByteSize();
 }
 
-void Array::update(DwarfParser *parser, const Dwarf_Die &object) {
-	if (parser->dieHasAttr(object, DW_AT_type)) {
-		uint64_t dwarfType = parser->getDieAttributeNumber(object, DW_AT_type);
+void Array::update(DwarfParser *parser, const DieInfo &info) {
+	if (info.has(DW_AT_type)) {
+		uint64_t dwarfType = info.type;
 		uint32_t fileID    = parser->getFileID();
 		this->lengthType = this->manager->getID(dwarfType, fileID);
 		if (!this->lengthType)
 			assert(false);
 	}
-	if (parser->dieHasAttr(object, DW_AT_upper_bound)) {
-		this->length = parser->getDieAttributeNumber(object,
-		                                             DW_AT_upper_bound) + 1;
+	if (info.has(DW_AT_upper_bound)) {
+		this->length = info.upperBound + 1;
 	}
 }
 
@@ -73,6 +85,13 @@ void Array::updateTypes() {
 	}
 }
 
+void Array::store(DatabaseSymbol &record, DatabaseWriter &db) const {
+	Pointer::store(record, db);
+	record.kind   = (uint8_t)DatabaseKind::Array;
+	record.value  = this->length;
+	record.value2 = this->lengthType;
+}
+
 void Array::print() const {
 	Pointer::print();
 	std::cout << "\t Array Type:   " << std::hex << this->type << std::dec
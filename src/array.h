@@ -9,11 +9,19 @@ class Array : public Pointer {
 public:
 	Array(SymbolManager *mgr,
 	      DwarfParser *parser,
-	      const Dwarf_Die &object,
+	      const DieInfo &info,
 	      const std::string &name);
+	Array(SymbolManager *mgr,
+	      const DatabaseSymbol &record,
+	      const DatabaseReader &db);
 	virtual ~Array();
 
+	static bool classof(const Symbol *sym) {
+		return sym->getKind() == SymbolKind::Array;
+	}
+
 	virtual uint32_t getByteSize() override;
+	virtual void store(DatabaseSymbol &record, DatabaseWriter &db) const override;
 	virtual void print() const override;
 
 	/**
@@ -24,7 +32,7 @@ public:
 	/**
 	 * Update state of Array
 	 */
-	void update(DwarfParser *parser, const Dwarf_Die &object);
+	void update(DwarfParser *parser, const DieInfo &info);
 
 	bool operator <(const Array &array) const;
 	bool operator ==(const Array &array) const;
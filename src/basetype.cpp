@@ -4,31 +4,53 @@
 #include <libdwarf/libdwarf.h>
 
 #include "instance.h"
+#include "symboldatabase.h"
 #include "symbolmanager.h"
 
 BaseType::BaseType(SymbolManager *manager,
                    DwarfParser *parser,
-                   const Dwarf_Die &object,
+                   const DieInfo &info,
                    const std::string &name)
 	:
-	Symbol(manager, parser, object, name), encoding(0) {
+	Symbol(manager, parser, info, name),
+	encoding(0),
+	typeHash(parser->getTypeHash(info)) {
 
-	if (parser->dieHasAttr(object, DW_AT_encoding)) {
-		this->encoding = parser->getDieAttributeNumber(object,
-		                                               DW_AT_encoding);
+	this->kind = SymbolKind::BaseType;
+	if (info.has(DW_AT_encoding)) {
+		this->encoding = info.encoding;
 	}
 
 	this->manager->addBaseType(this);
 }
 
+BaseType::BaseType(SymbolManager *manager,
+                   const DatabaseSymbol &record,
+                   const DatabaseReader &db)
+	:
+	Symbol(manager, record, db), encoding(record.encoding), typeHash(0) {
+	this->kind = SymbolKind::BaseType;
+}
+
 BaseType::~BaseType() {}
 
+void BaseType::store(DatabaseSymbol &record, DatabaseWriter &db) const {
+	Symbol::store(record, db);
+	record.kind     = (uint8_t)DatabaseKind::BaseType;
+	record.encoding = this->encoding;
+}
+
 uint64_t BaseType::getEncoding() {
 	return this->encoding;
 }
 
-Instance BaseType::getInstance(uint64_t va) {
+uint64_t BaseType::getTypeHash() const {
+	return this->typeHash;
+}
+
+Instance BaseType::getInstance(uint64_t va, MemoryReader *reader) {
 	Instance instance = Instance{this, va};
+	instance.setMemoryReader(reader);
 	return instance;
 }
 
@@ -5,14 +5,15 @@
 #include <libdwarf/dwarf.h>
 
 #include <cassert>
+#include <type_traits>
 #include <typeinfo>
 
 #include <iostream>
 
-//#include "libvmiwrapper/vmiinstance.h"
 #include "dwarfparser.h"
 
 #include "dwarfexception.h"
+#include "memoryreader.h"
 
 class Instance;
 class SymbolManager;
@@ -21,210 +22,122 @@ class BaseType : public Symbol {
 public:
 	BaseType(SymbolManager *manager,
 	         DwarfParser *parser,
-	         const Dwarf_Die &object,
+	         const DieInfo &info,
 	         const std::string &name);
+	BaseType(SymbolManager *manager,
+	         const DatabaseSymbol &record,
+	         const DatabaseReader &db);
 	virtual ~BaseType();
 
+	static bool classof(const Symbol *sym) {
+		return sym->getKind() >= SymbolKind::BaseType &&
+		       sym->getKind() <= SymbolKind::Enum;
+	}
+
 	/**
 	 * The encoding of a type is the corresponding base type (char, int, ...) if available.
 	 * @return Encoding of this type.
 	 */
 	uint64_t getEncoding();
 
+	/**
+	 * @return Structural hash of the type, 0 if it was not parsed.
+	 */
+	uint64_t getTypeHash() const;
+
 	/**
 	 * Return an Instance for this BaseType for easier navigation.
-	 * @param va Address of the BaseType in Memory
+	 * @param va     Address of the BaseType in Memory
+	 * @param reader Memory the Instance reads values from, may be nullptr
 	 * @return Instance for this BaseType
 	 */
-	Instance getInstance(uint64_t va);
+	Instance getInstance(uint64_t va, MemoryReader *reader=nullptr);
 
 	/**
 	 * Get value of this BaseType in memory. This function does an additional
-	 * check for the correct encoding.
-	 * @param va  Address of the BaseType in memory.
-	 * @param pid Process ID to select the corresponding address space. Defaults to 0 (Kernelspace).
+	 * check for the correct encoding and extends the value from the size of
+	 * the type to T.
+	 * @param reader Memory to read from.
+	 * @param va     Address of the BaseType in memory.
 	 * @return Value of BaseType in memory.
 	 */
 	template <typename T>
-	inline T getValue(uint64_t va, uint64_t pid=0) const;
+	inline T getValue(MemoryReader *reader, uint64_t va) const;
 
 	/**
 	 * Get value of this BaseType in memory. This function returns the value
 	 * independent of the actual encoding of the BaseType.
-	 * @param va  Address of the BaseType in memory.
-	 * @param pid Process ID to select the corresponding address space. Defaults to 0 (Kernelspace).
+	 * @param reader Memory to read from.
+	 * @param va     Address of the BaseType in memory.
 	 * @return Value of BaseType in memory.
 	 */
 	template <typename T>
-	inline T getRawValue(uint64_t va, uint64_t pid=0) const;
+	inline T getRawValue(MemoryReader *reader, uint64_t va) const;
 
+	void store(DatabaseSymbol &record, DatabaseWriter &db) const override;
 	void print() const override;
 
 private:
 	uint64_t encoding; ///< Encoding of this BaseType.
+	uint64_t typeHash; ///< See DwarfParser::getTypeHash().
 };
 
-#if 0
 template <>
-inline std::string BaseType::getValue(uint64_t va, uint64_t pid) const {
-	assert(va);
-	VMIInstance *vmi = VMIInstance::getInstance();
-	return vmi->readStrFromVA(va, pid);
+inline std::string BaseType::getValue(MemoryReader *reader,
+                                      uint64_t va) const {
+	assert(reader);
+	return reader->readString(va);
 }
-#endif
 
-#if 0
 template <typename T>
-inline T BaseType::getValue(uint64_t va, uint64_t pid) const {
-	assert(va);
-	if (!encoding) {
-		std::cout << std::hex << this->getID() << std::dec << " "
-		          << this->getName() << std::endl;
-		this->print();
-	}
-	assert(encoding);
-	VMIInstance *vmi = VMIInstance::getInstance();
+inline T BaseType::getValue(MemoryReader *reader, uint64_t va) const {
+	assert(reader);
 
 	switch (this->encoding) {
-	case DW_ATE_address:
-		// Type currenty not expected
-		assert(false);
 	case DW_ATE_boolean:
-		if (typeid(T) == typeid(bool)) {
-			return (T)vmi->read64FromVA(va, pid);
-		} else {
-			std::cout << "Wrong type, type is: " << this->encoding << std::endl;
+		if (typeid(T) != typeid(bool)) {
 			throw DwarfTypeException("Type not bool");
 		}
-	case DW_ATE_complex_float:
-		// Type currenty not expected
-		assert(false);
+		return (T)reader->readUnsigned(va, this->byteSize);
 	case DW_ATE_float:
-		if (typeid(T) == typeid(float)) {
-			return (T)vmi->read64FromVA(va, pid);
-		} else {
-			std::cout << "Wrong type, type is: " << this->encoding << std::endl;
+		if (!std::is_floating_point<T>::value) {
 			throw DwarfTypeException("Type not float");
 		}
-	case DW_ATE_signed:
-		if (typeid(T) == typeid(int64_t)) {
-			return (T)vmi->read64FromVA(va, pid);
-		} else {
-			std::cout << "Wrong type, type is: " << this->encoding << std::endl;
-			throw DwarfTypeException("Type not int64_t");
+		if (this->byteSize == sizeof(float)) {
+			return (T)reader->readValue<float>(va);
+		} else if (this->byteSize == sizeof(double)) {
+			return (T)reader->readValue<double>(va);
 		}
+		throw DwarfTypeException("Unsupported float size");
+	case DW_ATE_signed:
 	case DW_ATE_signed_char:
-		if (typeid(T) == typeid(int8_t)) {
-			return (T)vmi->read8FromVA(va, pid);
-		} else {
-			std::cout << "Wrong type, type is: " << this->encoding << std::endl;
-			throw DwarfTypeException("Type not int8_t");
+		if (!std::is_integral<T>::value || !std::is_signed<T>::value) {
+			throw DwarfTypeException("Type not signed");
 		}
+		return (T)reader->readSigned(va, this->byteSize);
 	case DW_ATE_unsigned:
-		if (typeid(T) == typeid(uint64_t)) {
-			return (T)vmi->read64FromVA(va, pid);
-		} else {
-			std::cout << "Wrong type, type is: " << this->encoding << std::endl;
-			throw DwarfTypeException("Type not uint64_t");
-		}
 	case DW_ATE_unsigned_char:
-		if (typeid(T) == typeid(int8_t)) {
-			return (T)vmi->read8FromVA(va, pid);
-		} else {
-			std::cout << "Wrong type, type is: " << this->encoding << std::endl;
-			throw DwarfTypeException("Type not int8_t");
+		if (!std::is_integral<T>::value || std::is_signed<T>::value) {
+			throw DwarfTypeException("Type not unsigned");
 		}
-	case DW_ATE_imaginary_float:
-		assert(false);
-	case DW_ATE_packed_decimal:
-		assert(false);
-	case DW_ATE_numeric_string:
-		assert(false);
-	case DW_ATE_edited:
-		assert(false);
-	case DW_ATE_signed_fixed:
-		assert(false);
-	case DW_ATE_unsigned_fixed:
-		assert(false);
-	case DW_ATE_decimal_float:
-		assert(false);
+		return (T)reader->readUnsigned(va, this->byteSize);
 	default:
 		std::cout << "Type " << this->encoding << " not expected" << std::endl;
-		assert(false);
-		return 0;
+		throw DwarfTypeException("Encoding not supported");
 	}
 }
-#endif
-
-#if 0
-template <>
-inline int8_t BaseType::getRawValue(uint64_t va, uint64_t pid) const {
-	assert(va);
-	VMIInstance *vmi = VMIInstance::getInstance();
-	return vmi->read8FromVA(va, pid);
-}
-
-template <>
-inline uint8_t BaseType::getRawValue(uint64_t va, uint64_t pid) const {
-	assert(va);
-	VMIInstance *vmi = VMIInstance::getInstance();
-	return vmi->read8FromVA(va, pid);
-}
-
-template <>
-inline int16_t BaseType::getRawValue(uint64_t va, uint64_t pid) const {
-	assert(va);
-	VMIInstance *vmi = VMIInstance::getInstance();
-	return vmi->read16FromVA(va, pid);
-}
-
-template <>
-inline uint16_t BaseType::getRawValue(uint64_t va, uint64_t pid) const {
-	assert(va);
-	VMIInstance *vmi = VMIInstance::getInstance();
-	return vmi->read16FromVA(va, pid);
-}
-
-template <>
-inline int32_t BaseType::getRawValue(uint64_t va, uint64_t pid) const {
-	assert(va);
-	VMIInstance *vmi = VMIInstance::getInstance();
-	return vmi->read32FromVA(va, pid);
-}
-
-template <>
-inline uint32_t BaseType::getRawValue(uint64_t va, uint64_t pid) const {
-	assert(va);
-	VMIInstance *vmi = VMIInstance::getInstance();
-	return vmi->read32FromVA(va, pid);
-}
-
-template <>
-inline int64_t BaseType::getRawValue(uint64_t va, uint64_t pid) const {
-	assert(va);
-	VMIInstance *vmi = VMIInstance::getInstance();
-	return vmi->read64FromVA(va, pid);
-}
-
-template <>
-inline uint64_t BaseType::getRawValue(uint64_t va, uint64_t pid) const {
-	assert(va);
-	VMIInstance *vmi = VMIInstance::getInstance();
-	return vmi->read64FromVA(va, pid);
-}
 
 template <>
-inline std::string BaseType::getRawValue(uint64_t va, uint64_t pid) const {
-	assert(va);
-	VMIInstance *vmi = VMIInstance::getInstance();
-	return vmi->readStrFromVA(va, pid);
+inline std::string BaseType::getRawValue(MemoryReader *reader,
+                                         uint64_t va) const {
+	assert(reader);
+	return reader->readString(va);
 }
 
 template <typename T>
-inline T BaseType::getRawValue(uint64_t va, uint64_t /*pid*/) const {
-	assert(va);
-	return 0;
+inline T BaseType::getRawValue(MemoryReader *reader, uint64_t va) const {
+	assert(reader);
+	return reader->readValue<T>(va);
 }
-#endif
 
 #endif /* _BASETYPE_H_ */
@@ -1,14 +1,31 @@
 #include "consttype.h"
 
+#include "symboldatabase.h"
+
 ConstType::ConstType(SymbolManager *mgr,
                      DwarfParser *parser,
-                     const Dwarf_Die &object,
+                     const DieInfo &info,
                      const std::string &name)
 	:
-	RefBaseType(mgr, parser, object, name) {}
+	RefBaseType(mgr, parser, info, name) {
+	this->kind = SymbolKind::ConstType;
+}
+
+ConstType::ConstType(SymbolManager *mgr,
+                     const DatabaseSymbol &record,
+                     const DatabaseReader &db)
+	:
+	RefBaseType(mgr, record, db) {
+	this->kind = SymbolKind::ConstType;
+}
 
 ConstType::~ConstType() {}
 
+void ConstType::store(DatabaseSymbol &record, DatabaseWriter &db) const {
+	RefBaseType::store(record, db);
+	record.kind = (uint8_t)DatabaseKind::ConstType;
+}
+
 void ConstType::print() const {
 	RefBaseType::print();
 	std::cout << "\t ConstType:" << std::endl;
@@ -7,10 +7,19 @@ class ConstType : public RefBaseType {
 public:
 	ConstType(SymbolManager *mgr,
 	          DwarfParser *parser,
-	          const Dwarf_Die &object,
+	          const DieInfo &info,
 	          const std::string &name);
+	ConstType(SymbolManager *mgr,
+	          const DatabaseSymbol &record,
+	          const DatabaseReader &db);
 	virtual ~ConstType();
 
+	static bool classof(const Symbol *sym) {
+		return sym->getKind() == SymbolKind::ConstType;
+	}
+
+	void store(DatabaseSymbol &record, DatabaseWriter &db) const override;
+
 	void print() const override;
 };
 
@@ -0,0 +1,241 @@
+#include "debugfile.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <gelf.h>
+#include <mutex>
+#include <unistd.h>
+
+namespace {
+
+std::mutex debugDirectoriesMutex;
+std::vector<std::string> debugDirectories{"/usr/lib/debug"};
+
+bool fileExists(const std::string &filename) {
+	return !filename.empty() && access(filename.c_str(), R_OK) == 0;
+}
+
+/**
+ * @return The directory of filename including the trailing slash, an
+ * empty string for a file in the current directory.
+ */
+std::string getDirectory(const std::string &filename) {
+	size_t slash = filename.rfind('/');
+	return (slash == std::string::npos) ? std::string() :
+	       filename.substr(0, slash + 1);
+}
+
+/**
+ * CRC-32 of .gnu_debuglink, the one of zlib.
+ */
+uint32_t updateCRC32(uint32_t crc, const uint8_t *data, size_t size) {
+	static const struct Table {
+		uint32_t entries[256];
+		Table() {
+			for (uint32_t i = 0; i < 256; i++) {
+				uint32_t value = i;
+				for (int bit = 0; bit < 8; bit++) {
+					value = (value >> 1) ^ ((value & 1) ? 0xedb88320 : 0);
+				}
+				entries[i] = value;
+			}
+		}
+	} table;
+
+	crc = ~crc;
+	for (size_t i = 0; i < size; i++) {
+		crc = table.entries[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+	}
+	return ~crc;
+}
+
+/**
+ * @return true if the contents of filename have the CRC-32 crc.
+ */
+bool checkCRC32(const std::string &filename, uint32_t crc) {
+	int fd = open(filename.c_str(), O_RDONLY);
+	if (fd < 0) {
+		return false;
+	}
+	uint8_t buffer[65536];
+	uint32_t fileCRC = 0;
+	ssize_t size;
+	while ((size = read(fd, buffer, sizeof(buffer))) > 0) {
+		fileCRC = updateCRC32(fileCRC, buffer, size);
+	}
+	close(fd);
+	return size == 0 && fileCRC == crc;
+}
+
+/**
+ * Identification of the separate debug file of an ELF file.
+ */
+struct DebugLink {
+	bool hasDebugInfo;
+	std::string buildID;   ///< Hex digits, empty if there is no build id.
+	std::string linkName;  ///< Empty if there is no .gnu_debuglink.
+	uint32_t linkCRC;
+};
+
+/**
+ * Read the sections of filename that identify its debug file.
+ * @return false if it is no ELF file.
+ */
+bool readDebugLink(const std::string &filename, DebugLink &link) {
+	int fd = open(filename.c_str(), O_RDONLY);
+	if (fd < 0) {
+		return false;
+	}
+	elf_version(EV_CURRENT);
+	Elf *elf = elf_begin(fd, ELF_C_READ, nullptr);
+	GElf_Ehdr ehdr;
+	size_t shstrndx;
+	if (!elf || !gelf_getehdr(elf, &ehdr) ||
+	    elf_getshdrstrndx(elf, &shstrndx) != 0) {
+		if (elf) {
+			elf_end(elf);
+		}
+		close(fd);
+		return false;
+	}
+
+	link = DebugLink{false, std::string(), std::string(), 0};
+	Elf_Scn *scn = nullptr;
+	while ((scn = elf_nextscn(elf, scn)) != nullptr) {
+		GElf_Shdr shdr;
+		if (!gelf_getshdr(scn, &shdr)) {
+			continue;
+		}
+		const char *name = elf_strptr(elf, shstrndx, shdr.sh_name);
+		if (!name) {
+			continue;
+		}
+		if (strcmp(name, ".debug_info") == 0) {
+			link.hasDebugInfo = (shdr.sh_type != SHT_NOBITS);
+			continue;
+		}
+		Elf_Data *data = elf_getdata(scn, nullptr);
+		if (!data || !data->d_buf) {
+			continue;
+		}
+		if (strcmp(name, ".gnu_debuglink") == 0) {
+			// name, padding to 4 bytes, CRC in the byte order of the file
+			const char *linkName = (const char *)data->d_buf;
+			size_t length = strnlen(linkName, data->d_size);
+			size_t crcOffset = (length + 4) & ~(size_t)3;
+			if (length && crcOffset + 4 <= data->d_size) {
+				const uint8_t *crc = (const uint8_t *)data->d_buf + crcOffset;
+				bool bigEndian = (ehdr.e_ident[EI_DATA] == ELFDATA2MSB);
+				link.linkName = std::string(linkName, length);
+				link.linkCRC = 0;
+				for (int i = 0; i < 4; i++) {
+					link.linkCRC = (link.linkCRC << 8) | crc[bigEndian ? i : 3 - i];
+				}
+			}
+		} else if (shdr.sh_type == SHT_NOTE) {
+			GElf_Nhdr note;
+			size_t offset = 0, nameOffset, descOffset;
+			while ((offset = gelf_getnote(data, offset, &note, &nameOffset,
+			                              &descOffset)) > 0) {
+				if (note.n_type != NT_GNU_BUILD_ID || note.n_namesz != 4 ||
+				    memcmp((const char *)data->d_buf + nameOffset, "GNU", 4) != 0) {
+					continue;
+				}
+				const uint8_t *id = (const uint8_t *)data->d_buf + descOffset;
+				static const char digits[] = "0123456789abcdef";
+				link.buildID.clear();
+				for (size_t i = 0; i < note.n_descsz; i++) {
+					link.buildID += digits[id[i] >> 4];
+					link.buildID += digits[id[i] & 0xf];
+				}
+			}
+		}
+	}
+	elf_end(elf);
+	close(fd);
+	return true;
+}
+
+}  // namespace
+
+void DebugFile::setDebugDirectories(const std::vector<std::string> &dirs) {
+	std::lock_guard<std::mutex> lock(debugDirectoriesMutex);
+	debugDirectories = dirs;
+}
+
+std::vector<std::string> DebugFile::getDebugDirectories() {
+	std::lock_guard<std::mutex> lock(debugDirectoriesMutex);
+	return debugDirectories;
+}
+
+std::string DebugFile::find(const std::string &filename) {
+	DebugLink link;
+	if (!readDebugLink(filename, link) || link.hasDebugInfo) {
+		return filename;
+	}
+	std::vector<std::string> dirs = DebugFile::getDebugDirectories();
+
+	// at least two digits, the first byte names the subdirectory
+	if (link.buildID.size() > 2) {
+		for (auto &dir : dirs) {
+			std::string candidate = dir + "/.build-id/" +
+			                        link.buildID.substr(0, 2) + "/" +
+			                        link.buildID.substr(2) + ".debug";
+			if (fileExists(candidate)) {
+				return candidate;
+			}
+		}
+	}
+
+	if (!link.linkName.empty()) {
+		std::string dir = getDirectory(filename);
+		std::vector<std::string> candidates{dir + link.linkName,
+		                                    dir + ".debug/" + link.linkName};
+		char *absolute = realpath(filename.c_str(), nullptr);
+		if (absolute) {
+			for (auto &debugDir : dirs) {
+				candidates.push_back(debugDir + getDirectory(absolute) +
+				                     link.linkName);
+			}
+			free(absolute);
+		}
+		for (auto &candidate : candidates) {
+			// the binary itself may have the name of the link
+			if (candidate != filename && fileExists(candidate) &&
+			    checkCRC32(candidate, link.linkCRC)) {
+				return candidate;
+			}
+		}
+	}
+	return filename;
+}
+
+std::string DebugFile::findSplitFile(const std::string &filename,
+                                     const char *dwoName,
+                                     const char *compDir) {
+	if (!dwoName || !*dwoName) {
+		return std::string();
+	}
+	if (dwoName[0] == '/') {
+		return fileExists(dwoName) ? dwoName : std::string();
+	}
+	if (compDir && *compDir) {
+		std::string candidate = std::string(compDir) + "/" + dwoName;
+		if (fileExists(candidate)) {
+			return candidate;
+		}
+	}
+	// the build directory may be gone, try next to the binary
+	std::string candidate = getDirectory(filename) + dwoName;
+	if (!filename.empty() && fileExists(candidate)) {
+		return candidate;
+	}
+	return std::string();
+}
+
+std::string DebugFile::findPackage(const std::string &filename) {
+	std::string candidate = filename + ".dwp";
+	return (!filename.empty() && fileExists(candidate)) ?
+	       candidate : std::string();
+}
@@ -0,0 +1,47 @@
+#ifndef _DEBUGFILE_H_
+#define _DEBUGFILE_H_
+
+#include <string>
+#include <vector>
+
+/**
+ * Lookup of debugging information that is not in the binary itself: the
+ * separate debug file of a stripped binary, found by its build id or its
+ * .gnu_debuglink, and the .dwo files or .dwp package of split DWARF units.
+ * The search follows the conventions of gdb.
+ */
+class DebugFile {
+public:
+	/**
+	 * Set the directories searched for separate debug files, the default
+	 * is /usr/lib/debug.
+	 */
+	static void setDebugDirectories(const std::vector<std::string> &dirs);
+	static std::vector<std::string> getDebugDirectories();
+
+	/**
+	 * @return filename if it has a .debug_info section, otherwise its
+	 * separate debug file
+	 * - DIR/.build-id/xx/yyyy.debug for build id xxyyyy
+	 * - the .gnu_debuglink name in the directory of filename, its .debug
+	 *   subdirectory or below DIR, if its CRC matches
+	 * for every debug directory DIR. filename if none is found.
+	 */
+	static std::string find(const std::string &filename);
+
+	/**
+	 * @return The .dwo file dwoName of a skeleton unit of filename, relative
+	 * to compDir or the directory of filename, an empty string if it does
+	 * not exist.
+	 */
+	static std::string findSplitFile(const std::string &filename,
+	                                 const char *dwoName, const char *compDir);
+
+	/**
+	 * @return The split DWARF package filename.dwp, an empty string if it
+	 * does not exist.
+	 */
+	static std::string findPackage(const std::string &filename);
+};
+
+#endif /* _DEBUGFILE_H_ */
@@ -0,0 +1,1055 @@
+#include "dwarfdecoder.h"
+
+#include <algorithm>
+#include <cstring>
+#include <gelf.h>
+#include <libdwarf/dwarf.h>
+
+#include "dwarfexception.h"
+#include "leb128.h"
+
+namespace {
+
+/**
+ * Results of getFormSize() for forms without a fixed size.
+ */
+enum {
+	SIZE_VARIABLE = -1,
+	SIZE_UNKNOWN  = -2,
+};
+
+/**
+ * Section columns of a .debug_cu_index, see section 7.3.5.3 of DWARF 5.
+ * Version 2 (the GNU extension for DWARF 4) uses the same numbers for
+ * these, but 8 is .debug_macro there.
+ */
+enum {
+	SECT_INFO        = 1,
+	SECT_ABBREV      = 3,
+	SECT_STR_OFFSETS = 6,
+	SECT_RNGLISTS    = 8,
+};
+
+/**
+ * Larger abbreviation codes are not used by any known producer.
+ */
+const uint64_t maxAbbrevCode = 1 << 16;
+
+inline uint64_t readULEB(const uint8_t *&pos, const uint8_t *end) {
+	uint64_t value;
+	size_t length = decodeULEB128(pos, end, value);
+	if (!length) {
+		throw DwarfException("LEB128 value past the end of the section");
+	}
+	pos += length;
+	return value;
+}
+
+inline int64_t readSLEB(const uint8_t *&pos, const uint8_t *end) {
+	int64_t value;
+	size_t length = decodeSLEB128(pos, end, value);
+	if (!length) {
+		throw DwarfException("LEB128 value past the end of the section");
+	}
+	pos += length;
+	return value;
+}
+
+/**
+ * @return true if the values of form are a single LEB128 number.
+ */
+bool isLEB128Form(uint64_t form) {
+	switch (form) {
+	case DW_FORM_sdata:
+	case DW_FORM_udata:
+	case DW_FORM_ref_udata:
+	case DW_FORM_strx:
+	case DW_FORM_addrx:
+	case DW_FORM_loclistx:
+	case DW_FORM_rnglistx:
+	case DW_FORM_GNU_addr_index:
+	case DW_FORM_GNU_str_index:
+		return true;
+	default:
+		return false;
+	}
+}
+
+/**
+ * @return Size of a value of form in unit, or SIZE_VARIABLE or
+ * SIZE_UNKNOWN.
+ */
+int64_t getFormSize(uint64_t form, const DwarfDecoder::Unit &unit) {
+	switch (form) {
+	case DW_FORM_flag_present:
+	case DW_FORM_implicit_const:
+		return 0;
+	case DW_FORM_data1:
+	case DW_FORM_ref1:
+	case DW_FORM_flag:
+	case DW_FORM_strx1:
+	case DW_FORM_addrx1:
+		return 1;
+	case DW_FORM_data2:
+	case DW_FORM_ref2:
+	case DW_FORM_strx2:
+	case DW_FORM_addrx2:
+		return 2;
+	case DW_FORM_strx3:
+	case DW_FORM_addrx3:
+		return 3;
+	case DW_FORM_data4:
+	case DW_FORM_ref4:
+	case DW_FORM_ref_sup4:
+	case DW_FORM_strx4:
+	case DW_FORM_addrx4:
+		return 4;
+	case DW_FORM_data8:
+	case DW_FORM_ref8:
+	case DW_FORM_ref_sig8:
+	case DW_FORM_ref_sup8:
+		return 8;
+	case DW_FORM_data16:
+		return 16;
+	case DW_FORM_addr:
+		return unit.addressSize;
+	case DW_FORM_strp:
+	case DW_FORM_line_strp:
+	case DW_FORM_sec_offset:
+	case DW_FORM_strp_sup:
+	case DW_FORM_GNU_ref_alt:
+	case DW_FORM_GNU_strp_alt:
+		return unit.offsetSize;
+	case DW_FORM_ref_addr:
+		// DWARF 2 uses the address size
+		return (unit.version <= 2) ? unit.addressSize : unit.offsetSize;
+	case DW_FORM_sdata:
+	case DW_FORM_udata:
+	case DW_FORM_ref_udata:
+	case DW_FORM_strx:
+	case DW_FORM_addrx:
+	case DW_FORM_loclistx:
+	case DW_FORM_rnglistx:
+	case DW_FORM_GNU_addr_index:
+	case DW_FORM_GNU_str_index:
+	case DW_FORM_string:
+	case DW_FORM_block:
+	case DW_FORM_block1:
+	case DW_FORM_block2:
+	case DW_FORM_block4:
+	case DW_FORM_exprloc:
+	case DW_FORM_indirect:
+		return SIZE_VARIABLE;
+	default:
+		return SIZE_UNKNOWN;
+	}
+}
+
+}  // namespace
+
+DwarfDecoder::DwarfDecoder()
+	:
+	elf{nullptr},
+	bigEndian{false},
+	valid{false},
+	info{},
+	abbrev{},
+	str{},
+	lineStr{},
+	strOffsets{},
+	addr{},
+	ranges{},
+	rnglists{},
+	skeleton{} {}
+
+DwarfDecoder::DwarfDecoder(int fd,
+                           std::shared_ptr<const DwarfDecoder> skeleton)
+	:
+	DwarfDecoder() {
+	this->skeleton = skeleton;
+	if (!this->openElf(fd, skeleton != nullptr)) {
+		return;
+	}
+
+	std::string suffix = skeleton ? ".dwo" : "";
+	if (!this->getSection(".debug_info" + suffix, this->info, true) ||
+	    !this->getSection(".debug_abbrev" + suffix, this->abbrev, true) ||
+	    !this->getSection(".debug_str" + suffix, this->str) ||
+	    !this->getSection(".debug_str_offsets" + suffix, this->strOffsets) ||
+	    !this->getSection(".debug_rnglists" + suffix, this->rnglists)) {
+		return;
+	}
+	if (skeleton) {
+		// addresses and DWARF 4 range lists are in the skeleton file
+		this->addr   = skeleton->addr;
+		this->ranges = skeleton->ranges;
+	} else if (!this->getSection(".debug_line_str", this->lineStr) ||
+	           !this->getSection(".debug_addr", this->addr) ||
+	           !this->getSection(".debug_ranges", this->ranges)) {
+		return;
+	}
+	// strings are used in place, they have to be terminated
+	if ((this->str.size && this->str.data[this->str.size - 1]) ||
+	    (this->lineStr.size && this->lineStr.data[this->lineStr.size - 1])) {
+		return;
+	}
+
+	try {
+		this->valid = this->readUnits();
+	} catch (DwarfException &) {
+		this->valid = false;
+	}
+	if (!this->valid) {
+		this->units.clear();
+		this->abbrevTables.clear();
+		this->skeletonUnits.clear();
+	}
+}
+
+DwarfDecoder::~DwarfDecoder() {
+	if (this->elf) {
+		elf_end(this->elf);
+	}
+}
+
+bool DwarfDecoder::hasSkeletonUnits(int fd) {
+	DwarfDecoder decoder;
+	if (!decoder.openElf(fd, false) ||
+	    !decoder.getSection(".debug_info", decoder.info, true) ||
+	    !decoder.getSection(".debug_abbrev", decoder.abbrev, true)) {
+		return false;
+	}
+
+	const uint8_t *pos = decoder.info.data;
+	const uint8_t *end = decoder.info.data + decoder.info.size;
+	try {
+		while (pos < end) {
+			Unit unit;
+			uint64_t abbrevOffset;
+			if (!decoder.readUnitHeader(pos, unit, abbrevOffset)) {
+				return false;
+			}
+			uint64_t code = readULEB(pos, decoder.info.data + unit.end);
+			if (decoder.isSkeletonAbbrev(abbrevOffset, code)) {
+				return true;
+			}
+			pos = decoder.info.data + unit.end;
+		}
+	} catch (DwarfException &) {
+		return false;
+	}
+	return false;
+}
+
+bool DwarfDecoder::isValid() const {
+	return this->valid;
+}
+
+const std::vector<DwarfDecoder::Unit> &DwarfDecoder::getUnits() const {
+	return this->units;
+}
+
+const DwarfDecoder::Unit *DwarfDecoder::findUnit(uint64_t offset) const {
+	auto unit = std::upper_bound(
+		this->units.begin(), this->units.end(), offset,
+		[](uint64_t offset, const Unit &unit) {
+			return offset < unit.offset;
+		});
+	if (unit == this->units.begin() || offset >= (--unit)->end) {
+		return nullptr;
+	}
+	return &*unit;
+}
+
+const DwarfDecoder::Unit *DwarfDecoder::findSkeletonUnit(
+		uint64_t dwoID) const {
+	auto unit = this->skeletonUnits.find(dwoID);
+	return (unit == this->skeletonUnits.end()) ?
+	       nullptr : &this->units[unit->second];
+}
+
+bool DwarfDecoder::getAddress(const Unit &unit, uint64_t index,
+                              uint64_t &address) const {
+	return this->readIndex(this->addr, unit.addrBase, index, unit.addressSize,
+	                       address);
+}
+
+/**
+ * Open the ELF file fd, split is set for a .dwo file or .dwp package.
+ * @return false if it cannot be decoded.
+ */
+bool DwarfDecoder::openElf(int fd, bool split) {
+	elf_version(EV_CURRENT);
+	this->elf = elf_begin(fd, ELF_C_READ_MMAP, nullptr);
+	GElf_Ehdr ehdr;
+	// relocatable objects would need their relocations applied, the
+	// sections of split units have none
+	if (!this->elf || !gelf_getehdr(this->elf, &ehdr) ||
+	    (ehdr.e_type == ET_REL && !split)) {
+		return false;
+	}
+	this->bigEndian = (ehdr.e_ident[EI_DATA] == ELFDATA2MSB);
+	return true;
+}
+
+/**
+ * Find the section name. A missing section is empty.
+ * @return false if it is missing but required, or it cannot be used
+ * directly.
+ */
+bool DwarfDecoder::getSection(const std::string &name, Section &section,
+                              bool required) {
+	size_t shstrndx;
+	if (elf_getshdrstrndx(this->elf, &shstrndx) != 0) {
+		return false;
+	}
+	Elf_Scn *scn = nullptr;
+	while ((scn = elf_nextscn(this->elf, scn)) != nullptr) {
+		GElf_Shdr shdr;
+		if (!gelf_getshdr(scn, &shdr)) {
+			continue;
+		}
+		const char *scnName = elf_strptr(this->elf, shstrndx, shdr.sh_name);
+		if (!scnName || name != scnName) {
+			continue;
+		}
+		if (shdr.sh_type == SHT_NOBITS || (shdr.sh_flags & SHF_COMPRESSED)) {
+			return false;
+		}
+		Elf_Data *scnData = elf_getdata(scn, nullptr);
+		if (!scnData || (!scnData->d_buf && scnData->d_size)) {
+			return false;
+		}
+		section.data = (const uint8_t *)scnData->d_buf;
+		section.size = scnData->d_size;
+		return section.size || !required;
+	}
+	return !required;
+}
+
+/**
+ * Read all unit headers of .debug_info and their abbreviations.
+ * @return false if a unit cannot be decoded.
+ */
+bool DwarfDecoder::readUnits() {
+	std::map<uint64_t, Contribution> contributions;
+	if (this->skeleton && !this->readPackageIndex(contributions)) {
+		return false;
+	}
+
+	const uint8_t *pos = this->info.data;
+	const uint8_t *end = this->info.data + this->info.size;
+	while (pos < end) {
+		Unit unit;
+		uint64_t abbrevOffset;
+		if (!this->readUnitHeader(pos, unit, abbrevOffset)) {
+			return false;
+		}
+
+		if (this->skeleton) {
+			// the range lists of a split unit follow the header
+			unit.rnglistsBase = (unit.offsetSize == 4) ? 12 : 20;
+			auto contribution = contributions.find(unit.offset);
+			if (contribution != contributions.end()) {
+				abbrevOffset        += contribution->second.abbrev;
+				unit.strOffsetsBase += contribution->second.strOffsets;
+				unit.rnglistsBase   += contribution->second.rnglists;
+			}
+		}
+
+		unit.abbrevs = this->readAbbrevs(unit, abbrevOffset);
+		if (!unit.abbrevs) {
+			return false;
+		}
+		this->readUnitAttributes(unit);
+		if (this->skeleton) {
+			unit.skeleton = this->skeleton->findSkeletonUnit(unit.dwoID);
+			if (unit.skeleton) {
+				unit.addrBase    = unit.skeleton->addrBase;
+				unit.baseAddress = unit.skeleton->baseAddress;
+			}
+		} else if (unit.dwoName) {
+			this->skeletonUnits[unit.dwoID] = this->units.size();
+		}
+		this->units.push_back(unit);
+		pos = this->info.data + unit.end;
+	}
+	return true;
+}
+
+/**
+ * Read the header of the unit at pos into unit, pos is left at the unit
+ * DIE.
+ * @return false if the unit cannot be decoded.
+ */
+bool DwarfDecoder::readUnitHeader(const uint8_t *&pos, Unit &unit,
+                                  uint64_t &abbrevOffset) const {
+	const uint8_t *end = this->info.data + this->info.size;
+	unit = Unit{};
+	unit.offset = pos - this->info.data;
+	unit.offsetSize = 4;
+	uint64_t length = this->read(pos, end, 4);
+	if (length == 0xffffffff) {
+		length = this->read(pos, end, 8);
+		unit.offsetSize = 8;
+	}
+	if (length > (uint64_t)(end - pos)) {
+		return false;
+	}
+	const uint8_t *unitEnd = pos + length;
+	unit.end = unitEnd - this->info.data;
+
+	unit.version = this->read(pos, unitEnd, 2);
+	if (unit.version < 2 || unit.version > 5) {
+		return false;
+	}
+	if (unit.version == 5) {
+		uint64_t type    = this->read(pos, unitEnd, 1);
+		unit.addressSize = this->read(pos, unitEnd, 1);
+		abbrevOffset     = this->read(pos, unitEnd, unit.offsetSize);
+		switch (type) {
+		case DW_UT_compile:
+		case DW_UT_partial:
+			break;
+		case DW_UT_skeleton:
+		case DW_UT_split_compile:
+			unit.dwoID = this->read(pos, unitEnd, 8);
+			break;
+		case DW_UT_type:
+		case DW_UT_split_type:
+			this->read(pos, unitEnd, 8);  // type signature
+			this->read(pos, unitEnd, unit.offsetSize);
+			break;
+		default:
+			return false;
+		}
+		// the header of .debug_str_offsets if there is no base
+		unit.strOffsetsBase = 2 * unit.offsetSize;
+	} else {
+		abbrevOffset     = this->read(pos, unitEnd, unit.offsetSize);
+		unit.addressSize = this->read(pos, unitEnd, 1);
+	}
+	if (unit.addressSize == 0 || unit.addressSize > 8) {
+		return false;
+	}
+	unit.dieOffset = pos - this->info.data;
+	return true;
+}
+
+/**
+ * @return true if the abbreviation code of the table at abbrevOffset is
+ * that of a skeleton unit, a DWARF 5 DW_TAG_skeleton_unit or a DWARF 4
+ * unit with DW_AT_GNU_dwo_name. The other abbreviations are only skipped.
+ */
+bool DwarfDecoder::isSkeletonAbbrev(uint64_t abbrevOffset,
+                                    uint64_t code) const {
+	if (abbrevOffset >= this->abbrev.size) {
+		return false;
+	}
+	const uint8_t *pos = this->abbrev.data + abbrevOffset;
+	const uint8_t *end = this->abbrev.data + this->abbrev.size;
+	uint64_t entryCode;
+	while ((entryCode = readULEB(pos, end)) != 0) {
+		uint64_t tag = readULEB(pos, end);
+		if (entryCode == code && tag == DW_TAG_skeleton_unit) {
+			return true;
+		}
+		this->read(pos, end, 1);  // children
+		while (true) {
+			uint64_t attr = readULEB(pos, end);
+			uint64_t form = readULEB(pos, end);
+			if (!attr && !form) {
+				break;
+			}
+			if (form == DW_FORM_implicit_const) {
+				readSLEB(pos, end);
+			}
+			if (entryCode == code &&
+			    (attr == DW_AT_dwo_name || attr == DW_AT_GNU_dwo_name)) {
+				return true;
+			}
+		}
+		if (entryCode == code) {
+			return false;
+		}
+	}
+	return false;
+}
+
+/**
+ * Read the .debug_cu_index of a split DWARF package, see section 7.3.5 of
+ * DWARF 5, version 2 is its predecessor for DWARF 4.
+ * @param contributions Contributions by the .debug_info.dwo offset of the
+ * unit, empty if this is a .dwo file.
+ * @return false if the index cannot be decoded.
+ */
+bool DwarfDecoder::readPackageIndex(
+		std::map<uint64_t, Contribution> &contributions) {
+	Section index{};
+	if (!this->getSection(".debug_cu_index", index)) {
+		return false;
+	}
+	if (!index.size) {
+		return true;
+	}
+
+	const uint8_t *pos = index.data;
+	const uint8_t *end = index.data + index.size;
+	// version 5 is 2 bytes followed by padding, version 2 has 4 bytes
+	uint64_t version = this->read(pos, end, 2);
+	this->read(pos, end, 2);
+	if (version == 0 && this->bigEndian) {
+		pos = index.data;
+		version = this->read(pos, end, 4);
+	}
+	if (version != 2 && version != 5) {
+		return false;
+	}
+	uint64_t columns = this->read(pos, end, 4);
+	uint64_t rows    = this->read(pos, end, 4);
+	uint64_t slots   = this->read(pos, end, 4);
+	// the hash table is not needed, units are found by their offset
+	if (slots * 12 > (uint64_t)(end - pos)) {
+		return false;
+	}
+	pos += slots * 12;
+	if (columns * (2 * rows + 1) * 4 > (uint64_t)(end - pos)) {
+		return false;
+	}
+
+	std::vector<uint64_t> sections(columns);
+	for (auto &section : sections) {
+		section = this->read(pos, end, 4);
+	}
+	for (uint64_t row = 0; row < rows; row++) {
+		uint64_t info = 0;
+		Contribution contribution{0, 0, 0};
+		for (uint64_t column = 0; column < columns; column++) {
+			uint64_t offset = this->read(pos, end, 4);
+			switch (sections[column]) {
+			case SECT_INFO:
+				info = offset;
+				break;
+			case SECT_ABBREV:
+				contribution.abbrev = offset;
+				break;
+			case SECT_STR_OFFSETS:
+				contribution.strOffsets = offset;
+				break;
+			case SECT_RNGLISTS:
+				if (version == 5) {
+					contribution.rnglists = offset;
+				}
+				break;
+			}
+		}
+		contributions[info] = contribution;
+	}
+	return true;
+}
+
+/**
+ * @return The abbreviation table at abbrevOffset, nullptr if it contains
+ * an unknown form.
+ */
+const std::vector<DwarfDecoder::Abbrev> *DwarfDecoder::readAbbrevs(
+		const Unit &unit, uint64_t abbrevOffset) {
+	AbbrevKey key{abbrevOffset, unit.addressSize, unit.offsetSize,
+	              unit.version};
+	auto cached = this->abbrevTables.find(key);
+	if (cached != this->abbrevTables.end()) {
+		return &cached->second;
+	}
+	if (abbrevOffset >= this->abbrev.size) {
+		return nullptr;
+	}
+
+	std::vector<Abbrev> table;
+	const uint8_t *pos = this->abbrev.data + abbrevOffset;
+	const uint8_t *end = this->abbrev.data + this->abbrev.size;
+	while (true) {
+		uint64_t code = readULEB(pos, end);
+		if (!code) {
+			break;
+		}
+		if (code >= maxAbbrevCode) {
+			return nullptr;
+		}
+		if (code >= table.size()) {
+			table.resize(code + 1, Abbrev{0, false, 0, {}, {}});
+		}
+		Abbrev &entry = table[code];
+		entry.tag = readULEB(pos, end);
+		entry.hasChildren = (this->read(pos, end, 1) == DW_CHILDREN_yes);
+		entry.fixedSize = 0;
+		entry.attributes.clear();
+		entry.skipSteps.clear();
+		while (true) {
+			uint64_t attr = readULEB(pos, end);
+			uint64_t form = readULEB(pos, end);
+			if (!attr && !form) {
+				break;
+			}
+			int64_t implicitConst =
+				(form == DW_FORM_implicit_const) ? readSLEB(pos, end) : 0;
+			int64_t size = getFormSize(form, unit);
+			if (size == SIZE_UNKNOWN) {
+				return nullptr;
+			}
+			if (size == SIZE_VARIABLE) {
+				entry.fixedSize = SIZE_VARIABLE;
+			} else if (entry.fixedSize != SIZE_VARIABLE) {
+				entry.fixedSize += size;
+			}
+			entry.attributes.push_back(
+				AttributeSpec{(uint16_t)attr, (uint16_t)form, implicitConst});
+		}
+		if (entry.fixedSize == SIZE_VARIABLE) {
+			this->makeSkipSteps(unit, entry);
+		}
+	}
+	return &(this->abbrevTables[key] = std::move(table));
+}
+
+/**
+ * Group the attribute values of abbrev into runs of fixed size values and
+ * LEB128 numbers, which are skipped without decoding them one by one.
+ */
+void DwarfDecoder::makeSkipSteps(const Unit &unit, Abbrev &abbrev) {
+	SkipStep step{0, 0, -1};
+	for (size_t i = 0; i < abbrev.attributes.size(); i++) {
+		uint64_t form = abbrev.attributes[i].form;
+		int64_t size = getFormSize(form, unit);
+		if (size >= 0) {
+			if (step.lebCount) {
+				abbrev.skipSteps.push_back(step);
+				step = SkipStep{0, 0, -1};
+			}
+			step.fixedSize += size;
+		} else if (isLEB128Form(form)) {
+			step.lebCount++;
+		} else {
+			step.attribute = i;
+			abbrev.skipSteps.push_back(step);
+			step = SkipStep{0, 0, -1};
+		}
+	}
+	if (step.fixedSize || step.lebCount) {
+		abbrev.skipSteps.push_back(step);
+	}
+}
+
+/**
+ * Read the bases and the base address from the unit DIE.
+ */
+void DwarfDecoder::readUnitAttributes(Unit &unit) {
+	Die die;
+	if (!this->getDie(unit, unit.dieOffset, die) || !die.abbrev) {
+		return;
+	}
+	std::vector<Attribute> attributes;
+	this->getAttributes(die, attributes);
+	for (auto &attribute : attributes) {
+		switch (attribute.attr) {
+		case DW_AT_str_offsets_base:
+			unit.strOffsetsBase = attribute.value;
+			break;
+		case DW_AT_addr_base:
+		case DW_AT_GNU_addr_base:
+			unit.addrBase = attribute.value;
+			break;
+		case DW_AT_rnglists_base:
+			unit.rnglistsBase = attribute.value;
+			break;
+		case DW_AT_GNU_ranges_base:
+			unit.rangesBase = attribute.value;
+			break;
+		case DW_AT_GNU_dwo_id:
+			unit.dwoID = attribute.value;
+			break;
+		}
+	}
+	// the bases also apply to the attributes of the unit DIE itself
+	this->getAttributes(die, attributes);
+	for (auto &attribute : attributes) {
+		switch (attribute.attr) {
+		case DW_AT_low_pc:
+			unit.baseAddress = attribute.value;
+			break;
+		case DW_AT_dwo_name:
+		case DW_AT_GNU_dwo_name:
+			unit.dwoName = (const char *)attribute.data;
+			break;
+		case DW_AT_comp_dir:
+			unit.compDir = (const char *)attribute.data;
+			break;
+		}
+	}
+}
+
+bool DwarfDecoder::getDie(const Unit &unit, uint64_t offset, Die &die) const {
+	if (offset < unit.dieOffset || offset >= unit.end) {
+		return false;
+	}
+	const uint8_t *pos = this->info.data + offset;
+	uint64_t code = readULEB(pos, this->info.data + unit.end);
+
+	die.unit    = &unit;
+	die.offset  = offset;
+	die.values  = pos;
+	die.sibling = 0;
+	if (!code) {
+		die.abbrev = nullptr;
+		die.end    = pos;
+		return true;
+	}
+	if (code >= unit.abbrevs->size() || !(*unit.abbrevs)[code].tag) {
+		throw DwarfException("Invalid abbreviation code");
+	}
+	die.abbrev = &(*unit.abbrevs)[code];
+	die.end    = nullptr;
+	return true;
+}
+
+void DwarfDecoder::getAttributes(Die &die,
+                                 std::vector<Attribute> &attributes) const {
+	if (!die.abbrev) {
+		attributes.clear();
+		return;
+	}
+	const std::vector<AttributeSpec> &specs = die.abbrev->attributes;
+	const uint8_t *pos = die.values;
+	const uint8_t *end = this->info.data + die.unit->end;
+	attributes.resize(specs.size());
+	for (size_t i = 0; i < specs.size(); i++) {
+		pos = this->readForm(*die.unit, specs[i], pos, end, &attributes[i]);
+		if (specs[i].attr == DW_AT_sibling) {
+			die.sibling = attributes[i].value;
+		}
+	}
+	die.end = pos;
+}
+
+uint64_t DwarfDecoder::getNextOffset(Die &die) const {
+	return this->skipValues(die) - this->info.data;
+}
+
+uint64_t DwarfDecoder::getSiblingOffset(Die &die) const {
+	uint64_t offset = this->getNextOffset(die);
+	if (!die.abbrev || !die.abbrev->hasChildren) {
+		return offset;
+	}
+	if (die.sibling > die.offset && die.sibling <= die.unit->end) {
+		return die.sibling;
+	}
+
+	// skip the children without decoding their attributes
+	unsigned depth = 1;
+	Die child;
+	while (depth && this->getDie(*die.unit, offset, child)) {
+		if (!child.abbrev) {
+			depth--;
+		} else if (child.abbrev->hasChildren) {
+			depth++;
+		}
+		offset = this->getNextOffset(child);
+	}
+	return offset;
+}
+
+const uint8_t *DwarfDecoder::skipValues(Die &die) const {
+	if (die.end) {
+		return die.end;
+	}
+	const uint8_t *end = this->info.data + die.unit->end;
+	if (die.abbrev->fixedSize >= 0) {
+		if (die.abbrev->fixedSize > end - die.values) {
+			throw DwarfException("DIE past the end of the unit");
+		}
+		die.end = die.values + die.abbrev->fixedSize;
+		return die.end;
+	}
+	const uint8_t *pos = die.values;
+	for (auto &step : die.abbrev->skipSteps) {
+		if (step.fixedSize > end - pos) {
+			throw DwarfException("DIE past the end of the unit");
+		}
+		pos = skipLEB128(pos + step.fixedSize, end, step.lebCount);
+		if (!pos) {
+			throw DwarfException("LEB128 value past the end of the section");
+		}
+		if (step.attribute >= 0) {
+			pos = this->readForm(*die.unit, die.abbrev->attributes[step.attribute],
+			                     pos, end, nullptr);
+		}
+	}
+	die.end = pos;
+	return pos;
+}
+
+uint64_t DwarfDecoder::read(const uint8_t *&pos, const uint8_t *end,
+                            unsigned size) const {
+	if (size > (uint64_t)(end - pos)) {
+		throw DwarfException("Value past the end of the section");
+	}
+	uint64_t value = 0;
+	for (unsigned i = 0; i < size; i++) {
+		value = (value << 8) | pos[this->bigEndian ? i : size - 1 - i];
+	}
+	pos += size;
+	return value;
+}
+
+/**
+ * Read or skip the value of spec at pos.
+ * @return The position after the value.
+ */
+const uint8_t *DwarfDecoder::readForm(const Unit &unit,
+                                      const AttributeSpec &spec,
+                                      const uint8_t *pos, const uint8_t *end,
+                                      Attribute *attribute) const {
+	uint64_t form = spec.form;
+	while (form == DW_FORM_indirect) {
+		form = readULEB(pos, end);
+	}
+
+	uint64_t value = 0;
+	const uint8_t *data = nullptr;
+	int64_t size = getFormSize(form, unit);
+	switch (form) {
+	case DW_FORM_flag_present:
+		value = 1;
+		break;
+	case DW_FORM_implicit_const:
+		value = spec.implicitConst;
+		break;
+	case DW_FORM_data16:
+		data = pos;
+		value = 16;
+		pos += 16;
+		if (pos > end) {
+			throw DwarfException("Value past the end of the section");
+		}
+		break;
+	case DW_FORM_sdata:
+		value = readSLEB(pos, end);
+		break;
+	case DW_FORM_udata:
+	case DW_FORM_ref_udata:
+	case DW_FORM_strx:
+	case DW_FORM_addrx:
+	case DW_FORM_loclistx:
+	case DW_FORM_rnglistx:
+	case DW_FORM_GNU_addr_index:
+	case DW_FORM_GNU_str_index:
+		value = readULEB(pos, end);
+		break;
+	case DW_FORM_string:
+		data = pos;
+		pos = (const uint8_t *)memchr(pos, 0, end - pos);
+		if (!pos) {
+			throw DwarfException("Unterminated string");
+		}
+		pos++;
+		break;
+	case DW_FORM_block:
+	case DW_FORM_exprloc:
+		value = readULEB(pos, end);
+		data = pos;
+		break;
+	case DW_FORM_block1:
+		value = this->read(pos, end, 1);
+		data = pos;
+		break;
+	case DW_FORM_block2:
+		value = this->read(pos, end, 2);
+		data = pos;
+		break;
+	case DW_FORM_block4:
+		value = this->read(pos, end, 4);
+		data = pos;
+		break;
+	default:
+		if (size < 0) {
+			throw DwarfException("Unsupported form");
+		}
+		value = this->read(pos, end, size);
+	}
+	if (data && form != DW_FORM_string && form != DW_FORM_data16) {
+		if (value > (uint64_t)(end - pos)) {
+			throw DwarfException("Block past the end of the section");
+		}
+		pos += value;
+	}
+
+	if (attribute) {
+		attribute->attr  = spec.attr;
+		attribute->form  = form;
+		attribute->value = value;
+		attribute->data  = data;
+		this->resolve(unit, *attribute);
+	}
+	return pos;
+}
+
+/**
+ * Resolve the unit relative references and the indirect values of
+ * attribute.
+ */
+void DwarfDecoder::resolve(const Unit &unit, Attribute &attribute) const {
+	uint64_t offset;
+	switch (attribute.form) {
+	case DW_FORM_ref1:
+	case DW_FORM_ref2:
+	case DW_FORM_ref4:
+	case DW_FORM_ref8:
+	case DW_FORM_ref_udata:
+		attribute.value += unit.offset;
+		break;
+	case DW_FORM_strp:
+		attribute.data = (attribute.value < this->str.size) ?
+		                 this->str.data + attribute.value : nullptr;
+		break;
+	case DW_FORM_line_strp:
+		attribute.data = (attribute.value < this->lineStr.size) ?
+		                 this->lineStr.data + attribute.value : nullptr;
+		break;
+	case DW_FORM_strx:
+	case DW_FORM_strx1:
+	case DW_FORM_strx2:
+	case DW_FORM_strx3:
+	case DW_FORM_strx4:
+	case DW_FORM_GNU_str_index:
+		attribute.data = (this->readIndex(this->strOffsets, unit.strOffsetsBase,
+		                                  attribute.value, unit.offsetSize,
+		                                  offset) &&
+		                  offset < this->str.size) ?
+		                 this->str.data + offset : nullptr;
+		break;
+	case DW_FORM_addrx:
+	case DW_FORM_addrx1:
+	case DW_FORM_addrx2:
+	case DW_FORM_addrx3:
+	case DW_FORM_addrx4:
+	case DW_FORM_GNU_addr_index:
+		if (!this->readIndex(this->addr, unit.addrBase, attribute.value,
+		                     unit.addressSize, attribute.value)) {
+			attribute.value = 0;
+		}
+		break;
+	case DW_FORM_rnglistx:
+		// the offsets are relative to the base
+		if (this->readIndex(this->rnglists, unit.rnglistsBase, attribute.value,
+		                    unit.offsetSize, offset)) {
+			attribute.value = unit.rnglistsBase + offset;
+		}
+		break;
+	case DW_FORM_strp_sup:
+	case DW_FORM_GNU_strp_alt:
+		// in the supplementary object file
+		attribute.data = nullptr;
+		break;
+	}
+}
+
+/**
+ * Read entry index of the table at base of section.
+ * @return false if it is outside of the section.
+ */
+bool DwarfDecoder::readIndex(const Section &section, uint64_t base,
+                             uint64_t index, unsigned size,
+                             uint64_t &value) const {
+	if (base > section.size || index >= (section.size - base) / size) {
+		return false;
+	}
+	const uint8_t *pos = section.data + base + index * size;
+	value = this->read(pos, section.data + section.size, size);
+	return true;
+}
+
+std::vector<std::pair<uint64_t, uint64_t>> DwarfDecoder::getRanges(
+		const Unit &unit, uint64_t offset) const {
+	std::vector<std::pair<uint64_t, uint64_t>> result;
+	uint64_t base = unit.baseAddress;
+	unsigned size = unit.addressSize;
+
+	if (unit.version < 5) {
+		// offsets of DWARF 4 split units are relative to the skeleton's base
+		if (unit.skeleton) {
+			offset += unit.skeleton->rangesBase;
+		}
+		if (offset >= this->ranges.size) {
+			return result;
+		}
+		const uint8_t *pos = this->ranges.data + offset;
+		const uint8_t *end = this->ranges.data + this->ranges.size;
+		uint64_t selection = (size == 8) ? UINT64_MAX : (1ULL << (size * 8)) - 1;
+		while ((uint64_t)(end - pos) >= 2u * size) {
+			uint64_t begin = this->read(pos, end, size);
+			uint64_t last  = this->read(pos, end, size);
+			if (!begin && !last) {
+				break;
+			}
+			if (begin == selection) {
+				base = last;
+			} else if (last > begin) {
+				result.push_back(std::make_pair(base + begin, base + last));
+			}
+		}
+		return result;
+	}
+
+	if (offset >= this->rnglists.size) {
+		return result;
+	}
+	const uint8_t *pos = this->rnglists.data + offset;
+	const uint8_t *end = this->rnglists.data + this->rnglists.size;
+	auto address = [this, &unit](uint64_t index) {
+		uint64_t value = 0;
+		this->getAddress(unit, index, value);
+		return value;
+	};
+	try {
+		while (pos < end) {
+			uint64_t begin, last;
+			switch (this->read(pos, end, 1)) {
+			case DW_RLE_end_of_list:
+				return result;
+			case DW_RLE_base_addressx:
+				base = address(readULEB(pos, end));
+				continue;
+			case DW_RLE_base_address:
+				base = this->read(pos, end, size);
+				continue;
+			case DW_RLE_startx_endx:
+				begin = address(readULEB(pos, end));
+				last  = address(readULEB(pos, end));
+				break;
+			case DW_RLE_startx_length:
+				begin = address(readULEB(pos, end));
+				last  = begin + readULEB(pos, end);
+				break;
+			case DW_RLE_offset_pair:
+				begin = base + readULEB(pos, end);
+				last  = base + readULEB(pos, end);
+				break;
+			case DW_RLE_start_end:
+				begin = this->read(pos, end, size);
+				last  = this->read(pos, end, size);
+				break;
+			case DW_RLE_start_length:
+				begin = this->read(pos, end, size);
+				last  = begin + readULEB(pos, end);
+				break;
+			default:
+				return result;
+			}
+			if (last > begin) {
+				result.push_back(std::make_pair(begin, last));
+			}
+		}
+	} catch (DwarfException &) {
+		// a truncated list ends with the ranges read so far
+	}
+	return result;
+}
@@ -0,0 +1,241 @@
+#ifndef _DWARFDECODER_H_
+#define _DWARFDECODER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <libelf.h>
+
+/**
+ * Decoder of .debug_info for the subset of DWARF 2 to 5 that the symbol
+ * classes use, reading the mmapped sections directly instead of going
+ * through libdwarf.
+ *
+ * The unit headers and all abbreviation tables are decoded when the file
+ * is opened, afterwards the decoder is read only and may be shared by
+ * several threads. Relocatable objects, compressed sections and unknown
+ * forms are not supported, isValid() is false for them and the caller
+ * has to use libdwarf instead.
+ *
+ * The split units of a .dwo file or .dwp package are read with a decoder
+ * of the file with their skeleton units, it provides the addresses.
+ */
+class DwarfDecoder {
+public:
+	/**
+	 * Attribute specification of an abbreviation.
+	 */
+	struct AttributeSpec {
+		uint16_t attr;
+		uint16_t form;
+		int64_t implicitConst;  ///< Value of DW_FORM_implicit_const.
+	};
+
+	/**
+	 * One step of skipping the values of an abbreviation whose size
+	 * varies: fixedSize bytes, then lebCount LEB128 values, then the value
+	 * of attributes[attribute] unless attribute is -1.
+	 */
+	struct SkipStep {
+		uint32_t fixedSize;
+		uint32_t lebCount;
+		int32_t attribute;
+	};
+
+	struct Abbrev {
+		uint16_t tag;       ///< 0 for an unused code.
+		bool hasChildren;
+		int64_t fixedSize;  ///< Size of all attribute values, -1 if it varies.
+		std::vector<AttributeSpec> attributes;
+		std::vector<SkipStep> skipSteps;  ///< Empty unless fixedSize is -1.
+	};
+
+	struct Unit {
+		uint64_t offset;          ///< Offset of the unit header.
+		uint64_t end;             ///< Offset of the next unit.
+		uint64_t dieOffset;       ///< Offset of the unit DIE.
+		uint16_t version;
+		uint8_t addressSize;
+		uint8_t offsetSize;       ///< 4, or 8 for 64-bit DWARF.
+		const std::vector<Abbrev> *abbrevs;  ///< Indexed by code.
+		uint64_t baseAddress;     ///< DW_AT_low_pc of the unit DIE.
+		uint64_t strOffsetsBase;  ///< DW_AT_str_offsets_base
+		uint64_t addrBase;        ///< DW_AT_addr_base
+		uint64_t rnglistsBase;    ///< DW_AT_rnglists_base
+		uint64_t rangesBase;      ///< DW_AT_GNU_ranges_base of a skeleton.
+		uint64_t dwoID;           ///< Of a skeleton or split unit.
+		const char *dwoName;      ///< .dwo file of a skeleton, else nullptr.
+		const char *compDir;      ///< DW_AT_comp_dir
+		const Unit *skeleton;     ///< Skeleton of a split unit.
+	};
+
+	/**
+	 * A debugging information entry, abbrev is nullptr for the null entry
+	 * that ends a list of siblings.
+	 */
+	struct Die {
+		const Unit *unit;
+		const Abbrev *abbrev;
+		uint64_t offset;
+		const uint8_t *values;  ///< Start of the attribute values.
+		const uint8_t *end;     ///< End of the values, nullptr until known.
+		uint64_t sibling;       ///< DW_AT_sibling, 0 if unknown.
+	};
+
+	/**
+	 * A decoded attribute value. References are resolved to .debug_info
+	 * offsets, indexed strings, addresses and range lists to their
+	 * values. data points to the contents of blocks and to strings, it is
+	 * nullptr for a string in a supplementary file.
+	 */
+	struct Attribute {
+		uint16_t attr;
+		uint16_t form;        ///< Never DW_FORM_indirect.
+		uint64_t value;       ///< Constant, flag, address, offset or block size.
+		const uint8_t *data;
+	};
+
+	/**
+	 * Open the sections of the ELF file fd, the fd is not closed. If
+	 * skeleton is set fd is a .dwo file or .dwp package with the split
+	 * units of its skeleton units.
+	 */
+	DwarfDecoder(int fd,
+	             std::shared_ptr<const DwarfDecoder> skeleton=nullptr);
+	virtual ~DwarfDecoder();
+
+	DwarfDecoder(const DwarfDecoder &other) = delete;
+	DwarfDecoder &operator =(const DwarfDecoder &other) = delete;
+
+	/**
+	 * Check if the ELF file fd has skeleton units of split DWARF. Only the
+	 * unit headers and the abbreviations of the unit DIEs are read, not
+	 * the whole file as by the constructor.
+	 */
+	static bool hasSkeletonUnits(int fd);
+
+	/**
+	 * @return true if the whole file can be decoded.
+	 */
+	bool isValid() const;
+
+	/**
+	 * @return All units of .debug_info, sorted by offset.
+	 */
+	const std::vector<Unit> &getUnits() const;
+
+	/**
+	 * @return The unit containing offset, nullptr if there is none.
+	 */
+	const Unit *findUnit(uint64_t offset) const;
+
+	/**
+	 * @return The skeleton unit with the id dwoID, nullptr if there is none.
+	 */
+	const Unit *findSkeletonUnit(uint64_t dwoID) const;
+
+	/**
+	 * Read entry index of the address table of unit.
+	 * @return false if there is no such entry.
+	 */
+	bool getAddress(const Unit &unit, uint64_t index, uint64_t &address) const;
+
+	/**
+	 * Read the abbreviation of the entry at offset of unit.
+	 * @return false at the end of the unit.
+	 */
+	bool getDie(const Unit &unit, uint64_t offset, Die &die) const;
+
+	/**
+	 * Decode all attributes of die into attributes.
+	 */
+	void getAttributes(Die &die, std::vector<Attribute> &attributes) const;
+
+	/**
+	 * @return Offset of the entry after die, its first child if it has
+	 * children.
+	 */
+	uint64_t getNextOffset(Die &die) const;
+
+	/**
+	 * @return Offset of the entry after die and all of its children.
+	 */
+	uint64_t getSiblingOffset(Die &die) const;
+
+	/**
+	 * @return The [begin, end) address ranges of the DW_AT_ranges offset of
+	 * a DIE of unit, from .debug_ranges or .debug_rnglists.
+	 */
+	std::vector<std::pair<uint64_t, uint64_t>> getRanges(const Unit &unit,
+	                                                     uint64_t offset) const;
+
+private:
+	struct Section {
+		const uint8_t *data;
+		size_t size;
+	};
+
+	/**
+	 * Abbreviation tables by .debug_abbrev offset and the address size,
+	 * offset size and version the fixed sizes were computed for.
+	 */
+	typedef std::tuple<uint64_t, uint8_t, uint8_t, uint16_t> AbbrevKey;
+
+	/**
+	 * Contributions of a unit of a package to the other sections.
+	 */
+	struct Contribution {
+		uint64_t abbrev;
+		uint64_t strOffsets;
+		uint64_t rnglists;
+	};
+
+	DwarfDecoder();
+	bool openElf(int fd, bool split);
+	bool getSection(const std::string &name, Section &section,
+	                bool required=false);
+	bool readUnits();
+	bool readUnitHeader(const uint8_t *&pos, Unit &unit,
+	                    uint64_t &abbrevOffset) const;
+	bool isSkeletonAbbrev(uint64_t abbrevOffset, uint64_t code) const;
+	bool readPackageIndex(std::map<uint64_t, Contribution> &contributions);
+	const std::vector<Abbrev> *readAbbrevs(const Unit &unit,
+	                                       uint64_t abbrevOffset);
+	void makeSkipSteps(const Unit &unit, Abbrev &abbrev);
+	void readUnitAttributes(Unit &unit);
+
+	uint64_t read(const uint8_t *&pos, const uint8_t *end, unsigned size) const;
+	const uint8_t *readForm(const Unit &unit, const AttributeSpec &spec,
+	                        const uint8_t *pos, const uint8_t *end,
+	                        Attribute *attribute) const;
+	void resolve(const Unit &unit, Attribute &attribute) const;
+	bool readIndex(const Section &section, uint64_t base, uint64_t index,
+	               unsigned size, uint64_t &value) const;
+	const uint8_t *skipValues(Die &die) const;
+
+	Elf *elf;
+	bool bigEndian;
+	bool valid;
+
+	Section info;
+	Section abbrev;
+	Section str;
+	Section lineStr;
+	Section strOffsets;
+	Section addr;
+	Section ranges;
+	Section rnglists;
+
+	std::map<AbbrevKey, std::vector<Abbrev>> abbrevTables;
+	std::vector<Unit> units;
+	std::map<uint64_t, size_t> skeletonUnits;  ///< units index by dwo id
+	std::shared_ptr<const DwarfDecoder> skeleton;
+};
+
+#endif /* _DWARFDECODER_H_ */
@@ -1,16 +1,25 @@
 #include "dwarfparser.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <condition_variable>
 #include <cstring>
+#include <exception>
 #include <fcntl.h>
 #include <fstream>
 #include <iostream>
-#include <typeinfo>
+#include <memory>
+#include <thread>
 #include <unistd.h>
 
+#include "acceleratortable.h"
+#include "debugfile.h"
 #include "dwarfexception.h"
 #include "helpers.h"
+#include "leb128.h"
 #include "libdwarfparser.h"
+#include "symboldatabase.h"
 #include "symbolmanager.h"
 
 
@@ -44,13 +53,13 @@ DwarfParser::DwarfParser(int fd, SymbolManager *manager)
 	errhand(),
 	errarg(),
 	curCUOffset(0),
+	curCUBaseAddress(0),
 	nextCUOffset(0),
-	manager{manager} {
+	manager{manager},
+	loadDepth(0),
+	typeNodeIndex(0) {
 
-	static uint32_t nextFileID = 0;
-	static std::mutex nextFileMutex;
-	std::lock_guard<std::mutex> lock(nextFileMutex);
-	this->fileID = ++nextFileID;
+	this->fileID = DwarfParser::newFileID();
 
 	//std::cout << "Loaded parser with id: " << fileID << std::endl;
 	res = dwarf_init(this->fd, DW_DLC_READ, errhand, errarg, &dbg, &error);
@@ -59,6 +68,29 @@ DwarfParser::DwarfParser(int fd, SymbolManager *manager)
 	}
 }
 
+DwarfParser::DwarfParser(int fd, SymbolManager *manager, uint32_t fileID)
+	:
+	dbg(),
+	fd(fd),
+	is_fd_owner(true),
+	res(DW_DLV_ERROR),
+	fileID(fileID),
+	error(),
+	errhand(),
+	errarg(),
+	curCUOffset(0),
+	curCUBaseAddress(0),
+	nextCUOffset(0),
+	manager{manager},
+	loadDepth(0),
+	typeNodeIndex(0) {
+
+	res = dwarf_init(this->fd, DW_DLC_READ, errhand, errarg, &dbg, &error);
+	if (res != DW_DLV_OK) {
+		throw DwarfException(dwarf_errmsg(error));
+	}
+}
+
 DwarfParser::~DwarfParser(){
 	// Done reading DWARF symbols
 	res = dwarf_finish(dbg,&error);
@@ -72,22 +104,551 @@ DwarfParser::~DwarfParser(){
 }
 
 void DwarfParser::parseDwarfFromFilename(const std::string &filename,
-                                         SymbolManager *mgr) {
-	int fd = open(filename.c_str(), O_RDONLY);
-	DwarfParser::parseDwarfFromFD(fd, mgr);
+                                         SymbolManager *mgr,
+                                         unsigned int threads,
+                                         bool native) {
+	int fd = open(DebugFile::find(filename).c_str(), O_RDONLY);
+	if (fd < 0) {
+		throw DwarfException("Unable to open binary");
+	}
+	DwarfParser::parseFile(fd, filename, mgr, threads, native);
+}
+
+void DwarfParser::parseDwarfFromFD(int fd, SymbolManager *mgr,
+                                   unsigned int threads,
+                                   bool native) {
+	DwarfParser::parseFile(fd, std::string(), mgr, threads, native);
 }
 
-void DwarfParser::parseDwarfFromFD(int fd, SymbolManager *mgr) {
+/**
+ * Parse the file fd and the split units of its skeleton units. filename
+ * is the name of the binary, used to find the .dwo files and the package.
+ */
+void DwarfParser::parseFile(int fd, const std::string &filename,
+                            SymbolManager *mgr, unsigned int threads,
+                            bool native) {
+	if (threads == 0) {
+		threads = std::max(1u, std::thread::hardware_concurrency());
+	}
+
 	// will close the fd when destructed.
 	DwarfParser parser{fd, mgr};
-	parser.read_cu_list();
+	std::shared_ptr<const DwarfDecoder> decoder =
+		DwarfParser::getDecoder(fd, native);
+	if (native) {
+		parser.decoder = decoder;
+	}
+
+	std::vector<ParallelFile> files =
+		DwarfParser::getSplitFiles(filename, decoder, mgr);
+	if (!files.empty()) {
+		files.insert(files.begin(), ParallelFile{
+			std::string(), fd, parser.fileID, false, parser.decoder, nullptr,
+			parser.getCUOffsets()});
+		DwarfParser::read_files_parallel(files, mgr, threads);
+	} else if (threads == 1) {
+		parser.read_cu_list();
+	} else {
+		parser.read_cu_list_parallel(threads);
+	}
+}
+
+/**
+ * Files the decoder does not support are read with libdwarf, but the
+ * skeleton units are only known to the decoder. Without native it is
+ * only created if fd has skeleton units.
+ * @return The decoder of fd, nullptr if it is not needed or cannot
+ * decode fd.
+ */
+std::shared_ptr<const DwarfDecoder> DwarfParser::getDecoder(int fd,
+                                                            bool native) {
+	if (!native && !DwarfDecoder::hasSkeletonUnits(fd)) {
+		return nullptr;
+	}
+	std::shared_ptr<const DwarfDecoder> decoder =
+		std::make_shared<DwarfDecoder>(fd);
+	if (!decoder->isValid()) {
+		decoder.reset();
+	}
+	return decoder;
+}
+
+/**
+ * @return The .dwo files or the package with the split units of the
+ * skeleton units of decoder. Missing files are skipped with a warning
+ * of mgr.
+ */
+std::vector<DwarfParser::ParallelFile> DwarfParser::getSplitFiles(
+		const std::string &filename,
+		const std::shared_ptr<const DwarfDecoder> &decoder,
+		SymbolManager *mgr) {
+	std::vector<ParallelFile> files;
+	if (!decoder) {
+		return files;
+	}
+
+	std::vector<std::string> splitFilenames;
+	std::string package = DebugFile::findPackage(filename);
+	for (auto &unit : decoder->getUnits()) {
+		if (!unit.dwoName || !package.empty()) {
+			continue;
+		}
+		std::string splitFilename =
+			DebugFile::findSplitFile(filename, unit.dwoName, unit.compDir);
+		if (splitFilename.empty()) {
+			mgr->addWarning(std::string("Split DWARF file ") + unit.dwoName +
+			                " not found");
+		} else if (std::find(splitFilenames.begin(), splitFilenames.end(),
+		                     splitFilename) == splitFilenames.end()) {
+			splitFilenames.push_back(splitFilename);
+		}
+	}
+	if (!package.empty()) {
+		bool split = std::any_of(
+			decoder->getUnits().begin(), decoder->getUnits().end(),
+			[](const DwarfDecoder::Unit &unit) { return unit.dwoName; });
+		if (split) {
+			splitFilenames.push_back(package);
+		}
+	}
+
+	// only the unit offsets are read here, the workers open the files again
+	for (auto &splitFilename : splitFilenames) {
+		int fd = open(splitFilename.c_str(), O_RDONLY);
+		if (fd < 0) {
+			mgr->addWarning("Unable to open split DWARF file " + splitFilename);
+			continue;
+		}
+		DwarfDecoder split{fd, decoder};
+		close(fd);
+		if (!split.isValid()) {
+			mgr->addWarning("Unable to decode split DWARF file " +
+			                splitFilename);
+			continue;
+		}
+		std::vector<uint64_t> offsets{0};
+		for (auto &unit : split.getUnits()) {
+			offsets.push_back(unit.end);
+		}
+		files.push_back(ParallelFile{splitFilename, -1,
+		                             DwarfParser::newFileID(), false, nullptr,
+		                             decoder, offsets});
+	}
+	return files;
+}
+
+void DwarfParser::parseDwarfFromFilenames(
+		const std::vector<std::string> &filenames, SymbolManager *mgr,
+		unsigned int threads, bool native) {
+	if (threads == 0) {
+		threads = std::max(1u, std::thread::hardware_concurrency());
+	}
+	if (threads == 1) {
+		for (auto &filename : filenames) {
+			DwarfParser::parseDwarfFromFilename(filename, mgr, 1, native);
+		}
+		return;
+	}
+
+	// the unit offsets of the files are read by as many workers as parse
+	// them afterwards, so there are never more files open than workers.
+	// The file ids are handed out in the order of filenames.
+	std::vector<uint32_t> fileIDs;
+	for (size_t i = 0; i < filenames.size(); i++) {
+		fileIDs.push_back(DwarfParser::newFileID());
+	}
+	std::vector<std::vector<ParallelFile>> fileLists(filenames.size());
+	std::atomic<size_t> nextFile{0};
+	std::mutex failureMutex;
+	std::exception_ptr failure;
+
+	auto worker = [&]() {
+		size_t i;
+		while ((i = nextFile++) < filenames.size()) {
+			try {
+				fileLists[i] = DwarfParser::getParallelFiles(
+					filenames[i], mgr, fileIDs[i], native);
+			} catch (...) {
+				std::lock_guard<std::mutex> lock(failureMutex);
+				if (!failure) {
+					failure = std::current_exception();
+				}
+				return;
+			}
+		}
+	};
+	std::vector<std::thread> workers;
+	for (size_t i = 0; i < std::min<size_t>(threads, filenames.size()); i++) {
+		workers.emplace_back(worker);
+	}
+	for (auto &thread : workers) {
+		thread.join();
+	}
+	if (failure) {
+		std::rethrow_exception(failure);
+	}
+
+	std::vector<ParallelFile> files;
+	for (auto &fileList : fileLists) {
+		files.insert(files.end(), fileList.begin(), fileList.end());
+	}
+	DwarfParser::read_files_parallel(files, mgr, threads);
+}
+
+/**
+ * Read the unit offsets of filename, the file is closed again.
+ * @return The file followed by the files of its split units.
+ */
+std::vector<DwarfParser::ParallelFile> DwarfParser::getParallelFiles(
+		const std::string &filename, SymbolManager *mgr, uint32_t fileID,
+		bool native) {
+	std::string debugFilename = DebugFile::find(filename);
+	int fd = open(debugFilename.c_str(), O_RDONLY);
+	if (fd < 0) {
+		throw DwarfException("Unable to open binary");
+	}
+	DwarfParser parser{fd, mgr, fileID};
+	std::shared_ptr<const DwarfDecoder> decoder =
+		DwarfParser::getDecoder(fd, native);
+	if (native) {
+		parser.decoder = decoder;
+	}
+	std::vector<ParallelFile> files{ParallelFile{
+		debugFilename, -1, fileID, native, nullptr, nullptr,
+		parser.getCUOffsets()}};
+	std::vector<ParallelFile> splitFiles =
+		DwarfParser::getSplitFiles(filename, decoder, mgr);
+	files.insert(files.end(), splitFiles.begin(), splitFiles.end());
+	return files;
+}
+
+uint32_t DwarfParser::newFileID() {
+	static uint32_t nextFileID = 0;
+	static std::mutex nextFileMutex;
+	std::lock_guard<std::mutex> lock(nextFileMutex);
+	return ++nextFileID;
+}
+
+void DwarfParser::parseDwarfFromFilenameCached(const std::string &filename,
+                                               const std::string &dbFilename,
+                                               SymbolManager *mgr,
+                                               unsigned int threads,
+                                               bool native) {
+	DatabaseKey key = DatabaseKey::fromFilename(filename);
+	if (mgr->loadDatabase(dbFilename, key)) {
+		return;
+	}
+	DwarfParser::parseDwarfFromFilename(filename, mgr, threads, native);
+	mgr->saveDatabase(dbFilename, key);
+}
+
+void DwarfParser::parseDwarfFromFilenameLazy(const std::string &filename,
+                                             SymbolManager *mgr) {
+	int fd = open(DebugFile::find(filename).c_str(), O_RDONLY);
+	if (fd < 0) {
+		throw DwarfException("Unable to open binary");
+	}
+	std::unique_ptr<DwarfParser> parser{new DwarfParser{fd, mgr}};
+	parser->buildNameIndex();
+	mgr->setLazyParser(std::move(parser));
+}
+
+/**
+ * Use the accelerator tables .debug_names or .gdb_index as name index, or
+ * else the .debug_pubtypes and .debug_pubnames tables.
+ * @return false if the file has none, the DIEs have to be scanned.
+ */
+bool DwarfParser::readNameTables() {
+	std::hash<std::string> hash;
+
+	AcceleratorTable accelerator{this->fd};
+	std::vector<AcceleratorTable::Entry> entries;
+	if (accelerator.read(entries)) {
+		this->nameIndex.reserve(entries.size());
+		for (auto &entry : entries) {
+			this->nameIndex.push_back(
+				NameIndexEntry{hash(entry.name), entry.offset, entry.unit});
+		}
+		return true;
+	}
+
+	Dwarf_Type *types = nullptr;
+	Dwarf_Signed typeCount = 0;
+	Dwarf_Global *globals = nullptr;
+	Dwarf_Signed globalCount = 0;
+
+	if (dwarf_get_pubtypes(dbg, &types, &typeCount, &error) != DW_DLV_OK) {
+		return false;
+	}
+	if (dwarf_get_globals(dbg, &globals, &globalCount, &error) != DW_DLV_OK) {
+		dwarf_pubtypes_dealloc(dbg, types, typeCount);
+		return false;
+	}
+
+	char *name;
+	Dwarf_Off offset;
+	for (Dwarf_Signed i = 0; i < typeCount; i++) {
+		if (dwarf_pubtypename(types[i], &name, &error) == DW_DLV_OK) {
+			if (dwarf_pubtype_type_die_offset(types[i], &offset, &error) == DW_DLV_OK) {
+				this->nameIndex.push_back(NameIndexEntry{hash(name), offset, false});
+			}
+			dwarf_dealloc(dbg, name, DW_DLA_STRING);
+		}
+	}
+	for (Dwarf_Signed i = 0; i < globalCount; i++) {
+		if (dwarf_globname(globals[i], &name, &error) == DW_DLV_OK) {
+			if (dwarf_global_die_offset(globals[i], &offset, &error) == DW_DLV_OK) {
+				this->nameIndex.push_back(NameIndexEntry{hash(name), offset, false});
+			}
+			dwarf_dealloc(dbg, name, DW_DLA_STRING);
+		}
+	}
+	dwarf_pubtypes_dealloc(dbg, types, typeCount);
+	dwarf_globals_dealloc(dbg, globals, globalCount);
+	return true;
+}
+
+/**
+ * Collect the compilation units and index the names of the top level
+ * DIEs. Only the name of every DIE is read, no symbols are created.
+ */
+void DwarfParser::buildNameIndex() {
+	Dwarf_Unsigned cu_header_length = 0;
+	Dwarf_Half version_stamp        = 0;
+	Dwarf_Unsigned abbrev_offset    = 0;
+	Dwarf_Half address_size         = 0;
+	Dwarf_Unsigned next_cu_header   = 0;
+
+	bool scan = !this->readNameTables();
+	std::hash<std::string> hash;
+	uint64_t offset = 0;
+
+	while (true) {
+		res = dwarf_next_cu_header(dbg, &cu_header_length, &version_stamp,
+		                           &abbrev_offset, &address_size,
+		                           &next_cu_header, &error);
+		if (res == DW_DLV_ERROR) {
+			throw DwarfException("Error in dwarf_next_cu_header");
+		}
+		if (res == DW_DLV_NO_ENTRY) {
+			break;
+		}
+
+		Dwarf_Die cu_die = 0;
+		if (dwarf_siblingof(dbg, 0, &cu_die, &error) != DW_DLV_OK) {
+			throw DwarfException("Error in dwarf_siblingof on CU die");
+		}
+		Dwarf_Addr base;
+		Unit unit = {offset, this->getDieOffset(cu_die),
+		             (dwarf_lowpc(cu_die, &base, &error) == DW_DLV_OK) ? base : 0};
+		this->units.push_back(unit);
+		offset = next_cu_header;
+
+		Dwarf_Die die = 0;
+		if (scan && dwarf_child(cu_die, &die, &error) == DW_DLV_OK) {
+			while (true) {
+				char *name = nullptr;
+				if (dwarf_diename(die, &name, &error) == DW_DLV_OK) {
+					this->nameIndex.push_back(
+						NameIndexEntry{hash(name), this->getDieOffset(die), false});
+					dwarf_dealloc(dbg, name, DW_DLA_STRING);
+				}
+				Dwarf_Die sib_die = 0;
+				res = dwarf_siblingof(dbg, die, &sib_die, &error);
+				dwarf_dealloc(dbg, die, DW_DLA_DIE);
+				if (res != DW_DLV_OK) {
+					break;
+				}
+				die = sib_die;
+			}
+		}
+		dwarf_dealloc(dbg, cu_die, DW_DLA_DIE);
+	}
+
+	std::sort(this->nameIndex.begin(), this->nameIndex.end(),
+	          [](const NameIndexEntry &a, const NameIndexEntry &b) {
+		return a.hash < b.hash || (a.hash == b.hash && a.offset < b.offset);
+	});
+}
+
+bool DwarfParser::loadName(const std::string &name) {
+	// lookups of the parser itself only see the symbols loaded so far
+	if (this->loadDepth || !this->loadedNames.insert(name).second) {
+		return false;
+	}
+
+	uint64_t hash = std::hash<std::string>{}(name);
+	auto entry = std::lower_bound(
+		this->nameIndex.begin(), this->nameIndex.end(), hash,
+		[](const NameIndexEntry &entry, uint64_t hash) {
+			return entry.hash < hash;
+		});
+
+	std::vector<uint64_t> offsets;
+	for (; entry != this->nameIndex.end() && entry->hash == hash; entry++) {
+		if (entry->unit) {
+			this->findUnitDies(entry->offset, name, offsets);
+		} else {
+			offsets.push_back(entry->offset);
+		}
+	}
+
+	bool loaded = false;
+	std::unordered_set<Dwarf_Half> tags;
+	for (auto &offset : offsets) {
+		Dwarf_Die die = 0;
+		Dwarf_Half tag = 0;
+		if (dwarf_offdie(dbg, offset, &die, &error) != DW_DLV_OK) {
+			continue;
+		}
+		if (dwarf_tag(die, &tag, &error) == DW_DLV_OK &&
+		    tags.find(tag) == tags.end() && this->getDieName(die) == name &&
+		    this->loadDie(die, offset)) {
+			// a declaration does not end the search for the definition
+			if (!this->isDieDeclaration(die)) {
+				tags.insert(tag);
+			}
+			loaded = true;
+		}
+		dwarf_dealloc(dbg, die, DW_DLA_DIE);
+	}
+	return loaded;
+}
+
+/**
+ * Append the offsets of the top level DIEs named name in the unit with
+ * header offset offset.
+ */
+void DwarfParser::findUnitDies(uint64_t offset, const std::string &name,
+                               std::vector<uint64_t> &offsets) {
+	auto unit = std::lower_bound(
+		this->units.begin(), this->units.end(), offset,
+		[](const Unit &unit, uint64_t offset) {
+			return unit.offset < offset;
+		});
+	Dwarf_Die cu_die = 0;
+	if (unit == this->units.end() || unit->offset != offset ||
+	    dwarf_offdie(dbg, unit->dieOffset, &cu_die, &error) != DW_DLV_OK) {
+		return;
+	}
+
+	Dwarf_Die die = 0;
+	if (dwarf_child(cu_die, &die, &error) == DW_DLV_OK) {
+		while (true) {
+			char *dieName = nullptr;
+			if (dwarf_diename(die, &dieName, &error) == DW_DLV_OK) {
+				if (name == dieName) {
+					offsets.push_back(this->getDieOffset(die));
+				}
+				dwarf_dealloc(dbg, dieName, DW_DLA_STRING);
+			}
+			Dwarf_Die sib_die = 0;
+			res = dwarf_siblingof(dbg, die, &sib_die, &error);
+			dwarf_dealloc(dbg, die, DW_DLA_DIE);
+			if (res != DW_DLV_OK) {
+				break;
+			}
+			die = sib_die;
+		}
+	}
+	dwarf_dealloc(dbg, cu_die, DW_DLA_DIE);
+}
+
+bool DwarfParser::loadDie(uint64_t offset) {
+	Dwarf_Die die = 0;
+	if (dwarf_offdie(dbg, offset, &die, &error) != DW_DLV_OK) {
+		return false;
+	}
+	Symbol *sym = nullptr;
+	try {
+		sym = this->loadDie(die, offset);
+	} catch (...) {
+		dwarf_dealloc(dbg, die, DW_DLA_DIE);
+		throw;
+	}
+	dwarf_dealloc(dbg, die, DW_DLA_DIE);
+	return sym != nullptr;
+}
+
+Symbol *DwarfParser::loadDie(const Dwarf_Die &die, uint64_t offset) {
+	if (!this->loadedDies.insert(offset).second) {
+		return nullptr;
+	}
+	auto unit = std::upper_bound(
+		this->units.begin(), this->units.end(), offset,
+		[](uint64_t offset, const Unit &unit) {
+			return offset < unit.offset;
+		});
+	if (unit == this->units.begin()) {
+		return nullptr;
+	}
+	unit--;
+
+	// loading may recurse into a DIE of another unit
+	uint64_t oldCUOffset = this->curCUOffset;
+	uint64_t oldCUBaseAddress = this->curCUBaseAddress;
+	this->curCUOffset = unit->offset;
+	this->curCUBaseAddress = unit->baseAddress;
+	this->loadDepth++;
+
+	Symbol *sym = nullptr;
+	try {
+		Srcfilesdata sf;
+		sym = this->initSymbolFromDie(this->getDieInfo(die), nullptr, 1, sf);
+
+		// a DIE merged into a loaded symbol would add duplicate members
+		Dwarf_Die child = 0;
+		if (dwarf_child(die, &child, &error) == DW_DLV_OK) {
+			this->get_die_and_siblings(child, sym, 2, sf,
+			                           this->isMergedType(sym, offset));
+			dwarf_dealloc(dbg, child, DW_DLA_DIE);
+		}
+	} catch (...) {
+		this->loadDepth--;
+		this->curCUOffset = oldCUOffset;
+		this->curCUBaseAddress = oldCUBaseAddress;
+		throw;
+	}
+
+	this->loadDepth--;
+	this->curCUOffset = oldCUOffset;
+	this->curCUBaseAddress = oldCUBaseAddress;
+	return sym;
+}
+
+void DwarfParser::loadAll() {
+	for (auto &unit : this->units) {
+		Dwarf_Die cu_die = 0;
+		if (dwarf_offdie(dbg, unit.dieOffset, &cu_die, &error) != DW_DLV_OK) {
+			continue;
+		}
+		std::vector<uint64_t> offsets;
+		Dwarf_Die die = 0;
+		if (dwarf_child(cu_die, &die, &error) == DW_DLV_OK) {
+			while (true) {
+				offsets.push_back(this->getDieOffset(die));
+				Dwarf_Die sib_die = 0;
+				res = dwarf_siblingof(dbg, die, &sib_die, &error);
+				dwarf_dealloc(dbg, die, DW_DLA_DIE);
+				if (res != DW_DLV_OK) {
+					break;
+				}
+				die = sib_die;
+			}
+		}
+		dwarf_dealloc(dbg, cu_die, DW_DLA_DIE);
+
+		for (auto &offset : offsets) {
+			this->loadDie(offset);
+		}
+	}
 }
 
 uint32_t DwarfParser::getFileID() {
 	return this->fileID;
 }
 
-void DwarfParser::read_cu_list() {
+std::vector<uint64_t> DwarfParser::getCUOffsets() {
 	Dwarf_Unsigned cu_header_length = 0;
 	Dwarf_Half version_stamp        = 0;
 	Dwarf_Unsigned abbrev_offset    = 0;
@@ -95,7 +656,63 @@ void DwarfParser::read_cu_list() {
 	Dwarf_Unsigned next_cu_header   = 0;
 	Dwarf_Error error;
 
+	std::vector<uint64_t> offsets;
+	offsets.push_back(0);
+
+	if (this->decoder) {
+		for (auto &unit : this->decoder->getUnits()) {
+			offsets.push_back(unit.end);
+		}
+		return offsets;
+	}
+
 	while (true) {
+		res = dwarf_next_cu_header(
+			dbg,
+			&cu_header_length,
+			&version_stamp,
+			&abbrev_offset,
+			&address_size,
+			&next_cu_header,
+			&error
+		);
+
+		if (res == DW_DLV_ERROR) {
+			printf("Error in dwarf_next_cu_header\n");
+			exit(1);
+		}
+
+		if (res == DW_DLV_NO_ENTRY) {
+			/* Done. */
+			break;
+		}
+		offsets.push_back(next_cu_header);
+	}
+	return offsets;
+}
+
+void DwarfParser::read_cu_list() {
+	this->read_cu_range(0, UINT64_MAX);
+}
+
+/**
+ * Parse the compilation units with a header offset in [begin, end).
+ * Consecutive calls on the same parser need to move forward through the file.
+ */
+void DwarfParser::read_cu_range(uint64_t begin, uint64_t end) {
+	if (this->decoder) {
+		this->read_units_native(begin, end);
+		return;
+	}
+
+	Dwarf_Unsigned cu_header_length = 0;
+	Dwarf_Half version_stamp        = 0;
+	Dwarf_Unsigned abbrev_offset    = 0;
+	Dwarf_Half address_size         = 0;
+	Dwarf_Unsigned next_cu_header   = 0;
+	Dwarf_Error error;
+
+	while (this->nextCUOffset < end) {
 		this->curCUOffset = this->nextCUOffset;
 		Srcfilesdata sf;
 		Dwarf_Die no_die = 0;
@@ -123,6 +740,10 @@ void DwarfParser::read_cu_list() {
 		}
 
 		this->nextCUOffset = next_cu_header;
+		if (this->curCUOffset < begin) {
+			// belongs to another worker
+			continue;
+		}
 		//std::cout << std::hex <<
 		//"cu_header_length " <<  cu_header_length <<
 		//"\n version_stamp " << version_stamp <<
@@ -142,33 +763,203 @@ void DwarfParser::read_cu_list() {
 			printf("no entry! in dwarf_siblingof on CU die \n");
 			exit(1);
 		}
+		Dwarf_Addr base;
+		this->curCUBaseAddress =
+			(dwarf_lowpc(cu_die, &base, &error) == DW_DLV_OK) ? base : 0;
+		this->typeHashes.clear();
 		this->get_die_and_siblings(cu_die, nullptr, 0, sf);
 		dwarf_dealloc(dbg, cu_die, DW_DLA_DIE);
 	}
 }
 
+/**
+ * Parse the compilation units with a pool of worker threads, see
+ * read_files_parallel().
+ */
+void DwarfParser::read_cu_list_parallel(unsigned int threads) {
+	std::vector<ParallelFile> files{ParallelFile{
+		std::string(), this->fd, this->fileID, false, this->decoder, nullptr,
+		this->getCUOffsets()}};
+	DwarfParser::read_files_parallel(files, this->manager, threads);
+}
+
+/**
+ * Parse the compilation units of files with a pool of worker threads.
+ *
+ * The units of every file are split into contiguous chunks that are
+ * handed out in file order. Every chunk is parsed into its own staging
+ * SymbolManager by a worker with its own Dwarf_Debug for the file of the
+ * chunk. The chunks are merged into manager in file order, so the result
+ * matches a serial parse of the files one after another.
+ */
+void DwarfParser::read_files_parallel(const std::vector<ParallelFile> &files,
+                                      SymbolManager *manager,
+                                      unsigned int threads) {
+	struct Chunk {
+		size_t file;
+		uint64_t begin;
+		uint64_t end;
+	};
+
+	// several chunks per thread to even out differently sized units
+	uint64_t totalSize = 0;
+	for (auto &file : files) {
+		totalSize += file.offsets.back();
+	}
+	uint64_t chunkSize = totalSize / (threads * 8) + 1;
+	std::vector<Chunk> chunks;
+	for (size_t f = 0; f < files.size(); f++) {
+		const std::vector<uint64_t> &offsets = files[f].offsets;
+		uint64_t chunkStart = 0;
+		for (size_t i = 1; i < offsets.size(); i++) {
+			if (offsets[i] - chunkStart >= chunkSize || i == offsets.size() - 1) {
+				chunks.push_back(Chunk{f, chunkStart, offsets[i]});
+				chunkStart = offsets[i];
+			}
+		}
+	}
+	threads = std::min<size_t>(threads, chunks.size());
+
+	std::vector<std::unique_ptr<SymbolManager>> staging(chunks.size());
+	std::vector<bool> done(chunks.size(), false);
+	std::atomic<size_t> nextChunk{0};
+	std::mutex doneMutex;
+	std::condition_variable doneCond;
+	std::exception_ptr failure;
+
+	auto worker = [&]() {
+		try {
+			// parser of the file of the last chunk
+			std::unique_ptr<DwarfParser> parser;
+			size_t parserFile = files.size();
+			size_t i;
+			while ((i = nextChunk++) < chunks.size()) {
+				{
+					std::lock_guard<std::mutex> lock(doneMutex);
+					if (failure) {
+						return;
+					}
+				}
+				const ParallelFile &file = files[chunks[i].file];
+				if (chunks[i].file != parserFile) {
+					parser.reset();
+					int fd = (file.fd >= 0) ? dup(file.fd) :
+					         open(file.filename.c_str(), O_RDONLY);
+					if (fd < 0) {
+						throw DwarfException("Unable to open binary");
+					}
+					parser.reset(new DwarfParser{fd, manager, file.fileID});
+					parser->decoder = file.decoder;
+					if (!parser->decoder && (file.native || file.skeleton)) {
+						std::shared_ptr<const DwarfDecoder> decoder =
+							std::make_shared<DwarfDecoder>(fd, file.skeleton);
+						if (decoder->isValid()) {
+							parser->decoder = decoder;
+						} else if (file.skeleton) {
+							throw DwarfException("Unable to decode split DWARF file");
+						}
+					}
+					parserFile = chunks[i].file;
+				}
+				staging[i].reset(new SymbolManager(manager));
+				parser->manager = staging[i].get();
+				parser->read_cu_range(chunks[i].begin, chunks[i].end);
+
+				std::lock_guard<std::mutex> lock(doneMutex);
+				done[i] = true;
+				doneCond.notify_all();
+			}
+		} catch (...) {
+			std::lock_guard<std::mutex> lock(doneMutex);
+			if (!failure) {
+				failure = std::current_exception();
+			}
+			doneCond.notify_all();
+		}
+	};
+
+	std::vector<std::thread> workers;
+	for (unsigned int i = 0; i < threads; i++) {
+		workers.emplace_back(worker);
+	}
+
+	for (size_t i = 0; i < chunks.size(); i++) {
+		{
+			std::unique_lock<std::mutex> lock(doneMutex);
+			doneCond.wait(lock, [&]() { return done[i] || failure; });
+			if (!done[i]) {
+				break;
+			}
+		}
+		manager->merge(staging[i].get());
+		staging[i].reset();
+	}
+
+	for (auto &thread : workers) {
+		thread.join();
+	}
+	if (failure) {
+		std::rethrow_exception(failure);
+	}
+}
+
+/**
+ * @return true for the children that make up the layout of a type. A type
+ * that is merged into an existing one does not add them again.
+ */
+static bool isLayoutChild(Dwarf_Half tag) {
+	switch (tag) {
+	case DW_TAG_member:
+	case DW_TAG_enumerator:
+	case DW_TAG_subrange_type:
+	case DW_TAG_formal_parameter:
+		return true;
+	default:
+		return false;
+	}
+}
+
 void DwarfParser::get_die_and_siblings(const Dwarf_Die &in_die,
                                        Symbol *parent,
                                        int in_level,
-                                       Srcfilesdata sf) {
+                                       Srcfilesdata sf,
+                                       bool merged) {
 	int res           = DW_DLV_ERROR;
 	Dwarf_Die cur_die = in_die;
 	Dwarf_Die child   = 0;
 	Dwarf_Error error;
 
 	Symbol *cursym = nullptr;
-
-	cursym = this->initSymbolFromDie(in_die, parent, in_level, sf);
+	bool skip      = false;
+	bool curMerged = false;
+
+	// creates the symbol of cur_die, skip is set if its children are
+	// not parsed
+	auto initSymbol = [&]() {
+		Dwarf_Half tag = 0;
+		cursym    = nullptr;
+		curMerged = false;
+		// in lazy mode a DIE may have been loaded on its own before
+		skip = this->isDieLoaded(cur_die) ||
+		       (merged && dwarf_tag(cur_die, &tag, &error) == DW_DLV_OK &&
+		        isLayoutChild(tag));
+		if (!skip) {
+			cursym    = this->initSymbolFromDie(this->getDieInfo(cur_die),
+			                                    parent, in_level, sf);
+			curMerged = this->isMergedType(cursym, this->getDieOffset(cur_die));
+		}
+	};
+	initSymbol();
 
 	for (;;) {
 		Dwarf_Die sib_die = 0;
-		res = dwarf_child(cur_die, &child, &error);
+		res = skip ? DW_DLV_NO_ENTRY : dwarf_child(cur_die, &child, &error);
 		if (res == DW_DLV_ERROR) {
 			printf("Error in dwarf_child , level %d \n", in_level);
 			exit(1);
 		}
 		if (res == DW_DLV_OK) {
-			get_die_and_siblings(child, cursym, in_level + 1, sf);
+			get_die_and_siblings(child, cursym, in_level + 1, sf, curMerged);
 		}
 		/* res == DW_DLV_NO_ENTRY */
 		res = dwarf_siblingof(dbg, cur_die, &sib_die, &error);
@@ -185,11 +976,69 @@ void DwarfParser::get_die_and_siblings(const Dwarf_Die &in_die,
 			dwarf_dealloc(dbg, cur_die, DW_DLA_DIE);
 		}
 		cur_die = sib_die;
-		cursym  = this->initSymbolFromDie(cur_die, parent, in_level, sf);
+		initSymbol();
 	}
 	return;
 }
 
+void DwarfParser::read_units_native(uint64_t begin, uint64_t end) {
+	for (auto &unit : this->decoder->getUnits()) {
+		if (unit.offset < begin || unit.offset >= end) {
+			continue;
+		}
+		Srcfilesdata sf;
+		this->curCUOffset      = unit.offset;
+		this->curCUBaseAddress = unit.baseAddress;
+		this->typeHashes.clear();
+		this->get_die_and_siblings_native(unit, unit.dieOffset, nullptr, 0, sf);
+	}
+}
+
+uint64_t DwarfParser::get_die_and_siblings_native(
+		const DwarfDecoder::Unit &unit, uint64_t offset, Symbol *parent,
+		int level, Srcfilesdata sf, bool merged) {
+	DwarfDecoder::Die die;
+	while (this->decoder->getDie(unit, offset, die)) {
+		if (!die.abbrev) {
+			return this->decoder->getNextOffset(die);
+		}
+		if (merged && isLayoutChild(die.abbrev->tag)) {
+			offset = this->decoder->getSiblingOffset(die);
+			continue;
+		}
+		Symbol *cursym = this->initSymbolFromDie(this->getDieInfo(die), parent,
+		                                         level, sf);
+		if (!die.abbrev->hasChildren) {
+			offset = this->decoder->getNextOffset(die);
+		} else {
+			offset = this->get_die_and_siblings_native(
+				unit, this->decoder->getNextOffset(die), cursym, level + 1, sf,
+				this->isMergedType(cursym, die.offset));
+		}
+	}
+	return offset;
+}
+
+/**
+ * @return true if die was merged into the existing type sym, the layout
+ * children of sym are already known.
+ */
+bool DwarfParser::isMergedType(Symbol *sym, uint64_t offset) {
+	return kind_cast<BaseType>(sym) &&
+	       sym->getID() != this->manager->getID(offset, this->fileID);
+}
+
+/**
+ * Lazy mode: mark die as loaded.
+ * @return true if it was loaded before.
+ */
+bool DwarfParser::isDieLoaded(const Dwarf_Die &die) {
+	if (!this->loadDepth) {
+		return false;
+	}
+	return !this->loadedDies.insert(this->getDieOffset(die)).second;
+}
+
 void DwarfParser::print_die_data(const Dwarf_Die &print_me,
                                  int level,
                                  Srcfilesdata sf) {
@@ -282,97 +1131,530 @@ void DwarfParser::print_die_data(const Dwarf_Die &print_me,
 					break;
 				}
 
-				std::cout << std::endl;
+				std::cout << std::endl;
+			}
+			dwarf_dealloc(dbg, attrbuf[i], DW_DLA_ATTR);
+		}
+		dwarf_dealloc(dbg, attrbuf, DW_DLA_LIST);
+	}
+
+	printf("<%d> tag: %d %s  name: \"%s\"\n", level, tag, tagname, name);
+
+	if (!localname) {
+		dwarf_dealloc(dbg, name, DW_DLA_STRING);
+	}
+}
+
+void DwarfParser::print_die_data(const DieInfo &info,
+                                 int level,
+                                 Srcfilesdata sf) {
+	if (info.die) {
+		this->print_die_data(info.die, level, sf);
+		return;
+	}
+	// decoded natively, only the DieInfo is left
+	const char *tagname = "";
+	dwarf_get_TAG_name(info.tag, &tagname);
+	std::cout << info.name << " @ " << std::hex << info.offset << std::dec
+	          << std::endl;
+	printf("<%d> tag: %d %s  name: \"%s\"\n", level, info.tag, tagname,
+	       info.name.c_str());
+}
+
+template <>
+Function *DwarfParser::getTypeInstance(const DieInfo &info,
+                                       const std::string &dieName) {
+	Function *cursym;
+
+	cursym = this->manager->findBaseTypeByName<Function>(dieName);
+	if (!cursym) {
+		return new (this->manager) Function(this->manager, this, info, dieName);
+	}
+	cursym->update(this, info);
+	cursym->addAlternativeDwarfID(info.offset, fileID);
+	return cursym;
+}
+
+template <>
+Variable *DwarfParser::getTypeInstance(const DieInfo &info,
+                                       const std::string &dieName) {
+	Variable *cursym;
+
+	cursym = this->manager->findVariableByName(dieName);
+	if (!cursym) {
+		return new (this->manager) Variable(this->manager, this, info, dieName);
+	}
+	cursym->update(this, info);
+	cursym->addAlternativeDwarfID(info.offset, fileID);
+	return cursym;
+}
+
+/**
+ * Types are merged with an equal type seen before, in this or another
+ * compilation unit. The children of the duplicate are skipped.
+ */
+template <class T>
+T *DwarfParser::getTypeInstance(const DieInfo &info,
+                                const std::string &dieName) {
+	uint64_t hash = this->getTypeHash(info);
+	BaseType *bt = this->manager->findBaseTypeByHash(hash, dieName);
+	T *cursym = kind_cast<T>(bt);
+	if (!cursym || cursym->getKind() != bt->getKind()) {
+		return new (this->manager) T(this->manager, this, info, dieName);
+	}
+	cursym->addAlternativeDwarfID(info.offset, fileID);
+	return cursym;
+}
+
+static inline void combineHash(uint64_t &hash, uint64_t value) {
+	hash ^= value + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+}
+
+/**
+ * @return true if attr is part of the type hash. DW_AT_decl_file and
+ * DW_AT_decl_line are not, they differ between units.
+ */
+static bool isLayoutAttribute(Dwarf_Half attr) {
+	switch (attr) {
+	case DW_AT_byte_size:
+	case DW_AT_bit_size:
+	case DW_AT_bit_offset:
+	case DW_AT_data_bit_offset:
+	case DW_AT_data_member_location:
+	case DW_AT_encoding:
+	case DW_AT_const_value:
+	case DW_AT_lower_bound:
+	case DW_AT_upper_bound:
+	case DW_AT_count:
+	case DW_AT_type:
+	case DW_AT_declaration:
+		return true;
+	default:
+		return false;
+	}
+}
+
+static bool isStringForm(Dwarf_Half form) {
+	switch (form) {
+	case DW_FORM_string:
+	case DW_FORM_strp:
+	case DW_FORM_line_strp:
+	case DW_FORM_strx:
+	case DW_FORM_strx1:
+	case DW_FORM_strx2:
+	case DW_FORM_strx3:
+	case DW_FORM_strx4:
+	case DW_FORM_GNU_str_index:
+		return true;
+	default:
+		return false;
+	}
+}
+
+static bool isAddressForm(Dwarf_Half form) {
+	switch (form) {
+	case DW_FORM_addr:
+	case DW_FORM_addrx:
+	case DW_FORM_addrx1:
+	case DW_FORM_addrx2:
+	case DW_FORM_addrx3:
+	case DW_FORM_addrx4:
+	case DW_FORM_GNU_addr_index:
+		return true;
+	default:
+		return false;
+	}
+}
+
+/**
+ * @return true for the forms dwarf_formudata() accepts.
+ */
+static bool isUnsignedForm(Dwarf_Half form) {
+	switch (form) {
+	case DW_FORM_data1:
+	case DW_FORM_data2:
+	case DW_FORM_data4:
+	case DW_FORM_data8:
+	case DW_FORM_udata:
+		return true;
+	default:
+		return false;
+	}
+}
+
+/**
+ * @return true if attribute is a location expression of a single
+ * DW_OP_addrx, the form split units use for the address of a variable.
+ */
+static bool isIndexedAddress(const DwarfDecoder::Attribute &attribute) {
+	switch (attribute.form) {
+	case DW_FORM_block1:
+	case DW_FORM_block2:
+	case DW_FORM_block4:
+	case DW_FORM_exprloc:
+		return attribute.value > 1 && (attribute.data[0] == DW_OP_addrx ||
+		                               attribute.data[0] == DW_OP_GNU_addr_index);
+	default:
+		return false;
+	}
+}
+
+uint64_t DwarfParser::getTypeHash(const DieInfo &info) {
+	return this->getTypeHash(info.offset);
+}
+
+uint64_t DwarfParser::getTypeHash(uint64_t offset) {
+	auto cached = this->typeHashes.find(offset);
+	if (cached != this->typeHashes.end()) {
+		return cached->second;
+	}
+	this->visitTypeNode(offset);
+	return this->typeHashes[offset];
+}
+
+/**
+ * Tarjan's algorithm on the references between type DIEs: read the DIE at
+ * offset and the types it refers to, and hash every strongly connected
+ * component once all types it refers to are hashed.
+ */
+void DwarfParser::visitTypeNode(uint64_t offset) {
+	TypeNode &node = this->typeNodes[offset];
+	node.index     = this->typeNodeIndex++;
+	node.lowLink   = node.index;
+	node.hash      = 0;
+	bool found = this->decoder ? this->readNativeTypeNode(offset, node) :
+	                             this->readTypeNode(offset, node);
+	if (!found) {
+		// unique, never equal to another type
+		node.hash = offset;
+		node.references.clear();
+	}
+	this->typeNodeStack.push_back(offset);
+
+	for (uint64_t reference : node.references) {
+		if (this->typeHashes.find(reference) != this->typeHashes.end()) {
+			continue;
+		}
+		// all visited types that are not hashed yet are on the stack
+		auto it = this->typeNodes.find(reference);
+		if (it != this->typeNodes.end()) {
+			node.lowLink = std::min(node.lowLink, it->second.index);
+			continue;
+		}
+		this->visitTypeNode(reference);
+		it = this->typeNodes.find(reference);
+		if (it != this->typeNodes.end()) {
+			node.lowLink = std::min(node.lowLink, it->second.lowLink);
+		}
+	}
+
+	if (node.lowLink == node.index) {
+		size_t first = this->typeNodeStack.size() - 1;
+		while (this->typeNodeStack[first] != offset) {
+			first--;
+		}
+		std::vector<uint64_t> component(this->typeNodeStack.begin() + first,
+		                                this->typeNodeStack.end());
+		this->typeNodeStack.resize(first);
+		this->hashComponent(component);
+	}
+}
+
+/**
+ * Hash the types of a strongly connected component, the types they refer
+ * to outside of the component are hashed already.
+ *
+ * Every round hashes the attributes of a type with the hashes of the
+ * previous round of the types it refers to, starting from the attributes
+ * alone. Types with different hashes stay different in the next round,
+ * so once a round splits no more types the hashes tell apart the types
+ * that differ anywhere in the cycle. The result does not depend on the
+ * order the types were reached in, equal components of different units
+ * get equal hashes.
+ */
+void DwarfParser::hashComponent(const std::vector<uint64_t> &component) {
+	std::unordered_map<uint64_t, size_t> indices;
+	for (size_t i = 0; i < component.size(); i++) {
+		indices[component[i]] = i;
+	}
+	// per type its references: index in the component, or the hash
+	struct Reference {
+		bool internal;
+		uint64_t value;
+	};
+	std::vector<std::vector<Reference>> references(component.size());
+	std::vector<uint64_t> own(component.size());
+	for (size_t i = 0; i < component.size(); i++) {
+		const TypeNode &node = this->typeNodes[component[i]];
+		own[i] = node.hash;
+		for (uint64_t reference : node.references) {
+			auto it = indices.find(reference);
+			if (it != indices.end()) {
+				references[i].push_back(Reference{true, it->second});
+			} else {
+				references[i].push_back(
+					Reference{false, this->typeHashes[reference]});
 			}
-			dwarf_dealloc(dbg, attrbuf[i], DW_DLA_ATTR);
 		}
-		dwarf_dealloc(dbg, attrbuf, DW_DLA_LIST);
 	}
 
-	printf("<%d> tag: %d %s  name: \"%s\"\n", level, tag, tagname, name);
+	std::vector<uint64_t> hashes = own;
+	std::vector<uint64_t> next(component.size());
+	size_t classes = std::unordered_set<uint64_t>(own.begin(), own.end()).size();
+	while (true) {
+		for (size_t i = 0; i < component.size(); i++) {
+			uint64_t hash = own[i];
+			for (auto &reference : references[i]) {
+				combineHash(hash, reference.internal ? hashes[reference.value] :
+				                                       reference.value);
+			}
+			next[i] = hash;
+		}
+		hashes.swap(next);
+		size_t nextClasses =
+			std::unordered_set<uint64_t>(hashes.begin(), hashes.end()).size();
+		if (nextClasses == classes) {
+			break;
+		}
+		classes = nextClasses;
+	}
 
-	if (!localname) {
-		dwarf_dealloc(dbg, name, DW_DLA_STRING);
+	for (size_t i = 0; i < component.size(); i++) {
+		// 0 is no hash at all
+		this->typeHashes[component[i]] = hashes[i] ? hashes[i] : 1;
+		this->typeNodes.erase(component[i]);
 	}
 }
 
-template <class T>
-T *DwarfParser::getRefTypeInstance(const Dwarf_Die &object,
-                                   const std::string &dieName) {
-	T *cursym;
-
-	RefBaseType *rbt = this->manager->findRefBaseTypeByName(dieName);
-	cursym = dynamic_cast<T *>(rbt);
-	if (!rbt) {
-		return new T(this->manager, this, object, dieName);
-	} else if (!cursym) {
-		std::cout << "RefBaseType with same name but different type!"
-		          << typeid(T).name() << " vs " << typeid(rbt).name() << " "
-		          << rbt->getName() << std::endl;
-		std::cout << "Previous id: " << std::hex << rbt->getID()
-		          << " current ID: " << this->getDieOffset(object) << std::dec
-		          << std::endl;
-		return nullptr;
+/**
+ * Read the type DIE at offset with libdwarf.
+ * @return false if there is no DIE at offset.
+ */
+bool DwarfParser::readTypeNode(uint64_t offset, TypeNode &node) {
+	Dwarf_Die die = 0;
+	if (dwarf_offdie(dbg, offset, &die, &error) != DW_DLV_OK) {
+		return false;
 	}
-	cursym->addAlternativeDwarfID(this->getDieOffset(object), fileID);
-	return cursym;
+	this->hashDie(die, node);
+	// members, enumerators, subranges and parameters
+	Dwarf_Die child = 0;
+	if (dwarf_child(die, &child, &error) == DW_DLV_OK) {
+		while (true) {
+			this->hashDie(child, node);
+			Dwarf_Die sib_die = 0;
+			res = dwarf_siblingof(dbg, child, &sib_die, &error);
+			dwarf_dealloc(dbg, child, DW_DLA_DIE);
+			if (res != DW_DLV_OK) {
+				break;
+			}
+			child = sib_die;
+		}
+	}
+	dwarf_dealloc(dbg, die, DW_DLA_DIE);
+	return true;
 }
 
-template <>
-Function *DwarfParser::getTypeInstance(const Dwarf_Die &object,
-                                       const std::string &dieName) {
-	Function *cursym;
+/**
+ * Add the tag, name and layout attributes of a single DIE to the hash of
+ * node, and the DIEs they refer to to its references.
+ */
+void DwarfParser::hashDie(const Dwarf_Die &die, TypeNode &node) {
+	Dwarf_Half tag = 0;
+	dwarf_tag(die, &tag, &error);
+	combineHash(node.hash, tag);
+	combineHash(node.hash, std::hash<std::string>{}(this->getDieName(die)));
+
+	Dwarf_Attribute *attrs = nullptr;
+	Dwarf_Signed count = 0;
+	if (dwarf_attrlist(die, &attrs, &count, &error) != DW_DLV_OK) {
+		return;
+	}
+	for (Dwarf_Signed i = 0; i < count; i++) {
+		Dwarf_Half attr = 0;
+		dwarf_whatattr(attrs[i], &attr, &error);
+		if (isLayoutAttribute(attr)) {
+			combineHash(node.hash, attr);
+			combineHash(node.hash, this->hashAttribute(attrs[i], node));
+		}
+		dwarf_dealloc(dbg, attrs[i], DW_DLA_ATTR);
+	}
+	dwarf_dealloc(dbg, attrs, DW_DLA_LIST);
+}
 
-	cursym = this->manager->findBaseTypeByName<Function>(dieName);
-	if (!cursym) {
-		return new Function(this->manager, this, object, dieName);
+/**
+ * @return Hash of the value of attr. References are added to the
+ * references of node, hashComponent() hashes their types.
+ */
+uint64_t DwarfParser::hashAttribute(const Dwarf_Attribute &attr,
+                                    TypeNode &node) {
+	Dwarf_Half form = 0;
+	Dwarf_Off offset;
+	Dwarf_Unsigned udata;
+	Dwarf_Signed sdata;
+	Dwarf_Bool flag;
+	Dwarf_Block *block;
+	Dwarf_Ptr ptr;
+	char *str;
+	dwarf_whatform(attr, &form, &error);
+
+	switch (form) {
+	case DW_FORM_ref1:
+	case DW_FORM_ref2:
+	case DW_FORM_ref4:
+	case DW_FORM_ref8:
+	case DW_FORM_ref_udata:
+	case DW_FORM_ref_addr:
+		if (dwarf_global_formref(attr, &offset, &error) == DW_DLV_OK) {
+			node.references.push_back(offset);
+			return 0;
+		}
+		break;
+	case DW_FORM_data1:
+	case DW_FORM_data2:
+	case DW_FORM_data4:
+	case DW_FORM_data8:
+	case DW_FORM_udata:
+		if (dwarf_formudata(attr, &udata, &error) == DW_DLV_OK) {
+			return udata;
+		}
+		break;
+	case DW_FORM_sdata:
+	case DW_FORM_implicit_const:
+		if (dwarf_formsdata(attr, &sdata, &error) == DW_DLV_OK) {
+			return sdata;
+		}
+		break;
+	case DW_FORM_flag:
+	case DW_FORM_flag_present:
+		if (dwarf_formflag(attr, &flag, &error) == DW_DLV_OK) {
+			return flag;
+		}
+		break;
+	case DW_FORM_block:
+	case DW_FORM_block1:
+	case DW_FORM_block2:
+	case DW_FORM_block4:
+		if (dwarf_formblock(attr, &block, &error) == DW_DLV_OK) {
+			std::string bytes((char *)block->bl_data, block->bl_len);
+			dwarf_dealloc(dbg, block, DW_DLA_BLOCK);
+			return std::hash<std::string>{}(bytes);
+		}
+		break;
+	case DW_FORM_exprloc:
+		if (dwarf_formexprloc(attr, &udata, &ptr, &error) == DW_DLV_OK) {
+			return std::hash<std::string>{}(std::string((char *)ptr, udata));
+		}
+		break;
+	case DW_FORM_string:
+	case DW_FORM_strp:
+		if (dwarf_formstring(attr, &str, &error) == DW_DLV_OK) {
+			return std::hash<std::string>{}(str);
+		}
+		break;
 	}
-	cursym->update(this, object);
-	cursym->addAlternativeDwarfID(this->getDieOffset(object), fileID);
-	return cursym;
+	return form;
 }
 
-template <>
-Variable *DwarfParser::getTypeInstance(const Dwarf_Die &object,
-                                       const std::string &dieName) {
-	Variable *cursym;
+/**
+ * @return DW_AT_name of natively decoded attributes, empty if there is none.
+ */
+static std::string getName(
+		const std::vector<DwarfDecoder::Attribute> &attributes) {
+	for (auto &attribute : attributes) {
+		if (attribute.attr == DW_AT_name && isStringForm(attribute.form) &&
+		    attribute.data) {
+			return (const char *)attribute.data;
+		}
+	}
+	return "";
+}
 
-	cursym = this->manager->findVariableByName(dieName);
-	if (!cursym) {
-		return new Variable(this->manager, this, object, dieName);
+/**
+ * readTypeNode() with the native decoder. The hashes equal the ones
+ * computed with libdwarf.
+ */
+bool DwarfParser::readNativeTypeNode(uint64_t offset, TypeNode &node) {
+	const DwarfDecoder::Unit *unit = this->decoder->findUnit(offset);
+	DwarfDecoder::Die die;
+	if (!unit || !this->decoder->getDie(*unit, offset, die) || !die.abbrev) {
+		return false;
 	}
-	cursym->update(this, object);
-	cursym->addAlternativeDwarfID(this->getDieOffset(object), fileID);
-	return cursym;
+	std::vector<DwarfDecoder::Attribute> attributes;
+	this->decoder->getAttributes(die, attributes);
+	this->hashDie(die.abbrev->tag, attributes, node);
+	// members, enumerators, subranges and parameters
+	if (die.abbrev->hasChildren) {
+		DwarfDecoder::Die child;
+		uint64_t childOffset = this->decoder->getNextOffset(die);
+		while (this->decoder->getDie(*unit, childOffset, child) &&
+		       child.abbrev) {
+			this->decoder->getAttributes(child, attributes);
+			this->hashDie(child.abbrev->tag, attributes, node);
+			childOffset = this->decoder->getSiblingOffset(child);
+		}
+	}
+	return true;
 }
 
-template <class T>
-T *DwarfParser::getTypeInstance(const Dwarf_Die &object,
-                                const std::string &dieName) {
-	T *cursym = this->manager->findBaseTypeByName<T>(dieName);
-	if (!cursym) {
-		return new T(this->manager, this, object, dieName);
+void DwarfParser::hashDie(Dwarf_Half tag,
+                          const std::vector<DwarfDecoder::Attribute> &attributes,
+                          TypeNode &node) {
+	combineHash(node.hash, tag);
+	combineHash(node.hash, std::hash<std::string>{}(getName(attributes)));
+
+	for (auto &attribute : attributes) {
+		if (isLayoutAttribute(attribute.attr)) {
+			combineHash(node.hash, attribute.attr);
+			combineHash(node.hash, this->hashAttribute(attribute, node));
+		}
 	}
-	// TODO Include
-	// We need to update the representation of the object that we
-	// already know about
-	// cursym->update(object);
-	cursym->addAlternativeDwarfID(this->getDieOffset(object), fileID);
-	return cursym;
 }
 
-Symbol *DwarfParser::initSymbolFromDie(const Dwarf_Die &cur_die,
+uint64_t DwarfParser::hashAttribute(const DwarfDecoder::Attribute &attr,
+                                    TypeNode &node) {
+	switch (attr.form) {
+	case DW_FORM_ref1:
+	case DW_FORM_ref2:
+	case DW_FORM_ref4:
+	case DW_FORM_ref8:
+	case DW_FORM_ref_udata:
+	case DW_FORM_ref_addr:
+		node.references.push_back(attr.value);
+		return 0;
+	case DW_FORM_data1:
+	case DW_FORM_data2:
+	case DW_FORM_data4:
+	case DW_FORM_data8:
+	case DW_FORM_udata:
+	case DW_FORM_sdata:
+	case DW_FORM_implicit_const:
+	case DW_FORM_flag:
+	case DW_FORM_flag_present:
+		return attr.value;
+	case DW_FORM_block:
+	case DW_FORM_block1:
+	case DW_FORM_block2:
+	case DW_FORM_block4:
+	case DW_FORM_exprloc:
+		return std::hash<std::string>{}(
+			std::string((const char *)attr.data, attr.value));
+	case DW_FORM_string:
+	case DW_FORM_strp:
+		if (attr.data) {
+			return std::hash<std::string>{}((const char *)attr.data);
+		}
+		break;
+	}
+	return attr.form;
+}
+
+Symbol *DwarfParser::initSymbolFromDie(const DieInfo &info,
                                        Symbol *parent,
                                        int level,
                                        Srcfilesdata sf) {
-	Dwarf_Half tag      = 0;
-	const char *tagname = nullptr;
-	res = dwarf_tag(cur_die, &tag, &error);
-	if (res != DW_DLV_OK) {
-		throw DwarfException("Error in dwarf_get_TAG_name");
-	}
-
-	std::string name = this->getDieName(cur_die);
+	Dwarf_Half tag          = info.tag;
+	const char *tagname     = nullptr;
+	const std::string &name = info.name;
 
 	Symbol *cursym = nullptr;
 
@@ -383,109 +1665,110 @@ Symbol *DwarfParser::initSymbolFromDie(const Dwarf_Die &cur_die,
 
 	switch (tag) {
 	case DW_TAG_typedef:
-		cursym = this->getRefTypeInstance<Typedef>(cur_die, name);
+		cursym = this->getTypeInstance<Typedef>(info, name);
 		break;
 	case DW_TAG_structure_type:
 	case DW_TAG_class_type:
-		if (this->dieHasAttr(cur_die, DW_AT_declaration))
+		if (info.has(DW_AT_declaration))
 			break;
-		cursym = this->getTypeInstance<Struct>(cur_die, name);
+		cursym = this->getTypeInstance<Struct>(info, name);
 		break;
 	case DW_TAG_union_type:
-		cursym = this->getTypeInstance<Union>(cur_die, name);
+		cursym = this->getTypeInstance<Union>(info, name);
 		break;
 	case DW_TAG_member:
 		if (!parent) {
 			std::cout << "Parent not set" << std::endl;
-			print_die_data(cur_die,level,sf);
+			print_die_data(info, level, sf);
 			break;
 		}
-		structured = dynamic_cast<Structured *>(parent);
+		structured = kind_cast<Structured>(parent);
 		if (structured) {
 			cursym = structured->addMember(this->manager, this,
-			                               cur_die, name);
-			// cursym = this->getTypeInstance<Variable>(cur_die, name);
+			                               info, name);
+			// cursym = this->getTypeInstance<Variable>(info, name);
 			break;
 		} else {
-			// print_die_data(cur_die,level,sf);
+			// print_die_data(info, level, sf);
 			// class also contains members
 			// throw DwarfException("Parent structured not set");
 		}
 		break;
 	case DW_TAG_base_type:
-		cursym = this->getTypeInstance<BaseType>(cur_die, name);
+		cursym = this->getTypeInstance<BaseType>(info, name);
 		break;
 	case DW_TAG_pointer_type:
-		cursym = this->getRefTypeInstance<Pointer>(cur_die, name);
+		cursym = this->getTypeInstance<Pointer>(info, name);
 		break;
 	case DW_TAG_const_type:
-		cursym = this->getRefTypeInstance<ConstType>(cur_die, name);
+		cursym = this->getTypeInstance<ConstType>(info, name);
 		break;
 	case DW_TAG_enumeration_type:
-		cursym = this->getTypeInstance<Enum>(cur_die, name);
+		cursym = this->getTypeInstance<Enum>(info, name);
 		break;
 	case DW_TAG_enumerator:
 		assert(parent);
-		enumType = dynamic_cast<Enum *>(parent);
+		enumType = kind_cast<Enum>(parent);
 		if (enumType) {
-			enumType->addEnum(this->manager, this, cur_die, name);
+			enumType->addEnum(this->manager, this, info, name);
 		} else {
-			print_die_data(cur_die, level, sf);
+			print_die_data(info, level, sf);
 		}
 		break;
 	case DW_TAG_variable:
-		if (this->dieHasAttr(cur_die, DW_AT_specification)) {
-			if (this->dieHasAttr(cur_die, DW_AT_location)) {
+		if (info.has(DW_AT_specification)) {
+			if (info.has(DW_AT_location)) {
 				// This is an initializer for another object
-				uint64_t ref = this->getDieAttributeNumber(cur_die, DW_AT_specification);
+				uint64_t ref = info.specification;
 				Symbol *s = this->manager->findSymbolByID(
 					this->manager->getID(ref, this->getFileID()));
-				Variable *v = s ? dynamic_cast<Variable *>(s) : NULL;
+				Variable *v = s ? kind_cast<Variable>(s) : NULL;
 				if (v)
-					v->update(this, cur_die);
+					v->update(this, info);
 			}
 			break;
 		}
-		cursym = this->getTypeInstance<Variable>(cur_die, name);
+		cursym = this->getTypeInstance<Variable>(info, name);
 		break;
 	case DW_TAG_array_type:
-		cursym = new Array(this->manager, this, cur_die, name);
+		cursym = this->getTypeInstance<Array>(info, name);
 		break;
 	case DW_TAG_subrange_type:
 		assert(parent);
-		array = dynamic_cast<Array *>(parent);
+		array = kind_cast<Array>(parent);
 		if (array) {
-			array->update(this, cur_die);
+			array->update(this, info);
 		} else {
-			print_die_data(cur_die, level, sf);
+			print_die_data(info, level, sf);
 		}
 		break;
 	case DW_TAG_subprogram:
-		if (this->dieHasAttr(cur_die, DW_AT_specification)) {
-			if (this->dieHasAttr(cur_die, DW_AT_low_pc)) {
+		if (info.has(DW_AT_specification)) {
+			if (info.has(DW_AT_low_pc)) {
 				// This is an initializer for another object
-				uint64_t ref = this->getDieAttributeNumber(cur_die, DW_AT_specification);
+				uint64_t ref = info.specification;
 				Symbol *s = this->manager->findSymbolByID(
 					this->manager->getID(ref, this->getFileID()));
-				Function *f = s ? dynamic_cast<Function *>(s) : NULL;
+				Function *f = s ? kind_cast<Function>(s) : NULL;
 				if (f)
-					f->update(this, cur_die);
+					f->update(this, info);
 			}
 			break;
 		}
 
 		// case DW_TAG_subroutine_type:
-		cursym = this->getTypeInstance<Function>(cur_die, name);
+		cursym = this->getTypeInstance<Function>(info, name);
 		// cursym = new Function(cur_die);
 		// print_die_data(cur_die, level, sf);
 		break;
 	case DW_TAG_formal_parameter:
-		function = dynamic_cast<Function *>(parent);
+		function = kind_cast<Function>(parent);
 		if (function) {
-			function->addParam(this, cur_die);
+			function->addParam(this, info);
 		}
 		break;
 	case DW_TAG_compile_unit:
+	case DW_TAG_skeleton_unit:
 	case DW_TAG_namespace:
 	case DW_TAG_imported_declaration:
 	//case DW_TAG_class_type:
@@ -505,6 +1788,215 @@ Symbol *DwarfParser::initSymbolFromDie(const Dwarf_Die &cur_die,
 	return cursym;
 }
 
+DieInfo DwarfParser::getDieInfo(const Dwarf_Die &die) {
+	DieInfo info{};
+	info.die    = die;
+	info.offset = this->getDieOffset(die);
+	if (dwarf_tag(die, &info.tag, &error) != DW_DLV_OK) {
+		throw DwarfException("Error in dwarf_tag\n");
+	}
+
+	Dwarf_Attribute *attrs;
+	Dwarf_Signed count;
+	int res = dwarf_attrlist(die, &attrs, &count, &error);
+	if (res == DW_DLV_ERROR) {
+		throw DwarfException("Error in dwarf_attrlist\n");
+	}
+	if (res == DW_DLV_NO_ENTRY) {
+		return info;
+	}
+
+	bool highPCOffset = false;
+	for (Dwarf_Signed i = 0; i < count; i++) {
+		Dwarf_Half attr, form;
+		if (dwarf_whatattr(attrs[i], &attr, &error) != DW_DLV_OK ||
+		    dwarf_whatform(attrs[i], &form, &error) != DW_DLV_OK) {
+			dwarf_dealloc(dbg, attrs[i], DW_DLA_ATTR);
+			continue;
+		}
+
+		bool ok = false;
+		char *str;
+		Dwarf_Bool flag;
+		switch (attr) {
+		case DW_AT_name:
+			ok = (dwarf_formstring(attrs[i], &str, &error) == DW_DLV_OK);
+			if (ok) {
+				info.name = str;
+			}
+			break;
+		case DW_AT_external:
+		case DW_AT_declaration:
+			ok = (dwarf_formflag(attrs[i], &flag, &error) == DW_DLV_OK);
+			if (ok) {
+				(attr == DW_AT_external ? info.external : info.declaration) = flag;
+			}
+			break;
+		case DW_AT_low_pc:
+			ok = (dwarf_formaddr(attrs[i], (Dwarf_Addr *)&info.lowPC,
+			                     &error) == DW_DLV_OK);
+			break;
+		case DW_AT_high_pc:
+			// since DWARF 4 high_pc is usually the size
+			if (form == DW_FORM_addr) {
+				ok = (dwarf_formaddr(attrs[i], (Dwarf_Addr *)&info.highPC,
+				                     &error) == DW_DLV_OK);
+			} else {
+				ok = (dwarf_formudata(attrs[i], (Dwarf_Unsigned *)&info.highPC,
+				                      &error) == DW_DLV_OK);
+				highPCOffset = ok;
+			}
+			break;
+		case DW_AT_ranges:
+			// DWARF 2 and 3 use a data form for the offset
+			if (form == DW_FORM_sec_offset) {
+				ok = (dwarf_global_formref(attrs[i], (Dwarf_Off *)&info.ranges,
+				                           &error) == DW_DLV_OK);
+			} else {
+				ok = (dwarf_formudata(attrs[i], (Dwarf_Unsigned *)&info.ranges,
+				                      &error) == DW_DLV_OK);
+			}
+			break;
+		case DW_AT_type:
+			ok = this->getAttributeNumber(attrs[i], info.type);
+			break;
+		case DW_AT_byte_size:
+			ok = this->getAttributeNumber(attrs[i], info.byteSize);
+			break;
+		case DW_AT_bit_size:
+			ok = this->getAttributeNumber(attrs[i], info.bitSize);
+			break;
+		case DW_AT_bit_offset:
+			ok = this->getAttributeNumber(attrs[i], info.bitOffset);
+			break;
+		case DW_AT_data_member_location:
+			ok = this->getAttributeNumber(attrs[i], info.memberLocation);
+			break;
+		case DW_AT_location:
+			ok = this->getAttributeNumber(attrs[i], info.location);
+			break;
+		case DW_AT_upper_bound:
+			ok = this->getAttributeNumber(attrs[i], info.upperBound);
+			break;
+		case DW_AT_encoding:
+			ok = this->getAttributeNumber(attrs[i], info.encoding);
+			break;
+		case DW_AT_const_value:
+			ok = this->getAttributeNumber(attrs[i], info.constValue);
+			break;
+		case DW_AT_specification:
+			ok = this->getAttributeNumber(attrs[i], info.specification);
+			break;
+		}
+		if (ok) {
+			info.present |= DieInfo::bit(attr);
+		}
+		dwarf_dealloc(dbg, attrs[i], DW_DLA_ATTR);
+	}
+	dwarf_dealloc(dbg, attrs, DW_DLA_LIST);
+
+	if (highPCOffset) {
+		info.highPC += info.lowPC;
+	}
+	return info;
+}
+
+/**
+ * getDieInfo() of a DIE read by the native decoder, with the same
+ * results as libdwarf.
+ */
+DieInfo DwarfParser::getDieInfo(DwarfDecoder::Die &die) {
+	DieInfo info{};
+	info.die    = nullptr;
+	info.offset = die.offset;
+	info.tag    = die.abbrev->tag;
+	this->decoder->getAttributes(die, this->attributes);
+
+	bool highPCOffset = false;
+	for (auto &attribute : this->attributes) {
+		Dwarf_Half form = attribute.form;
+		bool ok = false;
+		switch (attribute.attr) {
+		case DW_AT_name:
+			ok = isStringForm(form) && attribute.data;
+			if (ok) {
+				info.name = (const char *)attribute.data;
+			}
+			break;
+		case DW_AT_external:
+		case DW_AT_declaration:
+			ok = (form == DW_FORM_flag || form == DW_FORM_flag_present);
+			if (ok) {
+				(attribute.attr == DW_AT_external ?
+				 info.external : info.declaration) = attribute.value;
+			}
+			break;
+		case DW_AT_low_pc:
+			ok = isAddressForm(form);
+			info.lowPC = ok ? attribute.value : 0;
+			break;
+		case DW_AT_high_pc:
+			// since DWARF 4 high_pc is usually the size
+			ok = isAddressForm(form) || isUnsignedForm(form);
+			highPCOffset = ok && !isAddressForm(form);
+			info.highPC = ok ? attribute.value : 0;
+			break;
+		case DW_AT_ranges:
+			// DWARF 2 and 3 use a data form for the offset
+			ok = (form == DW_FORM_sec_offset || form == DW_FORM_rnglistx ||
+			      isUnsignedForm(form));
+			info.ranges = ok ? attribute.value : 0;
+			break;
+		case DW_AT_type:
+			ok = this->getAttributeNumber(attribute, info.type);
+			break;
+		case DW_AT_byte_size:
+			ok = this->getAttributeNumber(attribute, info.byteSize);
+			break;
+		case DW_AT_bit_size:
+			ok = this->getAttributeNumber(attribute, info.bitSize);
+			break;
+		case DW_AT_bit_offset:
+			ok = this->getAttributeNumber(attribute, info.bitOffset);
+			break;
+		case DW_AT_data_member_location:
+			ok = this->getAttributeNumber(attribute, info.memberLocation);
+			break;
+		case DW_AT_location:
+			if (isIndexedAddress(attribute)) {
+				// split units use the address table of the skeleton
+				uint64_t index;
+				ok = decodeULEB128(attribute.data + 1,
+				                   attribute.data + attribute.value, index) &&
+				     this->decoder->getAddress(*die.unit, index, info.location);
+			} else {
+				ok = this->getAttributeNumber(attribute, info.location);
+			}
+			break;
+		case DW_AT_upper_bound:
+			ok = this->getAttributeNumber(attribute, info.upperBound);
+			break;
+		case DW_AT_encoding:
+			ok = this->getAttributeNumber(attribute, info.encoding);
+			break;
+		case DW_AT_const_value:
+			ok = this->getAttributeNumber(attribute, info.constValue);
+			break;
+		case DW_AT_specification:
+			ok = this->getAttributeNumber(attribute, info.specification);
+			break;
+		}
+		if (ok) {
+			info.present |= DieInfo::bit(attribute.attr);
+		}
+	}
+
+	if (highPCOffset) {
+		info.highPC += info.lowPC;
+	}
+	return info;
+}
+
 std::string DwarfParser::getDieName(const Dwarf_Die &die) {
 	char *name = nullptr;
 
@@ -581,13 +2073,8 @@ uint64_t parseBlock(uint64_t blen, uint8_t *bdata) {
 		break;
 	case DW_OP_plus_uconst:
 		// For further details see: binutils/dwarf.c:256
-		result = 0;
-		assert(blen <= 9);
-		for (Dwarf_Unsigned i = 1; i < blen; i++) {
-			uint8_t byte = bdata[i];
-			result |= ((uint64_t)(byte & 0x7f)) << (i - 1) * 7;
-			if ((byte & 0x80) == 0)
-				break;
+		if (!decodeULEB128(bdata + 1, bdata + blen, result)) {
+			result = 0;
 		}
 		break;
 	default:
@@ -617,10 +2104,8 @@ uint64_t parseBlock(uint64_t blen, uint8_t *bdata) {
 uint64_t DwarfParser::getDieAttributeNumber(const Dwarf_Die &die,
                                             const Dwarf_Half &attr) {
 	uint64_t result;
-	uint64_t result2;
 	Dwarf_Attribute myattr;
 	Dwarf_Bool hasattr;
-	Dwarf_Block *block;
 
 	int res = dwarf_hasattr(die, attr, &hasattr, &error);
 	if (hasattr == 0) {
@@ -632,58 +2117,82 @@ uint64_t DwarfParser::getDieAttributeNumber(const Dwarf_Die &die,
 		throw DwarfException("Error in dwarf_attr\n");
 	}
 
-	uint16_t formid = ((uint16_t *)myattr)[1];
+	if (this->getAttributeNumber(myattr, result)) {
+		return result;
+	}
+
+	Dwarf_Half formid = 0;
+	dwarf_whatform(myattr, &formid, &error);
+	const char *atname;
+	dwarf_get_AT_name(attr, &atname);
+	const char *formname;
+	dwarf_get_FORM_name(formid, &formname);
+
+	std::cout << this->getDieName(die) << std::endl;
+	std::cout << atname << ": ";
+	std::cout << formname << std::endl;
+
+	throw DwarfException("Error in getDieAttributeNumber\n");
+	return 0;
+}
+
+bool DwarfParser::getAttributeNumber(const Dwarf_Attribute &attr,
+                                     uint64_t &result) {
+	Dwarf_Half formid;
+	Dwarf_Block *block;
+	Dwarf_Ptr expr;
+	int res = dwarf_whatform(attr, &formid, &error);
+	if (res != DW_DLV_OK) {
+		return false;
+	}
+
 	switch (formid) {
 	case DW_FORM_block1:
 	case DW_FORM_block2:
 	case DW_FORM_block4:
-		res = dwarf_formblock(myattr, &block, &error);
+		res = dwarf_formblock(attr, &block, &error);
 		if (res == DW_DLV_OK) {
 			assert(block->bl_len > 0);
 			result = parseBlock(block->bl_len, (uint8_t *)block->bl_data);
 			dwarf_dealloc(dbg, block, DW_DLA_BLOCK);
-			return result;
+			return true;
 		}
 		break;
 	case DW_FORM_data1:
 	case DW_FORM_data2:
 	case DW_FORM_data4:
 	case DW_FORM_data8:
-		res = dwarf_formudata(myattr, (Dwarf_Unsigned *)&result, &error);
-		if (res == DW_DLV_OK) {
-			return result;
-		}
-		break;
+	case DW_FORM_udata:
+		res = dwarf_formudata(attr, (Dwarf_Unsigned *)&result, &error);
+		return res == DW_DLV_OK;
+	case DW_FORM_ref1:
+	case DW_FORM_ref2:
 	case DW_FORM_ref4:
-		res = dwarf_formref(myattr, (Dwarf_Off *)&result, &error);
-		if (res == DW_DLV_OK) {
-			return result + this->curCUOffset;
-		}
-		break;
+	case DW_FORM_ref8:
+	case DW_FORM_ref_udata:
+	case DW_FORM_ref_addr:
+		res = dwarf_global_formref(attr, (Dwarf_Off *)&result, &error);
+		return res == DW_DLV_OK;
 	case DW_FORM_sdata:
-		res = dwarf_formsdata(myattr, (Dwarf_Signed *)&result, &error);
-		if (res == DW_DLV_OK) {
-			return result;
-		}
-		break;
+	case DW_FORM_implicit_const:
+		res = dwarf_formsdata(attr, (Dwarf_Signed *)&result, &error);
+		return res == DW_DLV_OK;
 	case DW_FORM_addr:
-		res = dwarf_formaddr(myattr, (Dwarf_Addr *)&result, &error);
-		if (res == DW_DLV_OK) {
-			return result;
-		}
-		break;
+		res = dwarf_formaddr(attr, (Dwarf_Addr *)&result, &error);
+		return res == DW_DLV_OK;
 	case DW_FORM_sec_offset:
-		res = dwarf_global_formref(myattr, (Dwarf_Off *)&result, &error);
+		res = dwarf_global_formref(attr, (Dwarf_Off *)&result, &error);
 		// TODO we do not know where the offset is relative to...
 		if (res == DW_DLV_OK) {
-			return result + this->curCUOffset;
+			result += this->curCUOffset;
+			return true;
 		}
 		break;
 	case DW_FORM_exprloc:
-		res = dwarf_formexprloc(
-		    myattr, (Dwarf_Unsigned *)&result, (Dwarf_Ptr *)&result2, &error);
+		res = dwarf_formexprloc(attr, (Dwarf_Unsigned *)&result, &expr, &error);
 		if (res == DW_DLV_OK) {
-			return parseBlock(result, (uint8_t *)result2);
+			result = parseBlock(result, (uint8_t *)expr);
+			return true;
 		}
 		break;
 	default:
@@ -691,18 +2200,50 @@ uint64_t DwarfParser::getDieAttributeNumber(const Dwarf_Die &die,
 		dwarf_get_FORM_name(formid, &formname);
 		std::cout << formname << " currently not supported" << std::endl;
 	}
+	return false;
+}
 
-	const char *atname;
-	dwarf_get_AT_name(attr, &atname);
-	const char *formname;
-	dwarf_get_FORM_name(formid, &formname);
-
-	std::cout << this->getDieName(die) << std::endl;
-	std::cout << atname << ": ";
-	std::cout << formname << std::endl;
-
-	throw DwarfException("Error in getDieAttributeNumber\n");
-	return 0;
+bool DwarfParser::getAttributeNumber(const DwarfDecoder::Attribute &attr,
+                                     uint64_t &result) {
+	switch (attr.form) {
+	case DW_FORM_block1:
+	case DW_FORM_block2:
+	case DW_FORM_block4:
+		assert(attr.value > 0);
+		result = parseBlock(attr.value, (uint8_t *)attr.data);
+		return true;
+	case DW_FORM_data1:
+	case DW_FORM_data2:
+	case DW_FORM_data4:
+	case DW_FORM_data8:
+	case DW_FORM_udata:
+	case DW_FORM_ref1:
+	case DW_FORM_ref2:
+	case DW_FORM_ref4:
+	case DW_FORM_ref8:
+	case DW_FORM_ref_udata:
+	case DW_FORM_ref_addr:
+	case DW_FORM_sdata:
+	case DW_FORM_implicit_const:
+	case DW_FORM_addr:
+		result = attr.value;
+		return true;
+	case DW_FORM_sec_offset:
+		// TODO we do not know where the offset is relative to...
+		result = attr.value + this->curCUOffset;
+		return true;
+	case DW_FORM_exprloc:
+		result = parseBlock(attr.value, (uint8_t *)attr.data);
+		return true;
+	case DW_FORM_loclistx:
+		// the location list of a local variable has no single value
+		return false;
+	default:
+		const char *formname;
+		dwarf_get_FORM_name(attr.form, &formname);
+		std::cout << formname << " currently not supported" << std::endl;
+	}
+	return false;
 }
 
 std::string DwarfParser::getDieAttributeString(const Dwarf_Die &die,
@@ -757,6 +2298,47 @@ uint64_t DwarfParser::getDieAttributeAddress(const Dwarf_Die &die,
 	return 0;
 }
 
+std::vector<std::pair<uint64_t, uint64_t>> DwarfParser::getDieRanges(
+		const DieInfo &info) {
+	std::vector<std::pair<uint64_t, uint64_t>> result;
+
+	if (info.has(DW_AT_low_pc)) {
+		if (info.has(DW_AT_high_pc) && info.highPC > info.lowPC) {
+			result.push_back(std::make_pair(info.lowPC, info.highPC));
+		}
+		return result;
+	}
+	if (!info.has(DW_AT_ranges)) {
+		return result;
+	}
+	if (!info.die) {
+		const DwarfDecoder::Unit *unit = this->decoder->findUnit(info.offset);
+		return unit ? this->decoder->getRanges(*unit, info.ranges) : result;
+	}
+
+	Dwarf_Ranges *ranges;
+	Dwarf_Signed count;
+	Dwarf_Unsigned byteCount;
+	int res = dwarf_get_ranges_a(dbg, info.ranges, info.die, &ranges, &count,
+	                             &byteCount, &error);
+	if (res != DW_DLV_OK) {
+		return result;
+	}
+	uint64_t base = this->curCUBaseAddress;
+	for (Dwarf_Signed i = 0; i < count; i++) {
+		const Dwarf_Ranges &range = ranges[i];
+		if (range.dwr_type == DW_RANGES_ADDRESS_SELECTION) {
+			base = range.dwr_addr2;
+		} else if (range.dwr_type == DW_RANGES_ENTRY &&
+		           range.dwr_addr2 > range.dwr_addr1) {
+			result.push_back(std::make_pair(base + range.dwr_addr1,
+			                                base + range.dwr_addr2));
+		}
+	}
+	dwarf_ranges_dealloc(dbg, ranges, count);
+	return result;
+}
+
 bool DwarfParser::isDieExternal(const Dwarf_Die &die) {
 	return this->getDieAttributeFlag(die, DW_AT_external);
 }
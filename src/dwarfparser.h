@@ -4,16 +4,85 @@
 #include <libdwarf/dwarf.h>
 #include <libdwarf/libdwarf.h>
 
+#include <memory>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
 #include <mutex>
 
+#include "dwarfdecoder.h"
+
 struct Dwarf_Die_s;
 typedef struct Dwarf_Die_s* Dwarf_Die;
 
 class Symbol;
 class SymbolManager;
 
+/**
+ * The attributes of a DIE that symbols are created from, read by
+ * DwarfParser::getDieInfo() with a single dwarf_attrlist() call.
+ * References are offsets in .debug_info. An attribute that is missing or
+ * has a form that cannot be decoded is 0 and has() returns false for it.
+ */
+struct DieInfo {
+	Dwarf_Die die;           ///< Only valid while the DIE is parsed, nullptr
+	                         ///< if it was read by DwarfDecoder.
+	uint64_t offset;         ///< Offset of the DIE in .debug_info.
+	Dwarf_Half tag;
+	uint32_t present;        ///< Attributes that were found, see has().
+	std::string name;        ///< DW_AT_name
+	uint64_t type;           ///< DW_AT_type
+	uint64_t byteSize;       ///< DW_AT_byte_size
+	uint64_t bitSize;        ///< DW_AT_bit_size
+	uint64_t bitOffset;      ///< DW_AT_bit_offset
+	uint64_t memberLocation; ///< DW_AT_data_member_location
+	uint64_t location;       ///< DW_AT_location
+	uint64_t upperBound;     ///< DW_AT_upper_bound
+	uint64_t encoding;       ///< DW_AT_encoding
+	uint64_t constValue;     ///< DW_AT_const_value
+	uint64_t lowPC;          ///< DW_AT_low_pc
+	uint64_t highPC;         ///< DW_AT_high_pc, as end address
+	uint64_t ranges;         ///< DW_AT_ranges, offset in .debug_ranges
+	uint64_t specification;  ///< DW_AT_specification
+	bool external;           ///< DW_AT_external
+	bool declaration;        ///< DW_AT_declaration
+
+	/**
+	 * @return true if the DIE has attr, one of the attributes above.
+	 */
+	bool has(Dwarf_Half attr) const {
+		return this->present & DieInfo::bit(attr);
+	}
+
+	/**
+	 * @return Bit of attr in present, 0 for other attributes.
+	 */
+	static uint32_t bit(Dwarf_Half attr) {
+		switch (attr) {
+		case DW_AT_name:                 return 1u << 0;
+		case DW_AT_type:                 return 1u << 1;
+		case DW_AT_byte_size:            return 1u << 2;
+		case DW_AT_bit_size:             return 1u << 3;
+		case DW_AT_bit_offset:           return 1u << 4;
+		case DW_AT_data_member_location: return 1u << 5;
+		case DW_AT_location:             return 1u << 6;
+		case DW_AT_upper_bound:          return 1u << 7;
+		case DW_AT_encoding:             return 1u << 8;
+		case DW_AT_const_value:          return 1u << 9;
+		case DW_AT_low_pc:               return 1u << 10;
+		case DW_AT_high_pc:              return 1u << 11;
+		case DW_AT_ranges:               return 1u << 12;
+		case DW_AT_specification:        return 1u << 13;
+		case DW_AT_external:             return 1u << 14;
+		case DW_AT_declaration:          return 1u << 15;
+		default:                         return 0;
+		}
+	}
+};
+
 class DwarfParser {
 public:
 	class Srcfilesdata {
@@ -42,9 +111,82 @@ public:
 
 	virtual ~DwarfParser();
 
+	/**
+	 * Parse all compilation units of a file into mgr. A stripped file is
+	 * replaced by its separate debug file, the split units of skeleton units
+	 * are read from their .dwo files or the filename.dwp package, see
+	 * DebugFile. Split units are always read with DwarfDecoder.
+	 * @param threads Number of worker threads, 0 selects one per core.
+	 * @param native Decode .debug_info with DwarfDecoder instead of
+	 * libdwarf, if the file is supported by it.
+	 */
 	static void parseDwarfFromFilename(const std::string &filename,
-	                                   SymbolManager *mgr);
-	static void parseDwarfFromFD(int fd, SymbolManager *mgr);
+	                                   SymbolManager *mgr,
+	                                   unsigned int threads=1,
+	                                   bool native=false);
+	static void parseDwarfFromFD(int fd, SymbolManager *mgr,
+	                             unsigned int threads=1,
+	                             bool native=false);
+
+	/**
+	 * Parse all compilation units of several files into mgr, for example
+	 * vmlinux and its modules. The units of all files are spread over
+	 * the worker threads and merged into mgr in the order of filenames.
+	 * Types of later files that are structurally equal to a type already
+	 * in mgr are merged into it, see getTypeHash().
+	 * @param threads Number of worker threads, 0 selects one per core.
+	 */
+	static void parseDwarfFromFilenames(const std::vector<std::string> &filenames,
+	                                    SymbolManager *mgr,
+	                                    unsigned int threads=1,
+	                                    bool native=false);
+
+	/**
+	 * Load mgr from the symbol database dbFilename if it was created from
+	 * the current version of filename. Otherwise parse filename and write
+	 * the database.
+	 */
+	static void parseDwarfFromFilenameCached(const std::string &filename,
+	                                         const std::string &dbFilename,
+	                                         SymbolManager *mgr,
+	                                         unsigned int threads=1,
+	                                         bool native=false);
+
+	/**
+	 * Only index the names of filename and attach the parser to mgr, which
+	 * then creates the symbols it is asked for on first use. Lookups from
+	 * several threads are serialized until mgr is frozen.
+	 */
+	static void parseDwarfFromFilenameLazy(const std::string &filename,
+	                                       SymbolManager *mgr);
+
+	/**
+	 * Lazy mode: create the symbols of the top level DIEs named name, the
+	 * first definition of every tag.
+	 * @return true if a symbol was created.
+	 */
+	bool loadName(const std::string &name);
+
+	/**
+	 * Lazy mode: create the symbol of the DIE at offset and its children.
+	 * @return true if a symbol was created.
+	 */
+	bool loadDie(uint64_t offset);
+
+	/**
+	 * Lazy mode: create the symbols of all top level DIEs not loaded yet.
+	 */
+	void loadAll();
+
+	/**
+	 * @return A new process wide unique file id.
+	 */
+	static uint32_t newFileID();
+
+	/**
+	 * @return The attributes of die, see DieInfo.
+	 */
+	DieInfo getDieInfo(const Dwarf_Die &die);
 
 	bool dieHasAttr(const Dwarf_Die &die, const Dwarf_Half &attr);
 	std::string getDieName(const Dwarf_Die &die);
@@ -54,14 +196,27 @@ public:
 	uint64_t getDieAttributeNumber(const Dwarf_Die &die, const Dwarf_Half &attr);
 	std::string getDieAttributeString(const Dwarf_Die &die, const Dwarf_Half &attr);
 	uint64_t getDieAttributeAddress(const Dwarf_Die &die, const Dwarf_Half &attr);
+
+	/**
+	 * @return The [begin, end) address ranges of the DIE, from
+	 * DW_AT_low_pc/DW_AT_high_pc or DW_AT_ranges, in DWARF order.
+	 */
+	std::vector<std::pair<uint64_t, uint64_t>> getDieRanges(const DieInfo &info);
 	bool isDieExternal(const Dwarf_Die &die);
 	bool isDieDeclaration(const Dwarf_Die &die);
 	bool getDieAttributeFlag(const Dwarf_Die &die, const Dwarf_Half &attr);
 
+	/**
+	 * @return Structural hash of a type DIE: its tag, name, size, the
+	 * layout of its members and the hashes of the types it refers to.
+	 * Source positions are left out, so equal types of different
+	 * compilation units have equal hashes. Types that refer to each other
+	 * in a cycle are hashed together, see hashComponent().
+	 */
+	uint64_t getTypeHash(const DieInfo &info);
+
 	template <class T>
-	T *getTypeInstance(const Dwarf_Die &object, const std::string &dieName);
-	template <class T>
-	T *getRefTypeInstance(const Dwarf_Die &object, const std::string &dieName);
+	T *getTypeInstance(const DieInfo &info, const std::string &dieName);
 
 	uint32_t getFileID();
 
@@ -76,19 +231,154 @@ private:
 	Dwarf_Ptr     errarg;
 
 	uint64_t      curCUOffset;
+	uint64_t      curCUBaseAddress;  //!< DW_AT_low_pc of the current CU
 	uint64_t      nextCUOffset;
 
 	SymbolManager *manager;
 
+	/**
+	 * Native decoder of the file, nullptr if libdwarf is used. Shared with
+	 * the workers of a parallel parse.
+	 */
+	std::shared_ptr<const DwarfDecoder> decoder;
+	std::vector<DwarfDecoder::Attribute> attributes;  //!< buffer of getDieInfo
+
+	/**
+	 * Compilation unit of the lazy mode.
+	 */
+	struct Unit {
+		uint64_t offset;      //!< header offset
+		uint64_t dieOffset;   //!< offset of the DW_TAG_compile_unit DIE
+		uint64_t baseAddress;
+	};
+
+	/**
+	 * Top level DIE by the hash of its name.
+	 */
+	struct NameIndexEntry {
+		uint64_t hash;
+		uint64_t offset;
+		bool unit;  //!< offset is a unit header, its top level DIEs are searched
+	};
+
+	std::vector<Unit> units;               //!< sorted by offset
+	std::vector<NameIndexEntry> nameIndex; //!< sorted by hash
+	std::unordered_set<uint64_t> loadedDies;
+	std::unordered_set<std::string> loadedNames;
+	unsigned int loadDepth;  //!< > 0 while creating symbols on demand
+
+	/**
+	 * Type hashes by DIE offset of the current compilation unit.
+	 */
+	std::unordered_map<uint64_t, uint64_t> typeHashes;
+
+	/**
+	 * A type DIE that getTypeHash() has read but not hashed yet.
+	 */
+	struct TypeNode {
+		uint64_t hash;  //!< Of its own attributes and those of its children
+		std::vector<uint64_t> references;  //!< DIEs they refer to, in order
+		uint64_t index;    //!< Order of the visit
+		uint64_t lowLink;  //!< Smallest index of a type reachable from it
+	};
+	std::unordered_map<uint64_t, TypeNode> typeNodes;  //!< by DIE offset
+	std::vector<uint64_t> typeNodeStack;
+	uint64_t typeNodeIndex;
+
+	uint64_t getTypeHash(uint64_t offset);
+	void visitTypeNode(uint64_t offset);
+	void hashComponent(const std::vector<uint64_t> &component);
+	bool readTypeNode(uint64_t offset, TypeNode &node);
+	bool readNativeTypeNode(uint64_t offset, TypeNode &node);
+	void hashDie(const Dwarf_Die &die, TypeNode &node);
+	void hashDie(Dwarf_Half tag,
+	             const std::vector<DwarfDecoder::Attribute> &attributes,
+	             TypeNode &node);
+	uint64_t hashAttribute(const Dwarf_Attribute &attr, TypeNode &node);
+	uint64_t hashAttribute(const DwarfDecoder::Attribute &attr,
+	                       TypeNode &node);
+	bool getAttributeNumber(const Dwarf_Attribute &attr, uint64_t &result);
+	bool getAttributeNumber(const DwarfDecoder::Attribute &attr,
+	                        uint64_t &result);
+	DieInfo getDieInfo(DwarfDecoder::Die &die);
+	bool isMergedType(Symbol *sym, uint64_t offset);
+
+	void buildNameIndex();
+	bool readNameTables();
+	void findUnitDies(uint64_t offset, const std::string &name,
+	                  std::vector<uint64_t> &offsets);
+	Symbol *loadDie(const Dwarf_Die &die, uint64_t offset);
+	bool isDieLoaded(const Dwarf_Die &die);
+
+	/**
+	 * Worker parser sharing the file id of the parser it was created for.
+	 */
+	DwarfParser(int fd, SymbolManager *manager, uint32_t fileID);
+
+	/**
+	 * @return Header offsets of all compilation units, followed by the
+	 * end of the .debug_info section.
+	 */
+	std::vector<uint64_t> getCUOffsets();
+
 	void read_cu_list();
+	void read_cu_range(uint64_t begin, uint64_t end);
+	void read_cu_list_parallel(unsigned int threads);
+
+	/**
+	 * A file of a parallel parse.
+	 */
+	struct ParallelFile {
+		std::string filename;  //!< opened by the workers if fd is -1
+		int fd;                //!< duplicated by the workers
+		uint32_t fileID;
+		bool native;           //!< workers create their own decoder
+		std::shared_ptr<const DwarfDecoder> decoder;  //!< shared by the workers
+		std::shared_ptr<const DwarfDecoder> skeleton; //!< of a split DWARF file
+		std::vector<uint64_t> offsets;  //!< see getCUOffsets()
+	};
+	static void read_files_parallel(const std::vector<ParallelFile> &files,
+	                                SymbolManager *manager,
+	                                unsigned int threads);
+	static void parseFile(int fd, const std::string &filename,
+	                      SymbolManager *mgr, unsigned int threads,
+	                      bool native);
+	static std::vector<ParallelFile> getParallelFiles(
+		const std::string &filename, SymbolManager *mgr, uint32_t fileID,
+		bool native);
+	static std::shared_ptr<const DwarfDecoder> getDecoder(int fd, bool native);
+	static std::vector<ParallelFile> getSplitFiles(
+		const std::string &filename,
+		const std::shared_ptr<const DwarfDecoder> &decoder,
+		SymbolManager *mgr);
+	/**
+	 * Create the symbols of in_die, its siblings and their children.
+	 * @param merged parent is a type merged into an existing one, its
+	 * members, enumerators and subranges are skipped.
+	 */
 	void get_die_and_siblings(const Dwarf_Die &in_die,
 	                          Symbol *parent, int in_level,
-	                          Srcfilesdata sf);
+	                          Srcfilesdata sf, bool merged=false);
 	void print_die_data(const Dwarf_Die &print_me,
 	                    int level, Srcfilesdata sf);
-	Symbol *initSymbolFromDie(const Dwarf_Die &cur_die,
+	void print_die_data(const DieInfo &info, int level, Srcfilesdata sf);
+	Symbol *initSymbolFromDie(const DieInfo &info,
 	                          Symbol *parent, int level,
 	                          Srcfilesdata sf);
+
+	/**
+	 * Native counterpart of read_cu_range().
+	 */
+	void read_units_native(uint64_t begin, uint64_t end);
+
+	/**
+	 * Native counterpart of get_die_and_siblings().
+	 * @return Offset after the null entry that ends the siblings.
+	 */
+	uint64_t get_die_and_siblings_native(const DwarfDecoder::Unit &unit,
+	                                     uint64_t offset, Symbol *parent,
+	                                     int level, Srcfilesdata sf,
+	                                     bool merged=false);
 };
 
 #endif  /* _DWARFPARSER_H_ */
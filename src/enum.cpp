@@ -6,23 +6,42 @@
 #include "dwarfparser.h"
 #include "dwarfexception.h"
 #include "helpers.h"
+#include "symboldatabase.h"
 
 
 Enum::Enum(SymbolManager *mgr,
            DwarfParser *parser,
-           const Dwarf_Die &object,
+           const DieInfo &info,
            const std::string &name)
 	:
-	BaseType(mgr, parser, object, name) {}
+	BaseType(mgr, parser, info, name) {
+	this->kind = SymbolKind::Enum;
+}
+
+Enum::Enum(SymbolManager *mgr,
+           const DatabaseSymbol &record,
+           const DatabaseReader &db)
+	:
+	BaseType(mgr, record, db) {
+
+	this->kind = SymbolKind::Enum;
+
+	uint64_t count;
+	const DatabaseEnum *values = db.getSection<DatabaseEnum>(SECTION_ENUMS,
+	                                                         &count);
+	for (uint32_t i = record.first; i < record.first + record.count; i++) {
+		this->enumValues[values[i].value] = db.getString(values[i].name);
+	}
+}
 
 Enum::~Enum() {}
 
 void Enum::addEnum(SymbolManager * /*mgr*/,
                    DwarfParser *parser,
-                   const Dwarf_Die &object,
+                   const DieInfo &info,
                    const std::string &name) {
 	// TODO get ENUM Value
-	uint32_t enumValue = parser->getDieAttributeNumber(object, DW_AT_const_value);
+	uint32_t enumValue = info.constValue;
 
 	this->enumMutex.lock();
 	this->enumValues[enumValue] = name;
@@ -53,6 +72,21 @@ void Enum::printEnumMembers(std::ostream &stream) {
 	}
 }
 
+void Enum::store(DatabaseSymbol &record, DatabaseWriter &db) const {
+	BaseType::store(record, db);
+	record.kind  = (uint8_t)DatabaseKind::Enum;
+	record.first = 0;
+	record.count = this->enumValues.size();
+	bool first = true;
+	for (auto &it : this->enumValues) {
+		uint32_t index = db.addEnum(it.first, it.second);
+		if (first) {
+			record.first = index;
+			first = false;
+		}
+	}
+}
+
 void Enum::print() const {
 	BaseType::print();
 }
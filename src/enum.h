@@ -10,16 +10,23 @@ typedef std::map<uint32_t, std::string> EnumValues;
 class Enum : public BaseType {
 public:
 	Enum(SymbolManager *mgr, DwarfParser *parser,
-	     const Dwarf_Die &object, const std::string &name);
+	     const DieInfo &info, const std::string &name);
+	Enum(SymbolManager *mgr, const DatabaseSymbol &record,
+	     const DatabaseReader &db);
 	virtual ~Enum();
 
+	static bool classof(const Symbol *sym) {
+		return sym->getKind() == SymbolKind::Enum;
+	}
+
 	void addEnum(SymbolManager *mgr,
 	             DwarfParser *parser,
-	             const Dwarf_Die &object,
+	             const DieInfo &info,
 	             const std::string &name);
 	std::string enumName(uint32_t value);
 	uint32_t enumValue(const std::string &name);
 	void printEnumMembers(std::ostream &stream);
+	void store(DatabaseSymbol &record, DatabaseWriter &db) const override;
 	void print() const override;
 
 private:
@@ -0,0 +1,190 @@
+#include "fieldpath.h"
+
+#include <cctype>
+#include <cstdlib>
+
+#include "array.h"
+#include "dwarfexception.h"
+#include "pointer.h"
+#include "structured.h"
+#include "structuredmember.h"
+
+/**
+ * Skip typedefs and const qualifiers.
+ */
+static BaseType *stripQualifiers(BaseType *bt) {
+	RefBaseType *rbt;
+	while ((rbt = kind_cast<RefBaseType>(bt)) &&
+	       !kind_cast<Pointer>(rbt) && rbt->getType()) {
+		bt = rbt->getBaseType();
+	}
+	return bt;
+}
+
+/**
+ * Find a member by name, looking into anonymous struct and union members.
+ * @param offset receives the offset of the member in structured
+ */
+static StructuredMember *findMember(Structured *structured,
+                                    const std::string &name,
+                                    uint64_t *offset) {
+	StructuredMember *member = structured->memberByName(name);
+	if (member) {
+		*offset = member->getMemberLocation();
+		return member;
+	}
+	for (auto &anon : structured->getMembers()) {
+		if (!anon->getName().empty()) {
+			continue;
+		}
+		Structured *inner = kind_cast<Structured>(
+			stripQualifiers(anon->getBaseType()));
+		if (inner && (member = findMember(inner, name, offset))) {
+			*offset += anon->getMemberLocation();
+			return member;
+		}
+	}
+	return nullptr;
+}
+
+static DwarfException pathError(const std::string &path, size_t pos,
+                                const std::string &reason) {
+	std::string msg = "Invalid field path \"" + path + "\" at " +
+	                  std::to_string(pos) + ": " + reason;
+	return DwarfException(msg.c_str());
+}
+
+FieldPath::FieldPath(BaseType *root, const std::string &path)
+	:
+	root{root},
+	type{root},
+	path{path} {
+
+	uint64_t offset = 0;
+	size_t pos = 0;
+	bool first = true;
+
+	// replace the pointer type by its target, starting a new offset
+	auto dereference = [&](size_t at) {
+		Pointer *ptr = kind_cast<Pointer>(stripQualifiers(this->type));
+		if (!ptr || kind_cast<Array>(ptr)) {
+			throw pathError(path, at, "not a pointer");
+		}
+		if (!ptr->getType()) {
+			throw pathError(path, at, "dereferencing void pointer");
+		}
+		this->offsets.push_back(offset);
+		offset     = 0;
+		this->type = ptr->getBaseType();
+	};
+
+	while (pos < path.size()) {
+		size_t start = pos;
+		bool member  = false;
+		bool arrow   = false;
+
+		if (path[pos] == '.') {
+			member = true;
+			pos++;
+		} else if (path.compare(pos, 2, "->") == 0) {
+			member = arrow = true;
+			pos += 2;
+		} else if (path[pos] == '[') {
+			size_t end = path.find(']', pos);
+			if (end == std::string::npos) {
+				throw pathError(path, start, "missing ]");
+			}
+			std::string number = path.substr(pos + 1, end - pos - 1);
+			char *numberEnd;
+			uint64_t index = strtoull(number.c_str(), &numberEnd, 0);
+			if (number.empty() || *numberEnd) {
+				throw pathError(path, start, "invalid index");
+			}
+			pos = end + 1;
+
+			Array *array = kind_cast<Array>(stripQualifiers(this->type));
+			BaseType *elem;
+			if (array) {
+				elem = array->getBaseType();
+			} else {
+				dereference(start);
+				elem = this->type;
+			}
+			offset    += index * elem->getByteSize();
+			this->type = elem;
+			first      = false;
+			continue;
+		} else if (first) {
+			member = true;
+		} else {
+			throw pathError(path, start, "expected ., -> or [");
+		}
+		first = false;
+
+		size_t end = pos;
+		while (end < path.size() &&
+		       (isalnum((unsigned char)path[end]) || path[end] == '_')) {
+			end++;
+		}
+		if (end == pos) {
+			throw pathError(path, pos, "expected member name");
+		}
+		std::string name = path.substr(pos, end - pos);
+
+		BaseType *bt = stripQualifiers(this->type);
+		if (arrow || (member && kind_cast<Pointer>(bt) && !kind_cast<Array>(bt))) {
+			dereference(start);
+			bt = stripQualifiers(this->type);
+		}
+		Structured *structured = kind_cast<Structured>(bt);
+		if (!structured) {
+			throw pathError(path, pos, "not a struct or union");
+		}
+		uint64_t memberOffset;
+		StructuredMember *sm = findMember(structured, name, &memberOffset);
+		if (!sm) {
+			throw pathError(path, pos, "no member " + name);
+		}
+		offset    += memberOffset;
+		this->type = sm->getBaseType();
+		pos = end;
+	}
+	this->offsets.push_back(offset);
+}
+
+FieldPath::~FieldPath() {}
+
+uint64_t FieldPath::resolve(uint64_t address,
+                            const PointerReader &readPointer) const {
+	for (size_t i = 0; i + 1 < this->offsets.size(); i++) {
+		address = readPointer(address + this->offsets[i]);
+	}
+	return address + this->offsets.back();
+}
+
+uint64_t FieldPath::resolve(uint64_t address) const {
+	if (this->offsets.size() > 1) {
+		throw DwarfException("Field path needs memory access to dereference");
+	}
+	return address + this->offsets.back();
+}
+
+BaseType *FieldPath::getRootType() const {
+	return this->root;
+}
+
+BaseType *FieldPath::getType() const {
+	return this->type;
+}
+
+const std::string &FieldPath::getPath() const {
+	return this->path;
+}
+
+const std::vector<uint64_t> &FieldPath::getOffsets() const {
+	return this->offsets;
+}
+
+size_t FieldPath::getDereferenceCount() const {
+	return this->offsets.size() - 1;
+}
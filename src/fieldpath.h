@@ -0,0 +1,77 @@
+#ifndef _FIELDPATH_H_
+#define _FIELDPATH_H_
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+class BaseType;
+
+/**
+ * A member access path that is resolved against a type once and can then
+ * be applied to any number of objects of that type.
+ *
+ * Syntax: members are separated by "." or "->", array elements are
+ * selected with "[n]", e.g. "mm->pgd" or "files.fdt.fd[3]".
+ * "." follows a pointer if the left hand side is one, "->" requires a
+ * pointer. "[n]" indexes arrays in place and pointers after dereferencing
+ * them. Members of anonymous structs and unions are found by their name.
+ *
+ * The compiled path is a list of offsets separated by pointer
+ * dereferences, so applying it needs no symbol lookups.
+ */
+class FieldPath {
+public:
+	/**
+	 * Compile path for objects of type root.
+	 * Throws a DwarfException if path does not match the type.
+	 */
+	FieldPath(BaseType *root, const std::string &path);
+	virtual ~FieldPath();
+
+	/**
+	 * Reads a pointer from target memory.
+	 */
+	typedef std::function<uint64_t(uint64_t)> PointerReader;
+
+	/**
+	 * @return Address of the field for the root object at address.
+	 * readPointer is called at every dereference in the path.
+	 */
+	uint64_t resolve(uint64_t address, const PointerReader &readPointer) const;
+
+	/**
+	 * @return Address of the field for the root object at address.
+	 * Throws a DwarfException if the path contains dereferences.
+	 */
+	uint64_t resolve(uint64_t address) const;
+
+	BaseType *getRootType() const;
+
+	/**
+	 * @return Type of the field the path leads to.
+	 */
+	BaseType *getType() const;
+
+	const std::string &getPath() const;
+
+	/**
+	 * @return Offsets that are added to the address in turn, with a pointer
+	 * dereference between two consecutive offsets.
+	 */
+	const std::vector<uint64_t> &getOffsets() const;
+
+	/**
+	 * @return Number of pointer dereferences in the path.
+	 */
+	size_t getDereferenceCount() const;
+
+private:
+	BaseType *root;
+	BaseType *type;
+	std::string path;
+	std::vector<uint64_t> offsets;
+};
+
+#endif /* _FIELDPATH_H_ */
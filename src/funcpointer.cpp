@@ -1,10 +1,27 @@
 #include "funcpointer.h"
 
+#include "symboldatabase.h"
+
 FuncPointer::FuncPointer(SymbolManager *mgr,
                          DwarfParser *parser,
-                         const Dwarf_Die &object,
+                         const DieInfo &info,
                          const std::string &name)
 	:
-	RefBaseType(mgr, parser, object, name) {}
+	RefBaseType(mgr, parser, info, name) {
+	this->kind = SymbolKind::FuncPointer;
+}
+
+FuncPointer::FuncPointer(SymbolManager *mgr,
+                         const DatabaseSymbol &record,
+                         const DatabaseReader &db)
+	:
+	RefBaseType(mgr, record, db) {
+	this->kind = SymbolKind::FuncPointer;
+}
 
 FuncPointer::~FuncPointer() {}
+
+void FuncPointer::store(DatabaseSymbol &record, DatabaseWriter &db) const {
+	RefBaseType::store(record, db);
+	record.kind = (uint8_t)DatabaseKind::FuncPointer;
+}
@@ -7,9 +7,18 @@ class FuncPointer : public RefBaseType {
 public:
 	FuncPointer(SymbolManager *mgr,
 	            DwarfParser *parser,
-	            const Dwarf_Die &object,
+	            const DieInfo &info,
 	            const std::string &name);
+	FuncPointer(SymbolManager *mgr,
+	            const DatabaseSymbol &record,
+	            const DatabaseReader &db);
 	virtual ~FuncPointer();
+
+	static bool classof(const Symbol *sym) {
+		return sym->getKind() == SymbolKind::FuncPointer;
+	}
+
+	void store(DatabaseSymbol &record, DatabaseWriter &db) const override;
 };
 
 #endif /* _FUNCPOINTER_H_ */
@@ -3,38 +3,71 @@
 #include <algorithm>
 
 #include "dwarfparser.h"
+#include "symboldatabase.h"
 #include "symbolmanager.h"
 #include "pointer.h"
 
 Function::Function(SymbolManager *mgr,
                    DwarfParser *parser,
-                   const Dwarf_Die &object,
+                   const DieInfo &info,
                    const std::string &name)
 	:
-	Symbol(mgr, parser, object, name),
+	Symbol(mgr, parser, info, name),
 	rettype(0),
 	address(0),
 	paramsFinal(false) {
 
-	this->update(parser, object);
+	this->kind = SymbolKind::Function;
+	this->update(parser, info);
 
 	this->manager->addFunction(this);
 	this->paramsFinal = false;
 }
 
+Function::Function(SymbolManager *mgr,
+                   const DatabaseSymbol &record,
+                   const DatabaseReader &db)
+	:
+	Symbol(mgr, record, db),
+	rettype(record.type),
+	address(record.value),
+	paramsFinal(record.flags & SYMBOL_FLAG_PARAMS_FINAL) {
+
+	this->kind = SymbolKind::Function;
+
+	uint64_t count;
+	const DatabaseRange *ranges = db.getSection<DatabaseRange>(SECTION_RANGES,
+	                                                           &count);
+	auto range = std::lower_bound(ranges, ranges + count, record.id,
+	                              [](const DatabaseRange &a, uint64_t id) {
+		return a.id < id;
+	});
+	for (; range != ranges + count && range->id == record.id; range++) {
+		this->ranges.push_back(std::make_pair(range->begin, range->end));
+	}
+
+	const DatabaseParam *params = db.getSection<DatabaseParam>(SECTION_PARAMS,
+	                                                           &count);
+	for (uint32_t i = record.first; i < record.first + record.count; i++) {
+		this->paramList.push_back(
+			std::pair<std::string, uint64_t>(db.getString(params[i].name),
+			                                 params[i].type));
+	}
+}
+
 Function::~Function() {}
 
 void Function::addParam(DwarfParser *parser,
-                        const Dwarf_Die &object) {
+                        const DieInfo &info) {
 	if (this->paramsFinal) {
 		return;
 	}
 
-	if (parser->dieHasAttr(object, DW_AT_type)) {
-		uint64_t dwarfType = parser->getDieAttributeNumber(object, DW_AT_type);
+	if (info.has(DW_AT_type)) {
+		uint64_t dwarfType = info.type;
 		uint32_t fileID    = parser->getFileID();
 		uint64_t paramType = this->manager->getID(dwarfType, fileID);
-		std::string name   = parser->getDieName(object);
+		std::string name   = info.name;
 		if (!paramType) {
 			assert(false);
 		}
@@ -43,17 +76,24 @@ void Function::addParam(DwarfParser *parser,
 }
 
 void Function::update(DwarfParser *parser,
-                      const Dwarf_Die &object) {
-	if (this->rettype == 0 && parser->dieHasAttr(object, DW_AT_type)) {
-		uint64_t dwarfType = parser->getDieAttributeNumber(object, DW_AT_type);
+                      const DieInfo &info) {
+	if (this->rettype == 0 && info.has(DW_AT_type)) {
+		uint64_t dwarfType = info.type;
 		uint32_t fileID    = parser->getFileID();
 		this->rettype = this->manager->getID(dwarfType, fileID);
 		if (!this->rettype) {
 			assert(false);
 		}
 	}
-	if (this->address == 0 && parser->dieHasAttr(object, DW_AT_low_pc)) {
-		this->address = parser->getDieAttributeNumber(object, DW_AT_low_pc);
+	if (this->address == 0 && info.has(DW_AT_low_pc)) {
+		this->address = info.lowPC;
+	}
+	if (this->ranges.empty()) {
+		this->ranges = parser->getDieRanges(info);
+		if (this->address == 0 && !this->ranges.empty()) {
+			// the first range holds the entry point
+			this->address = this->ranges[0].first;
+		}
 	}
 	this->paramsFinal = true; // < why??
 }
@@ -106,10 +146,34 @@ void Function::updateTypes() {
 }
 
 
+void Function::store(DatabaseSymbol &record, DatabaseWriter &db) const {
+	Symbol::store(record, db);
+	record.kind  = (uint8_t)DatabaseKind::Function;
+	record.type  = this->rettype;
+	record.value = this->address;
+	record.flags = this->paramsFinal ? SYMBOL_FLAG_PARAMS_FINAL : 0;
+	record.first = 0;
+	record.count = this->paramList.size();
+	for (auto &range : this->ranges) {
+		db.addRange(this->id, range.first, range.second);
+	}
+	for (size_t i = 0; i < this->paramList.size(); i++) {
+		uint32_t index = db.addParam(this->paramList[i].first,
+		                             this->paramList[i].second);
+		if (i == 0) {
+			record.first = index;
+		}
+	}
+}
+
 void Function::print() const {
 	Symbol::print();
 	std::cout << "\t Address:      " << std::hex << this->address << std::dec
 	          << std::endl;
+	for (auto &range : this->ranges) {
+		std::cout << "\t Range:        " << std::hex << range.first << " - "
+		          << range.second << std::dec << std::endl;
+	}
 	for (auto &param : this->paramList) {
 		std::cout << "\t Param:        " << std::hex << param.second << std::dec
 		          << std::endl;
@@ -120,6 +184,31 @@ uint64_t Function::getAddress() {
 	return this->address;
 }
 
+const Function::RangeList &Function::getRanges() const {
+	return this->ranges;
+}
+
+bool Function::containsAddress(uint64_t address) const {
+	for (auto &range : this->ranges) {
+		if (address >= range.first && address < range.second) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void Function::adoptRanges(const Function *other) {
+	for (auto &range : other->ranges) {
+		if (std::find(this->ranges.begin(), this->ranges.end(), range) ==
+		    this->ranges.end()) {
+			this->ranges.push_back(range);
+		}
+	}
+	if (this->address == 0) {
+		this->address = other->address;
+	}
+}
+
 
 std::vector<std::pair<std::string,uint64_t>> Function::getParamList() const {
 	return paramList;
@@ -7,21 +7,46 @@
 
 class Function : public Symbol {
 public:
+	/**
+	 * [begin, end) address ranges of the code of a function. A function
+	 * with hot and cold parts has several.
+	 */
+	typedef std::vector<std::pair<uint64_t, uint64_t>> RangeList;
+
 	Function(SymbolManager *mgr,
 	         DwarfParser *parser,
-	         const Dwarf_Die &object,
+	         const DieInfo &info,
 	         const std::string &name);
+	Function(SymbolManager *mgr,
+	         const DatabaseSymbol &record,
+	         const DatabaseReader &db);
 	virtual ~Function();
 
+	static bool classof(const Symbol *sym) {
+		return sym->getKind() == SymbolKind::Function;
+	}
+
 	void addParam(DwarfParser *parser,
-	              const Dwarf_Die &object);
+	              const DieInfo &info);
 
 	bool operator <(const Function &func) const;
 	bool operator ==(const Function &func) const;
-	void update(DwarfParser *parser, const Dwarf_Die &object);
+	void update(DwarfParser *parser, const DieInfo &info);
+	void store(DatabaseSymbol &record, DatabaseWriter &db) const override;
 	void print() const override;
 
 	uint64_t getAddress();
+	const RangeList &getRanges() const;
+
+	/**
+	 * @return true if address is in one of the ranges of the function.
+	 */
+	bool containsAddress(uint64_t address) const;
+
+	/**
+	 * Add the ranges of a duplicate of this function.
+	 */
+	void adoptRanges(const Function *other);
 
 	void updateTypes();
 
@@ -34,6 +59,7 @@ public:
 protected:
 	uint64_t rettype;
 	uint64_t address;
+	RangeList ranges;
 
 	// Map might also work, however I assume that a list is faster for <10 entries
 	typedef std::vector<std::pair<std::string, uint64_t>> ParamList;
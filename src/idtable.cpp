@@ -0,0 +1,103 @@
+#include "idtable.h"
+
+#include <algorithm>
+
+#include "dwarfexception.h"
+
+static std::atomic<uint64_t> nextSerial{0};
+
+/**
+ * Last file looked up by this thread. A parser thread works on one file
+ * at a time, so this almost always spares the lookup.
+ */
+struct FileIndexCache {
+	uint64_t serial;
+	uint32_t fileID;
+	uint32_t index;
+};
+
+static thread_local FileIndexCache fileIndexCache = {0, 0, 0};
+
+IDTable::IDTable()
+	:
+	files{nullptr},
+	indices{nullptr},
+	count{0},
+	serial{++nextSerial} {}
+
+IDTable::~IDTable() {}
+
+void IDTable::store(std::atomic<Array *> &array, uint32_t i, uint32_t value) {
+	Array *entries = array.load(std::memory_order_relaxed);
+	if (!entries || i >= entries->size) {
+		// copy to a larger array, readers may still use the old one
+		uint64_t oldSize = entries ? entries->size : 0;
+		std::unique_ptr<Array> grown{new Array};
+		grown->size = std::max<uint64_t>({(uint64_t)i + 1, oldSize * 2, 16});
+		// value initialized, all entries are 0
+		grown->entries.reset(new std::atomic<uint32_t>[grown->size]());
+		for (uint64_t j = 0; j < oldSize; j++) {
+			grown->entries[j].store(entries->entries[j].load(std::memory_order_relaxed),
+			                        std::memory_order_relaxed);
+		}
+		entries = grown.get();
+		this->arrays.push_back(std::move(grown));
+		array.store(entries, std::memory_order_release);
+	}
+	entries->entries[i].store(value, std::memory_order_release);
+}
+
+uint32_t IDTable::getFileIndex(uint32_t fileID) {
+	FileIndexCache &cache = fileIndexCache;
+	if (cache.serial == this->serial && cache.fileID == fileID) {
+		return cache.index;
+	}
+
+	uint32_t index = load(this->indices, fileID);
+	if (!index) {
+		std::lock_guard<std::mutex> lock(this->mutex);
+		index = load(this->indices, fileID);
+		if (!index) {
+			uint32_t count = this->count.load(std::memory_order_relaxed);
+			if (count == maxFiles) {
+				throw DwarfException("Too many files in one SymbolManager");
+			}
+			this->store(this->files, count, fileID);
+			this->count.store(count + 1, std::memory_order_release);
+			index = count + 1;
+			this->store(this->indices, fileID, index);
+		}
+	}
+
+	cache = FileIndexCache{this->serial, fileID, index};
+	return index;
+}
+
+IDTable::DwarfID IDTable::getRevID(uint64_t id) const {
+	uint64_t index = id >> offsetBits;
+	if (index == 0 || index > this->count.load(std::memory_order_acquire)) {
+		return DwarfID(0, 0);
+	}
+	return DwarfID(id & ((1ULL << offsetBits) - 1),
+	               load(this->files, index - 1));
+}
+
+std::vector<uint32_t> IDTable::getFiles() const {
+	std::vector<uint32_t> result;
+	uint32_t count = this->count.load(std::memory_order_acquire);
+	for (uint32_t i = 0; i < count; i++) {
+		result.push_back(load(this->files, i));
+	}
+	return result;
+}
+
+void IDTable::addFile(uint32_t index, uint32_t fileID) {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	uint32_t count = this->count.load(std::memory_order_relaxed);
+	if (index != count + 1 || count == maxFiles || load(this->indices, fileID)) {
+		throw DwarfException("Invalid file index");
+	}
+	this->store(this->files, count, fileID);
+	this->count.store(count + 1, std::memory_order_release);
+	this->store(this->indices, fileID, index);
+}
@@ -0,0 +1,126 @@
+#ifndef _IDTABLE_H_
+#define _IDTABLE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "dwarfexception.h"
+
+/**
+ * Mapping between the (dwarf offset, file id) pairs of DIEs and the ids
+ * of a SymbolManager, in both directions.
+ *
+ * Ids are computed, not stored: every file that is seen gets a small
+ * index in this table, and the id of a DIE is the index in the upper
+ * bits and the offset of the DIE in the lower bits. Both directions are
+ * a few shifts plus one array access: the index of a file is looked up
+ * in an array indexed by the file id, which is a process wide counter
+ * (see DwarfParser::newFileID()).
+ */
+class IDTable {
+public:
+	typedef std::pair<uint64_t, uint32_t> DwarfID;
+
+	/**
+	 * Number of id bits for the DIE offset.
+	 */
+	static const unsigned offsetBits = 40;
+
+	/**
+	 * Maximum number of files in one table.
+	 */
+	static const uint32_t maxFiles = 65535;
+
+	IDTable();
+	virtual ~IDTable();
+
+	IDTable(const IDTable &other) = delete;
+	IDTable &operator =(const IDTable &other) = delete;
+
+	/**
+	 * @return The id of the DIE. Throws a DwarfException if dwarfID does
+	 * not fit in offsetBits.
+	 */
+	uint64_t getID(uint64_t dwarfID, uint32_t fileID);
+
+	/**
+	 * @return The DIE of id, (0, 0) if id does not belong to this table.
+	 */
+	DwarfID getRevID(uint64_t id) const;
+
+	/**
+	 * @return Index of fileID in this table, fileID is added if it is
+	 * not yet known. Indices start at 1, so no id is 0. Throws a
+	 * DwarfException if fileID would be file maxFiles + 1.
+	 */
+	uint32_t getFileIndex(uint32_t fileID);
+
+	/**
+	 * @return The file ids in order of their index.
+	 */
+	std::vector<uint32_t> getFiles() const;
+
+	/**
+	 * Add fileID with the given index to an empty table, used to restore
+	 * the ids of a symbol database. Files must be added in index order.
+	 */
+	void addFile(uint32_t index, uint32_t fileID);
+
+private:
+	/**
+	 * Array of atomic entries. It is replaced by a larger copy to write
+	 * beyond its end, the old one stays allocated for concurrent readers.
+	 */
+	struct Array {
+		uint64_t size;
+		std::unique_ptr<std::atomic<uint32_t>[]> entries;
+	};
+
+	/**
+	 * @return Entry i of array, 0 if it is beyond the end.
+	 */
+	static inline uint32_t load(const std::atomic<Array *> &array, uint32_t i);
+
+	/**
+	 * Write entry i of array, the mutex must be held.
+	 */
+	void store(std::atomic<Array *> &array, uint32_t i, uint32_t value);
+
+	/**
+	 * Entry i is the file id of index i + 1, written before count is
+	 * increased. Entry fileID of indices is the index of fileID, written
+	 * after count is increased, 0 for unknown files. So readers need no
+	 * lock.
+	 */
+	std::atomic<Array *> files;
+	std::atomic<Array *> indices;
+	std::vector<std::unique_ptr<Array>> arrays;
+	std::atomic<uint32_t> count;
+	std::mutex mutex;
+
+	/**
+	 * Distinguishes tables in the per thread cache of getFileIndex().
+	 */
+	const uint64_t serial;
+};
+
+inline uint32_t IDTable::load(const std::atomic<Array *> &array, uint32_t i) {
+	Array *entries = array.load(std::memory_order_acquire);
+	if (!entries || i >= entries->size) {
+		return 0;
+	}
+	return entries->entries[i].load(std::memory_order_acquire);
+}
+
+inline uint64_t IDTable::getID(uint64_t dwarfID, uint32_t fileID) {
+	if (dwarfID >> offsetBits) {
+		throw DwarfException("DIE offset out of range");
+	}
+	return ((uint64_t)this->getFileIndex(fileID) << offsetBits) | dwarfID;
+}
+
+#endif /* _IDTABLE_H_ */
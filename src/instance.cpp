@@ -5,8 +5,11 @@
 
 #include "array.h"
 #include "consttype.h"
+#include "fieldpath.h"
+#include "funcpointer.h"
 #include "helpers.h"
-//#include "libvmiwrapper/vmiinstance.h"
+#include "memoryreader.h"
+#include "pointer.h"
 #include "structured.h"
 #include "structuredmember.h"
 #include "symbolmanager.h"
@@ -15,7 +18,8 @@ Instance::Instance()
 	:
 	parent{nullptr},
 	type{nullptr},
-	address{0} {}
+	address{0},
+	reader{nullptr} {}
 
 Instance::Instance(BaseType *type,
                    uint64_t va,
@@ -23,7 +27,8 @@ Instance::Instance(BaseType *type,
 	:
 	parent{parent},
 	type{type},
-	address{va} {}
+	address{va},
+	reader{parent ? parent->reader : nullptr} {}
 
 Instance::~Instance() {}
 
@@ -35,7 +40,7 @@ BaseType *Instance::getRealType() const {
 	assert(this->type);
 	BaseType *bt = this->type;
 	RefBaseType *rbt;
-	while ((rbt = dynamic_cast<RefBaseType *>(bt))) {
+	while ((rbt = kind_cast<RefBaseType>(bt))) {
 		assert(rbt->getBaseType());
 		bt = rbt->getBaseType();
 	}
@@ -50,8 +55,23 @@ void Instance::setAddress(uint64_t address) {
 	this->address = address;
 }
 
+void Instance::setMemoryReader(MemoryReader *reader) {
+	this->reader = reader;
+}
+
+MemoryReader *Instance::getMemoryReader() const {
+	return this->reader;
+}
+
+MemoryReader *Instance::getReader() const {
+	if (!this->reader) {
+		throw DwarfException("Instance is not bound to a MemoryReader");
+	}
+	return this->reader;
+}
+
 uint64_t Instance::getLength() const {
-	Array *array = dynamic_cast<Array *>(this->type);
+	Array *array = kind_cast<Array>(this->type);
 	if (!array) {
 		return 1;
 	}
@@ -72,7 +92,7 @@ Instance Instance::changeBaseType(const std::string &newType,
 	BaseType *newBT     = this->type;
 
 	if (this->type->getName() == "list_head") {
-		Structured *structured = dynamic_cast<Structured *>(structModule);
+		Structured *structured = kind_cast<Structured>(structModule);
 		assert(structured);
 		StructuredMember *sm = structured->memberByName(fieldname);
 		assert(sm);
@@ -88,10 +108,10 @@ Instance Instance::memberByName(const std::string &name,
 	uint64_t newAddress;
 	assert(address);
 	BaseType *bt = this->type;
-	while (dynamic_cast<RefBaseType *>(bt)) {
-		bt = (dynamic_cast<RefBaseType *>(bt))->getBaseType();
+	while (kind_cast<RefBaseType>(bt)) {
+		bt = (kind_cast<RefBaseType>(bt))->getBaseType();
 	}
-	Structured *structured = dynamic_cast<Structured *>(bt);
+	Structured *structured = kind_cast<Structured>(bt);
 	assert(structured);
 	StructuredMember *member = structured->memberByName(name);
 	assert(member);
@@ -100,20 +120,17 @@ Instance Instance::memberByName(const std::string &name,
 
 	newAddress = address + member->getMemberLocation();
 	assert(newAddress);
-	#if 0
 	if (ptr) {
-		VMIInstance *vmi = VMIInstance::getInstance();
 		Pointer *ptr_type;
-		if ((ptr_type = dynamic_cast<Pointer *>(bt))) {
+		if ((ptr_type = kind_cast<Pointer>(bt)) && !kind_cast<Array>(bt)) {
 			bt         = ptr_type->getBaseType();
-			newAddress = vmi->read64FromVA(newAddress);
+			newAddress = this->getReader()->readPointer(newAddress);
 			// Dereferencing NULL Ptr?
 			if (!expectZeroPtr) {
 				assert(newAddress);
 			}
 		}
 	}
-	#endif
 	return Instance(bt, newAddress, this);
 }
 
@@ -122,33 +139,47 @@ Instance Instance::memberByOffset(uint64_t offset, bool ptr) const {
 	if (offset > this->type->getByteSize()) {
 		assert(false);
 	}
-	Structured *structured = dynamic_cast<Structured *>(this->type);
+	Structured *structured = kind_cast<Structured>(this->type);
 	assert(structured);
 	StructuredMember *member = structured->memberByOffset(offset);
 	assert(member);
 	BaseType *bt = member->getBaseType();
 	assert(bt);
 	newAddress = address + member->getMemberLocation();
-	#if 0
 	if (ptr) {
-		VMIInstance *vmi = VMIInstance::getInstance();
 		Pointer *ptr_type;
-		while ((ptr_type = dynamic_cast<Pointer *>(bt))) {
+		while ((ptr_type = kind_cast<Pointer>(bt)) && !kind_cast<Array>(bt) &&
+		       ptr_type->getBaseType()) {
 			bt         = ptr_type->getBaseType();
-			newAddress = vmi->read64FromVA(newAddress);
+			newAddress = this->getReader()->readPointer(newAddress);
 		}
 	}
-	#endif
 	return Instance(bt, newAddress, this);
 }
 
+Instance Instance::memberByPath(const FieldPath &path) const {
+	assert(path.getRootType() == this->type);
+	if (path.getDereferenceCount() == 0) {
+		return Instance(path.getType(), path.resolve(this->address), this);
+	}
+	MemoryReader *reader = this->getReader();
+	uint64_t address = path.resolve(
+		this->address,
+		[reader](uint64_t address) { return reader->readPointer(address); });
+	return Instance(path.getType(), address, this);
+}
+
+Instance Instance::memberByPath(const std::string &path) const {
+	return this->memberByPath(FieldPath(this->type, path));
+}
+
 std::string Instance::memberName(uint64_t offset) const {
 	assert(address);
 	BaseType *bt = this->type;
-	while (dynamic_cast<RefBaseType *>(bt)) {
-		bt = (dynamic_cast<RefBaseType *>(bt))->getBaseType();
+	while (kind_cast<RefBaseType>(bt)) {
+		bt = (kind_cast<RefBaseType>(bt))->getBaseType();
 	}
-	Structured *structured = dynamic_cast<Structured *>(bt);
+	Structured *structured = kind_cast<Structured>(bt);
 	assert(structured);
 	return structured->memberNameByOffset(offset);
 }
@@ -164,7 +195,7 @@ Instance Instance::arrayElem(uint64_t element) const {
 		          << " element " << element << " requested" << std::endl;
 		assert(false);
 	}
-	Array *array = dynamic_cast<Array *>(this->type);
+	Array *array = kind_cast<Array>(this->type);
 	assert(array);
 	BaseType *childType = array->getBaseType();
 	if (!childType->getByteSize()) {
@@ -172,31 +203,74 @@ Instance Instance::arrayElem(uint64_t element) const {
 		          << std::dec << " has no ByteSize" << std::endl;
 	}
 	assert(childType->getByteSize());
+	// the start of a sweep over the array, let a cache read ahead
+	if (element == 0 && this->reader) {
+		this->reader->prefetch(this->address,
+		                       this->getLength() * childType->getByteSize());
+	}
 	return Instance(childType,
 	                this->address + (element * childType->getByteSize()),
 	                this);
 }
 
 uint32_t Instance::memberOffset(const std::string &name) const {
-	Structured *structured = dynamic_cast<Structured *>(this->type);
+	Structured *structured = kind_cast<Structured>(this->type);
 	assert(structured);
 	return structured->memberOffset(name);
 }
 
 Instance Instance::dereference() const {
 	uint64_t newAddress = this->address;
-	//VMIInstance *vmi    = VMIInstance::getInstance(); // TODO deglob
-	//RefBaseType *ptr_type;
+	RefBaseType *ptr_type;
 	BaseType *bt = this->type;
-	#if 0
-	while ((ptr_type = dynamic_cast<RefBaseType *>(bt))) {
-		bt         = ptr_type->getBaseType();
-		newAddress = vmi->read64FromVA(newAddress);
+	while ((ptr_type = kind_cast<RefBaseType>(bt)) &&
+	       !kind_cast<FuncPointer>(bt) && ptr_type->getBaseType()) {
+		if (kind_cast<Pointer>(bt) && !kind_cast<Array>(bt)) {
+			newAddress = this->getReader()->readPointer(newAddress);
+		}
+		bt = ptr_type->getBaseType();
 	}
-	#endif
 	return Instance(bt, newAddress, this);
 }
 
+std::string Instance::getBytes() const {
+	std::string bytes(this->size(), '\0');
+	this->getReader()->readExact(this->address, &bytes[0], bytes.size());
+	return bytes;
+}
+
+std::vector<std::string> Instance::readBatch(const std::vector<Instance> &instances) {
+	std::vector<std::string> result(instances.size());
+	std::vector<bool> done(instances.size(), false);
+
+	for (size_t i = 0; i < instances.size(); i++) {
+		if (done[i]) {
+			continue;
+		}
+		// one batch for all instances sharing the reader of instance i
+		MemoryReader *reader = instances[i].getReader();
+		std::vector<MemoryRequest> requests;
+		for (size_t j = i; j < instances.size(); j++) {
+			if (done[j] || instances[j].reader != reader) {
+				continue;
+			}
+			result[j].resize(instances[j].size());
+			requests.push_back(MemoryRequest{instances[j].address, &result[j][0],
+			                                 result[j].size(), 0});
+			done[j] = true;
+		}
+		reader->readBatch(requests);
+		for (size_t k = 0; k < requests.size(); k++) {
+			if (requests[k].result != requests[k].length) {
+				std::string msg = "Unable to read memory at " +
+				                  std::to_string(requests[k].address);
+				throw DwarfException(msg.c_str());
+			}
+		}
+	}
+	return result;
+}
+
 bool Instance::operator ==(const Instance &instance) const {
 	if (this->type != instance.type)
 		return false;
@@ -4,6 +4,11 @@
 #include "basetype.h"
 #include "refbasetype.h"
 
+#include <string>
+#include <vector>
+
+class FieldPath;
+class MemoryReader;
 class SymbolManager;
 
 class Instance {
@@ -18,6 +23,13 @@ public:
 	BaseType *getRealType() const;
 	uint64_t getAddress() const;
 	void     setAddress(uint64_t address);
+
+	/**
+	 * Bind this Instance to the memory its values are read from.
+	 * Instances derived from this one use the same reader.
+	 */
+	void setMemoryReader(MemoryReader *reader);
+	MemoryReader *getMemoryReader() const;
 	uint64_t getLength() const;
 	bool isNULL() const;
 
@@ -25,25 +37,55 @@ public:
 	                        const std::string &fieldname="list") const;
 
 	Instance arrayElem(uint64_t element) const;
+	/**
+	 * If ptr is set and the member is a pointer, it is dereferenced.
+	 */
 	Instance memberByName(const std::string &name,
 	                      bool ptr=false,
 	                      bool expectZeroPtr=false) const;
 	Instance memberByOffset(uint64_t offset, bool ptr=false) const;
 
+	/**
+	 * @return Instance of the field path leads to. The type of this
+	 * Instance must be the root type of path. Pointers in the path are
+	 * read through the MemoryReader of this Instance.
+	 */
+	Instance memberByPath(const FieldPath &path) const;
+
+	/**
+	 * Compile path for the type of this Instance and apply it.
+	 * @see FieldPath
+	 */
+	Instance memberByPath(const std::string &path) const;
+
 	std::string memberName(uint64_t offset) const;
 
 	uint32_t size() const;
 
 	uint32_t memberOffset(const std::string &name) const;
+
+	/**
+	 * Follow pointers (skipping typedefs and const) until a type that is
+	 * not a pointer is reached.
+	 */
 	Instance dereference() const;
 
-	#if 0
 	template <typename T>
 	inline T getValue() const;
 
 	template <typename T>
 	inline T getRawValue(bool dereference=true) const;
-	#endif
+
+	/**
+	 * @return The memory of this Instance in a single read.
+	 */
+	std::string getBytes() const;
+
+	/**
+	 * Read the memory of all instances with one batch per MemoryReader.
+	 * @return The bytes of each instance, in the order of instances.
+	 */
+	static std::vector<std::string> readBatch(const std::vector<Instance> &instances);
 
 	bool operator ==(const Instance &instance) const;
 	bool operator !=(const Instance &instance) const;
@@ -53,15 +95,20 @@ public:
 
 private:
 	const Instance *parent;
+	/**
+	 * @return The bound MemoryReader, throws a DwarfException if there is none.
+	 */
+	MemoryReader *getReader() const;
+
 	BaseType *type;
 	uint64_t address;
+	MemoryReader *reader;
 };
 
-#if 0
 template <typename T>
 inline T Instance::getValue() const{
 	assert(address);
-	return this->getRealType()->getValue<T>(this->address);
+	return this->getRealType()->getValue<T>(this->getReader(), this->address);
 }
 
 template <typename T>
@@ -69,12 +116,11 @@ inline T Instance::getRawValue(bool dereference) const {
 	assert(address);
 	assert(type);
 	if (typeid(T) != typeid(std::string) && dereference &&
-	    dynamic_cast<RefBaseType *>(this->type)) {
+	    kind_cast<RefBaseType>(this->type)) {
 		Instance i = this->dereference();
-		return i.getRawValue<T>(i.address);
+		return i.getRawValue<T>(false);
 	}
-	return this->type->getRawValue<T>(this->address);
+	return this->type->getRawValue<T>(this->getReader(), this->address);
 }
-#endif
 
 #endif /* _INSTANCE_H_ */
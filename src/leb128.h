@@ -0,0 +1,132 @@
+#ifndef _LEB128_H_
+#define _LEB128_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+/*
+ * LEB128 decoding a machine word at a time. A value of up to 8 bytes
+ * (56 bits) is found and decoded from a single 64 bit load without a
+ * loop over its bytes, only longer values and values within 8 bytes of
+ * the end of the data take the bytewise path.
+ */
+
+/**
+ * Bit 7 of every byte of a word, the continuation bits of LEB128.
+ */
+const uint64_t leb128ContinuationBits = 0x8080808080808080ULL;
+
+/**
+ * @return The 8 bytes at pos in little endian order.
+ */
+inline uint64_t loadLEB128Word(const uint8_t *pos) {
+	uint64_t word;
+	memcpy(&word, pos, sizeof(word));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+	word = __builtin_bswap64(word);
+#endif
+	return word;
+}
+
+/**
+ * Concatenate the low 7 bits of the first length bytes of word.
+ */
+inline uint64_t compactLEB128Word(uint64_t word, unsigned length) {
+	if (length < 8) {
+		word &= (1ULL << (length * 8)) - 1;
+	}
+	word &= ~leb128ContinuationBits;
+	word = (word & 0x00ff00ff00ff00ffULL) | ((word & 0xff00ff00ff00ff00ULL) >> 1);
+	word = (word & 0x0000ffff0000ffffULL) | ((word & 0xffff0000ffff0000ULL) >> 2);
+	word = (word & 0x00000000ffffffffULL) | ((word & 0xffffffff00000000ULL) >> 4);
+	return word;
+}
+
+/**
+ * Bytewise decoding of the ULEB128 value at pos, bits beyond 64 are
+ * dropped.
+ * @return Number of bytes read, 0 if the value is not terminated before end.
+ */
+inline size_t decodeULEB128Bytewise(const uint8_t *pos, const uint8_t *end,
+                                    uint64_t &value) {
+	value = 0;
+	for (size_t i = 0; pos + i < end; i++) {
+		uint8_t byte = pos[i];
+		if (i * 7 < 64) {
+			value |= (uint64_t)(byte & 0x7f) << (i * 7);
+		}
+		if (!(byte & 0x80)) {
+			return i + 1;
+		}
+	}
+	return 0;
+}
+
+/**
+ * Decode the ULEB128 value at pos.
+ * @return Number of bytes read, 0 if the value is not terminated before end.
+ */
+inline size_t decodeULEB128(const uint8_t *pos, const uint8_t *end,
+                            uint64_t &value) {
+	// most values fit into a single byte
+	if (pos < end && !(*pos & 0x80)) {
+		value = *pos;
+		return 1;
+	}
+	if (end - pos >= 8) {
+		uint64_t word = loadLEB128Word(pos);
+		uint64_t stops = ~word & leb128ContinuationBits;
+		if (stops) {
+			unsigned length = (__builtin_ctzll(stops) >> 3) + 1;
+			value = compactLEB128Word(word, length);
+			return length;
+		}
+	}
+	return decodeULEB128Bytewise(pos, end, value);
+}
+
+/**
+ * Decode the SLEB128 value at pos.
+ * @return Number of bytes read, 0 if the value is not terminated before end.
+ */
+inline size_t decodeSLEB128(const uint8_t *pos, const uint8_t *end,
+                            int64_t &value) {
+	uint64_t bits;
+	size_t length = decodeULEB128(pos, end, bits);
+	if (length && length * 7 < 64 && (pos[length - 1] & 0x40)) {
+		bits |= ~0ULL << (length * 7);
+	}
+	value = (int64_t)bits;
+	return length;
+}
+
+/**
+ * Skip count LEB128 values, signed or unsigned, by counting the bytes
+ * that end a value.
+ * @return The position after the last value, nullptr if it is not
+ * terminated before end.
+ */
+inline const uint8_t *skipLEB128(const uint8_t *pos, const uint8_t *end,
+                                 size_t count) {
+	while (count && end - pos >= 8) {
+		uint64_t stops = ~loadLEB128Word(pos) & leb128ContinuationBits;
+		size_t found = __builtin_popcountll(stops);
+		if (found >= count) {
+			for (; count > 1; count--) {
+				stops &= stops - 1;
+			}
+			return pos + (__builtin_ctzll(stops) >> 3) + 1;
+		}
+		count -= found;
+		pos += 8;
+	}
+	for (; count && pos < end; pos++) {
+		if (!(*pos & 0x80)) {
+			count--;
+		}
+	}
+	return count ? nullptr : pos;
+}
+
+#endif /* _LEB128_H_ */
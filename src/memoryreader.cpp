@@ -0,0 +1,477 @@
+#include "memoryreader.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <gelf.h>
+#include <libelf.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "dwarfexception.h"
+
+/**
+ * Upper limit for the size of a merged read in readBatch().
+ */
+static const size_t maxBatchSpan = 1024 * 1024;
+
+MemoryReader::MemoryReader()
+	:
+	pointerSize{sizeof(uint64_t)},
+	batchGap{256} {}
+
+MemoryReader::~MemoryReader() {}
+
+void MemoryReader::readBatch(std::vector<MemoryRequest> &requests) {
+	std::vector<MemoryRequest *> sorted;
+	sorted.reserve(requests.size());
+	for (auto &request : requests) {
+		request.result = 0;
+		if (request.length) {
+			sorted.push_back(&request);
+		}
+	}
+	std::sort(sorted.begin(), sorted.end(),
+	          [](const MemoryRequest *a, const MemoryRequest *b) {
+		          return a->address < b->address;
+	          });
+
+	std::vector<char> span;
+	size_t i = 0;
+	while (i < sorted.size()) {
+		uint64_t start = sorted[i]->address;
+		uint64_t end   = start + sorted[i]->length;
+		size_t last    = i + 1;
+		while (last < sorted.size() &&
+		       sorted[last]->address <= end + this->batchGap &&
+		       sorted[last]->address + sorted[last]->length - start <=
+		       maxBatchSpan) {
+			end = std::max(end, sorted[last]->address + sorted[last]->length);
+			last++;
+		}
+
+		if (last == i + 1) {
+			sorted[i]->result = this->read(start, sorted[i]->buffer,
+			                               sorted[i]->length);
+			i = last;
+			continue;
+		}
+
+		span.resize(end - start);
+		size_t got = this->read(start, span.data(), span.size());
+		for (; i < last; i++) {
+			MemoryRequest *request = sorted[i];
+			uint64_t offset = request->address - start;
+			if (offset + request->length <= got) {
+				memcpy(request->buffer, span.data() + offset, request->length);
+				request->result = request->length;
+			} else {
+				// the span has a hole, the request may still be readable
+				request->result = this->read(request->address,
+				                             request->buffer,
+				                             request->length);
+			}
+		}
+	}
+}
+
+void MemoryReader::prefetch(uint64_t /*address*/, size_t /*length*/) {}
+
+void MemoryReader::readExact(uint64_t address, void *buffer, size_t length) {
+	if (this->read(address, buffer, length) != length) {
+		std::string msg = "Unable to read memory at " + std::to_string(address);
+		throw DwarfException(msg.c_str());
+	}
+}
+
+uint64_t MemoryReader::readUnsigned(uint64_t address, size_t size) {
+	if (size == 0 || size > sizeof(uint64_t)) {
+		throw DwarfException("Invalid integer size");
+	}
+	uint64_t value = 0;
+	this->readExact(address, &value, size);
+	return value;
+}
+
+int64_t MemoryReader::readSigned(uint64_t address, size_t size) {
+	uint64_t value = this->readUnsigned(address, size);
+	unsigned shift = 64 - size * 8;
+	return (int64_t)(value << shift) >> shift;
+}
+
+uint64_t MemoryReader::readPointer(uint64_t address) {
+	return this->readUnsigned(address, this->pointerSize);
+}
+
+std::string MemoryReader::readString(uint64_t address, size_t maxLength) {
+	std::string str;
+	char chunk[64];
+	while (str.size() < maxLength) {
+		size_t length = std::min(sizeof(chunk), maxLength - str.size());
+		size_t got = this->read(address + str.size(), chunk, length);
+		const char *end = (const char *)memchr(chunk, '\0', got);
+		if (end) {
+			str.append(chunk, end - chunk);
+			return str;
+		}
+		str.append(chunk, got);
+		if (got < length) {
+			break;
+		}
+	}
+	return str;
+}
+
+size_t MemoryReader::getPointerSize() const {
+	return this->pointerSize;
+}
+
+void MemoryReader::setPointerSize(size_t pointerSize) {
+	if (pointerSize == 0 || pointerSize > sizeof(uint64_t)) {
+		throw DwarfException("Invalid pointer size");
+	}
+	this->pointerSize = pointerSize;
+}
+
+void MemoryReader::setBatchGap(size_t gap) {
+	this->batchGap = gap;
+}
+
+
+FileMemoryReader::FileMemoryReader(const std::string &filename, uint64_t base)
+	:
+	fd{-1},
+	fileSize{0},
+	base{base} {
+
+	this->fd = open(filename.c_str(), O_RDONLY);
+	struct stat st;
+	if (this->fd < 0 || fstat(this->fd, &st) != 0) {
+		if (this->fd >= 0) {
+			close(this->fd);
+		}
+		throw DwarfException("Unable to open memory image");
+	}
+	this->fileSize = st.st_size;
+}
+
+FileMemoryReader::~FileMemoryReader() {
+	close(this->fd);
+}
+
+size_t FileMemoryReader::readFile(uint64_t offset, void *buffer, size_t length) {
+	if (offset >= this->fileSize) {
+		return 0;
+	}
+	length = std::min<uint64_t>(length, this->fileSize - offset);
+	size_t done = 0;
+	while (done < length) {
+		ssize_t got = pread(this->fd, (char *)buffer + done, length - done,
+		                    offset + done);
+		if (got <= 0) {
+			break;
+		}
+		done += got;
+	}
+	return done;
+}
+
+size_t FileMemoryReader::read(uint64_t address, void *buffer, size_t length) {
+	if (address < this->base) {
+		return 0;
+	}
+	return this->readFile(address - this->base, buffer, length);
+}
+
+
+ElfCoreMemoryReader::ElfCoreMemoryReader(const std::string &filename)
+	:
+	FileMemoryReader{filename} {
+
+	elf_version(EV_CURRENT);
+	Elf *elf = elf_begin(this->fd, ELF_C_READ, nullptr);
+	GElf_Ehdr ehdr;
+	size_t count;
+	if (!elf || !gelf_getehdr(elf, &ehdr) || ehdr.e_type != ET_CORE ||
+	    elf_getphdrnum(elf, &count) != 0) {
+		if (elf) {
+			elf_end(elf);
+		}
+		// the fd is closed by the destructor of FileMemoryReader
+		throw DwarfException("Not an ELF core file");
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		GElf_Phdr phdr;
+		if (!gelf_getphdr(elf, i, &phdr) || phdr.p_type != PT_LOAD ||
+		    phdr.p_memsz == 0) {
+			continue;
+		}
+		this->segments.push_back(Segment{phdr.p_vaddr, phdr.p_memsz,
+		                                 phdr.p_offset, phdr.p_filesz});
+	}
+	this->pointerSize = (gelf_getclass(elf) == ELFCLASS32) ? 4 : 8;
+	elf_end(elf);
+
+	std::sort(this->segments.begin(), this->segments.end(),
+	          [](const Segment &a, const Segment &b) {
+		          return a.address < b.address;
+	          });
+}
+
+ElfCoreMemoryReader::~ElfCoreMemoryReader() {}
+
+size_t ElfCoreMemoryReader::read(uint64_t address, void *buffer,
+                                 size_t length) {
+	size_t done = 0;
+	while (done < length) {
+		uint64_t current = address + done;
+		// last segment starting at or before current
+		auto it = std::upper_bound(
+			this->segments.begin(), this->segments.end(), current,
+			[](uint64_t address, const Segment &s) { return address < s.address; });
+		if (it == this->segments.begin()) {
+			break;
+		}
+		const Segment &segment = *(it - 1);
+		uint64_t offset = current - segment.address;
+		if (offset >= segment.memSize) {
+			break;
+		}
+		size_t chunk = std::min<uint64_t>(length - done, segment.memSize - offset);
+		char *out = (char *)buffer + done;
+		size_t fromFile = 0;
+		if (offset < segment.fileSize) {
+			fromFile = std::min<uint64_t>(chunk, segment.fileSize - offset);
+			size_t got = this->readFile(segment.offset + offset, out, fromFile);
+			if (got < fromFile) {
+				return done + got;
+			}
+		}
+		memset(out + fromFile, 0, chunk - fromFile);
+		done += chunk;
+	}
+	return done;
+}
+
+
+BufferMemoryReader::BufferMemoryReader(const void *data, size_t size,
+                                       uint64_t base)
+	:
+	data{(const char *)data},
+	size{size},
+	base{base} {}
+
+BufferMemoryReader::~BufferMemoryReader() {}
+
+size_t BufferMemoryReader::read(uint64_t address, void *buffer, size_t length) {
+	if (address < this->base || address - this->base >= this->size) {
+		return 0;
+	}
+	uint64_t offset = address - this->base;
+	length = std::min<uint64_t>(length, this->size - offset);
+	memcpy(buffer, this->data + offset, length);
+	return length;
+}
+
+void BufferMemoryReader::readBatch(std::vector<MemoryRequest> &requests) {
+	// nothing to merge, every read is a memcpy
+	for (auto &request : requests) {
+		request.result = this->read(request.address, request.buffer,
+		                            request.length);
+	}
+}
+
+
+CachedMemoryReader::CachedMemoryReader(MemoryReader *backend,
+                                       size_t capacity,
+                                       size_t pageSize)
+	:
+	backend{backend},
+	capacity{std::max<size_t>(capacity, 1)},
+	pageSize{pageSize},
+	readAhead{8},
+	lastMiss{UINT64_MAX},
+	hits{0},
+	misses{0} {
+
+	if (pageSize == 0) {
+		throw DwarfException("Invalid page size");
+	}
+	this->pointerSize = backend->getPointerSize();
+}
+
+CachedMemoryReader::~CachedMemoryReader() {}
+
+CachedMemoryReader::Page *CachedMemoryReader::findPage(uint64_t number) {
+	auto it = this->pageMap.find(number);
+	if (it == this->pageMap.end()) {
+		return nullptr;
+	}
+	this->hits++;
+	this->pages.splice(this->pages.begin(), this->pages, it->second);
+	return &*it->second;
+}
+
+void CachedMemoryReader::loadPages(const std::vector<uint64_t> &numbers) {
+	PageList loaded;
+	std::vector<MemoryRequest> requests;
+	requests.reserve(numbers.size());
+	for (uint64_t number : numbers) {
+		loaded.push_back(Page{number, std::vector<char>(this->pageSize), 0});
+		requests.push_back(MemoryRequest{number * this->pageSize,
+		                                 loaded.back().data.data(),
+		                                 this->pageSize, 0});
+	}
+	this->backend->readBatch(requests);
+
+	auto request = requests.begin();
+	for (auto it = loaded.begin(); it != loaded.end(); ++it, ++request) {
+		it->valid = request->result;
+		this->pageMap[it->number] = it;
+	}
+	this->pages.splice(this->pages.begin(), loaded);
+	this->evict();
+}
+
+CachedMemoryReader::Page *CachedMemoryReader::getPage(uint64_t number) {
+	Page *page = this->findPage(number);
+	if (page) {
+		return page;
+	}
+	this->misses++;
+
+	std::vector<uint64_t> numbers{number};
+	if (this->readAhead && number == this->lastMiss + 1) {
+		size_t count = std::min(this->readAhead, this->capacity - 1);
+		for (uint64_t next = number + 1;
+		     next <= number + count && !this->pageMap.count(next); next++) {
+			numbers.push_back(next);
+		}
+	}
+	this->lastMiss = numbers.back();
+	this->loadPages(numbers);
+	return &*this->pageMap[number];
+}
+
+size_t CachedMemoryReader::readCached(uint64_t address, void *buffer,
+                                      size_t length) {
+	size_t done = 0;
+	while (done < length) {
+		uint64_t current = address + done;
+		uint64_t offset  = current % this->pageSize;
+		Page *page = this->getPage(current / this->pageSize);
+		size_t chunk = std::min<uint64_t>(length - done,
+		                                  this->pageSize - offset);
+		size_t available = page->valid > offset ? page->valid - offset : 0;
+		memcpy((char *)buffer + done, page->data.data() + offset,
+		       std::min(chunk, available));
+		if (available < chunk) {
+			return done + available;
+		}
+		done += chunk;
+	}
+	return done;
+}
+
+size_t CachedMemoryReader::read(uint64_t address, void *buffer, size_t length) {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	return this->readCached(address, buffer, length);
+}
+
+void CachedMemoryReader::readBatch(std::vector<MemoryRequest> &requests) {
+	std::lock_guard<std::mutex> lock(this->mutex);
+
+	std::vector<uint64_t> missing;
+	for (auto &request : requests) {
+		if (!request.length) {
+			continue;
+		}
+		uint64_t first = request.address / this->pageSize;
+		uint64_t last  = (request.address + request.length - 1) / this->pageSize;
+		for (uint64_t number = first; number <= last; number++) {
+			if (!this->pageMap.count(number)) {
+				missing.push_back(number);
+			}
+		}
+	}
+	std::sort(missing.begin(), missing.end());
+	missing.erase(std::unique(missing.begin(), missing.end()), missing.end());
+
+	// a batch larger than the cache would evict its own pages
+	if (!missing.empty() && missing.size() <= this->capacity) {
+		this->misses += missing.size();
+		this->loadPages(missing);
+	}
+	for (auto &request : requests) {
+		request.result = this->readCached(request.address, request.buffer,
+		                                  request.length);
+	}
+}
+
+void CachedMemoryReader::prefetch(uint64_t address, size_t length) {
+	if (!length) {
+		return;
+	}
+	std::lock_guard<std::mutex> lock(this->mutex);
+
+	uint64_t first = address / this->pageSize;
+	uint64_t last  = (address + length - 1) / this->pageSize;
+	size_t count   = std::min(this->readAhead, this->capacity - 1);
+	std::vector<uint64_t> missing;
+	for (uint64_t number = first; number <= last && number - first < count;
+	     number++) {
+		if (!this->pageMap.count(number)) {
+			missing.push_back(number);
+		}
+	}
+	if (!missing.empty()) {
+		this->loadPages(missing);
+	}
+}
+
+void CachedMemoryReader::evict() {
+	while (this->pages.size() > this->capacity) {
+		this->pageMap.erase(this->pages.back().number);
+		this->pages.pop_back();
+	}
+}
+
+void CachedMemoryReader::setCapacity(size_t capacity) {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	this->capacity = std::max<size_t>(capacity, 1);
+	this->evict();
+}
+
+size_t CachedMemoryReader::getCapacity() const {
+	return this->capacity;
+}
+
+void CachedMemoryReader::setReadAhead(size_t pages) {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	this->readAhead = pages;
+}
+
+size_t CachedMemoryReader::getPageSize() const {
+	return this->pageSize;
+}
+
+void CachedMemoryReader::invalidate() {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	this->pages.clear();
+	this->pageMap.clear();
+	this->lastMiss = UINT64_MAX;
+}
+
+uint64_t CachedMemoryReader::getHits() const {
+	return this->hits;
+}
+
+uint64_t CachedMemoryReader::getMisses() const {
+	return this->misses;
+}
+
+void CachedMemoryReader::resetStatistics() {
+	this->hits   = 0;
+	this->misses = 0;
+}
@@ -0,0 +1,261 @@
+#ifndef _MEMORYREADER_H_
+#define _MEMORYREADER_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * One read of a batch, see MemoryReader::readBatch().
+ */
+struct MemoryRequest {
+	uint64_t address;
+	void *buffer;
+	size_t length;
+	size_t result; ///< Number of bytes read, set by the reader.
+};
+
+/**
+ * Source of target memory for Instance values.
+ *
+ * Addresses are the virtual addresses of the analyzed binary. A reader
+ * returns fewer bytes than requested if the memory behind an address
+ * is not available. All values are read in host byte order.
+ */
+class MemoryReader {
+public:
+	MemoryReader();
+	virtual ~MemoryReader();
+
+	MemoryReader(const MemoryReader &other) = delete;
+	MemoryReader &operator =(const MemoryReader &other) = delete;
+
+	/**
+	 * Read up to length bytes at address into buffer.
+	 * @return Number of bytes read.
+	 */
+	virtual size_t read(uint64_t address, void *buffer, size_t length) = 0;
+
+	/**
+	 * Read all requests and set their result.
+	 *
+	 * Requests that are close to each other are merged into a single
+	 * read(), so a batch costs one access per contiguous area instead
+	 * of one per request.
+	 */
+	virtual void readBatch(std::vector<MemoryRequest> &requests);
+
+	/**
+	 * Hint that length bytes at address will be read soon.
+	 * The default implementation does nothing.
+	 */
+	virtual void prefetch(uint64_t address, size_t length);
+
+	/**
+	 * Read length bytes at address.
+	 * Throws a DwarfException if the memory is not available.
+	 */
+	void readExact(uint64_t address, void *buffer, size_t length);
+
+	template <typename T>
+	inline T readValue(uint64_t address);
+
+	/**
+	 * Read a size byte integer and zero extend it.
+	 */
+	uint64_t readUnsigned(uint64_t address, size_t size);
+
+	/**
+	 * Read a size byte integer and sign extend it.
+	 */
+	int64_t readSigned(uint64_t address, size_t size);
+
+	uint64_t readPointer(uint64_t address);
+
+	/**
+	 * Read a NUL terminated string of at most maxLength characters.
+	 */
+	std::string readString(uint64_t address, size_t maxLength=4096);
+
+	size_t getPointerSize() const;
+	void setPointerSize(size_t pointerSize);
+
+	/**
+	 * Requests that are at most gap bytes apart are merged by readBatch().
+	 */
+	void setBatchGap(size_t gap);
+
+protected:
+	size_t pointerSize;
+	size_t batchGap;
+};
+
+template <typename T>
+inline T MemoryReader::readValue(uint64_t address) {
+	T value;
+	this->readExact(address, &value, sizeof(T));
+	return value;
+}
+
+/**
+ * Raw memory image in a file, e.g. a physical memory dump. The byte at
+ * file offset 0 has the address base.
+ */
+class FileMemoryReader : public MemoryReader {
+public:
+	FileMemoryReader(const std::string &filename, uint64_t base=0);
+	virtual ~FileMemoryReader();
+
+	size_t read(uint64_t address, void *buffer, size_t length) override;
+
+protected:
+	/**
+	 * Read up to length bytes at offset of the file.
+	 */
+	size_t readFile(uint64_t offset, void *buffer, size_t length);
+
+	int fd;
+	uint64_t fileSize;
+	uint64_t base;
+};
+
+/**
+ * ELF core file, memory is looked up in its PT_LOAD segments.
+ * Segment memory that is not backed by the file reads as zeros.
+ */
+class ElfCoreMemoryReader : public FileMemoryReader {
+public:
+	ElfCoreMemoryReader(const std::string &filename);
+	virtual ~ElfCoreMemoryReader();
+
+	size_t read(uint64_t address, void *buffer, size_t length) override;
+
+private:
+	struct Segment {
+		uint64_t address;
+		uint64_t memSize;
+		uint64_t offset;
+		uint64_t fileSize;
+	};
+
+	std::vector<Segment> segments; ///< Sorted by address.
+};
+
+/**
+ * Memory in a buffer of this process, which is not copied and must
+ * outlive the reader. The first byte of data has the address base.
+ */
+class BufferMemoryReader : public MemoryReader {
+public:
+	BufferMemoryReader(const void *data, size_t size, uint64_t base=0);
+	virtual ~BufferMemoryReader();
+
+	size_t read(uint64_t address, void *buffer, size_t length) override;
+	void readBatch(std::vector<MemoryRequest> &requests) override;
+
+private:
+	const char *data;
+	size_t size;
+	uint64_t base;
+};
+
+/**
+ * Page cache in front of another MemoryReader.
+ *
+ * Memory is read from the backend in pages, which are kept in LRU order
+ * up to a fixed number of pages. A miss on the page following the last
+ * miss is treated as a sequential sweep and the next pages are read
+ * along with it. The backend must outlive the cache and is not used
+ * directly by anyone else while the cache is in use.
+ */
+class CachedMemoryReader : public MemoryReader {
+public:
+	CachedMemoryReader(MemoryReader *backend,
+	                   size_t capacity=1024,
+	                   size_t pageSize=4096);
+	virtual ~CachedMemoryReader();
+
+	size_t read(uint64_t address, void *buffer, size_t length) override;
+
+	/**
+	 * Load all pages missing for requests in a single batch of the
+	 * backend, then serve the requests from the cache.
+	 */
+	void readBatch(std::vector<MemoryRequest> &requests) override;
+
+	/**
+	 * Load the missing pages of the area, at most readAhead pages.
+	 */
+	void prefetch(uint64_t address, size_t length) override;
+
+	/**
+	 * @param capacity Maximum number of cached pages.
+	 */
+	void setCapacity(size_t capacity);
+	size_t getCapacity() const;
+
+	/**
+	 * @param pages Number of pages read ahead on a sequential miss,
+	 * 0 disables read-ahead.
+	 */
+	void setReadAhead(size_t pages);
+	size_t getPageSize() const;
+
+	/**
+	 * Drop all cached pages, e.g. after the target memory changed.
+	 */
+	void invalidate();
+
+	uint64_t getHits() const;
+	uint64_t getMisses() const;
+	void resetStatistics();
+
+private:
+	struct Page {
+		uint64_t number;
+		std::vector<char> data;
+		size_t valid; ///< Number of bytes the backend returned.
+	};
+	typedef std::list<Page> PageList;
+
+	/**
+	 * @return The cached page, nullptr if it is not cached.
+	 * Counts a hit and moves the page to the front.
+	 */
+	Page *findPage(uint64_t number);
+
+	/**
+	 * Read the pages from the backend in one batch and cache them.
+	 */
+	void loadPages(const std::vector<uint64_t> &numbers);
+
+	/**
+	 * @return Page number, loaded with its read-ahead on a miss.
+	 */
+	Page *getPage(uint64_t number);
+
+	/**
+	 * read() with the mutex held.
+	 */
+	size_t readCached(uint64_t address, void *buffer, size_t length);
+
+	void evict();
+
+	MemoryReader *backend;
+	size_t capacity;
+	size_t pageSize;
+	size_t readAhead;
+	PageList pages; ///< Most recently used first.
+	std::unordered_map<uint64_t, PageList::iterator> pageMap;
+	uint64_t lastMiss; ///< Last page loaded because of a miss.
+	std::atomic<uint64_t> hits;
+	std::atomic<uint64_t> misses;
+	std::mutex mutex;
+};
+
+#endif /* _MEMORYREADER_H_ */
@@ -1,17 +1,33 @@
 #include "pointer.h"
 
+#include "symboldatabase.h"
+
 Pointer::Pointer(SymbolManager *mgr,
                  DwarfParser *parser,
-                 const Dwarf_Die &object,
+                 const DieInfo &info,
                  const std::string &name)
 	:
-	RefBaseType(mgr, parser, object, name) {
+	RefBaseType(mgr, parser, info, name) {
 
+	this->kind = SymbolKind::Pointer;
 	this->byteSize = 8;
 }
 
+Pointer::Pointer(SymbolManager *mgr,
+                 const DatabaseSymbol &record,
+                 const DatabaseReader &db)
+	:
+	RefBaseType(mgr, record, db) {
+	this->kind = SymbolKind::Pointer;
+}
+
 Pointer::~Pointer() {}
 
+void Pointer::store(DatabaseSymbol &record, DatabaseWriter &db) const {
+	RefBaseType::store(record, db);
+	record.kind = (uint8_t)DatabaseKind::Pointer;
+}
+
 void Pointer::print() const {
 	RefBaseType::print();
 	std::cout << "\t Pointer Size  " << this->byteSize << std::endl;
@@ -7,10 +7,20 @@ class Pointer : public RefBaseType {
 public:
 	Pointer(SymbolManager *mgr,
 	        DwarfParser *parser,
-	        const Dwarf_Die &object,
+	        const DieInfo &info,
 	        const std::string &name);
+	Pointer(SymbolManager *mgr,
+	        const DatabaseSymbol &record,
+	        const DatabaseReader &db);
 	virtual ~Pointer();
 
+	static bool classof(const Symbol *sym) {
+		return sym->getKind() >= SymbolKind::Pointer &&
+		       sym->getKind() <= SymbolKind::Array;
+	}
+
+	void store(DatabaseSymbol &record, DatabaseWriter &db) const override;
+
 	void print() const override;
 };
 
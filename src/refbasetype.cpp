@@ -3,6 +3,7 @@
 #include <cassert>
 
 #include "dwarfparser.h"
+#include "symboldatabase.h"
 #include "symbolmanager.h"
 
 #include "helpers.h"
@@ -10,15 +11,15 @@
 
 RefBaseType::RefBaseType(SymbolManager *mgr,
                          DwarfParser *parser,
-                         const Dwarf_Die &object,
+                         const DieInfo &info,
                          const std::string &name)
 	:
-	BaseType(mgr, parser, object, name),
+	BaseType(mgr, parser, info, name),
 	type(0),
 	base(nullptr) {
 
-	if (parser->dieHasAttr(object, DW_AT_type)) {
-		uint64_t dwarfType = parser->getDieAttributeNumber(object, DW_AT_type);
+	if (info.has(DW_AT_type)) {
+		uint64_t dwarfType = info.type;
 		uint32_t fileID    = parser->getFileID();
 		this->type = this->manager->getID(dwarfType, fileID);
 		if (!this->type) {
@@ -29,6 +30,14 @@ RefBaseType::RefBaseType(SymbolManager *mgr,
 	this->manager->addRefBaseType(this);
 }
 
+RefBaseType::RefBaseType(SymbolManager *mgr,
+                         const DatabaseSymbol &record,
+                         const DatabaseReader &db)
+	:
+	BaseType(mgr, record, db),
+	type(record.type),
+	base(nullptr) {}
+
 RefBaseType::~RefBaseType() {}
 
 BaseType *RefBaseType::getBaseType() {
@@ -53,6 +62,11 @@ uint32_t RefBaseType::getByteSize() {
 	return base->getByteSize();
 }
 
+void RefBaseType::store(DatabaseSymbol &record, DatabaseWriter &db) const {
+	BaseType::store(record, db);
+	record.type = this->type;
+}
+
 void RefBaseType::print() const {
 	BaseType::print();
 	std::cout << "\t Ref Type      " << std::hex
@@ -7,12 +7,21 @@ class RefBaseType : public BaseType {
 public:
 	RefBaseType(SymbolManager *mgr,
 	            DwarfParser *parser,
-	            const Dwarf_Die &object,
+	            const DieInfo &info,
 	            const std::string &name);
+	RefBaseType(SymbolManager *mgr,
+	            const DatabaseSymbol &record,
+	            const DatabaseReader &db);
 	virtual ~RefBaseType();
 
+	static bool classof(const Symbol *sym) {
+		return sym->getKind() >= SymbolKind::Typedef &&
+		       sym->getKind() <= SymbolKind::Array;
+	}
+
 	/* overloaded class functions */
 	virtual uint32_t getByteSize() override;
+	virtual void store(DatabaseSymbol &record, DatabaseWriter &db) const override;
 	virtual void print() const override;
 
 	/**
@@ -3,16 +3,19 @@
 #include <cassert>
 #include <iostream>
 
+#include "symboldatabase.h"
 #include "symbolmanager.h"
 
 ReferencingType::ReferencingType(SymbolManager *mgr,
                                  DwarfParser *parser,
-                                 const Dwarf_Die &object)
+                                 const DieInfo &info)
 	:
+	type{0},
+	base{nullptr},
 	manager{mgr} {
 
-	if (parser->dieHasAttr(object, DW_AT_type)) {
-		uint64_t dwarfType = parser->getDieAttributeNumber(object, DW_AT_type);
+	if (info.has(DW_AT_type)) {
+		uint64_t dwarfType = info.type;
 		uint32_t fileID    = parser->getFileID();
 		this->type = this->manager->getID(dwarfType, fileID);
 		if (!this->type)
@@ -20,6 +23,13 @@ ReferencingType::ReferencingType(SymbolManager *mgr,
 	}
 }
 
+ReferencingType::ReferencingType(SymbolManager *mgr,
+                                 const DatabaseSymbol &record)
+	:
+	type{record.type},
+	base{nullptr},
+	manager{mgr} {}
+
 ReferencingType::~ReferencingType() {}
 
 BaseType *ReferencingType::getBaseType() {
@@ -28,6 +38,10 @@ BaseType *ReferencingType::getBaseType() {
 	return this->base;
 }
 
+uint64_t ReferencingType::getTypeID() const {
+	return this->type;
+}
+
 void ReferencingType::print() const {
 	std::cout << "\t ReferenceType:" << this->type << std::endl;
 }
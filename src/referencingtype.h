@@ -11,18 +11,25 @@ class ReferencingType {
 public:
 	ReferencingType(SymbolManager *mgr,
 	                DwarfParser *parser,
-	                const Dwarf_Die &object);
+	                const DieInfo &info);
+	ReferencingType(SymbolManager *mgr,
+	                const DatabaseSymbol &record);
 	virtual ~ReferencingType();
 
 	BaseType *getBaseType();
 
+	/**
+	 * @return Id of the referenced type, 0 if there is none.
+	 */
+	uint64_t getTypeID() const;
+
 	virtual void print() const;
 
 protected:
 	uint64_t type;
 	BaseType *base;
 
-	SymbolManager *const manager;
+	SymbolManager *manager;
 };
 
 #endif /* _REFERENCINGTYPE_H_ */
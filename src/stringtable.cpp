@@ -0,0 +1,51 @@
+#include "stringtable.h"
+
+#include "dwarfexception.h"
+
+StringTable::StringTable()
+	:
+	frozen{false} {}
+
+StringTable::~StringTable() {}
+
+StringTable::Shard &StringTable::getShard(const std::string &str) {
+	// use the upper bits, the set itself uses the lower ones
+	size_t hash = std::hash<std::string>{}(str);
+	return this->shards[(hash >> 24) % shardCount];
+}
+
+StringHandle StringTable::intern(const std::string &str) {
+	if (this->frozen.load(std::memory_order_acquire)) {
+		StringHandle handle = this->find(str);
+		if (!handle) {
+			throw DwarfException("StringTable is frozen");
+		}
+		return handle;
+	}
+	Shard &shard = this->getShard(str);
+	std::lock_guard<std::mutex> lock(shard.mutex);
+	return &*shard.strings.insert(str).first;
+}
+
+StringHandle StringTable::find(const std::string &str) {
+	Shard &shard = this->getShard(str);
+	std::unique_lock<std::mutex> lock(shard.mutex, std::defer_lock);
+	if (!this->frozen.load(std::memory_order_acquire)) {
+		lock.lock();
+	}
+	auto it = shard.strings.find(str);
+	return it == shard.strings.end() ? nullptr : &*it;
+}
+
+size_t StringTable::size() {
+	size_t result = 0;
+	for (auto &shard : this->shards) {
+		std::lock_guard<std::mutex> lock(shard.mutex);
+		result += shard.strings.size();
+	}
+	return result;
+}
+
+void StringTable::freeze() {
+	this->frozen.store(true, std::memory_order_release);
+}
@@ -0,0 +1,67 @@
+#ifndef _STRINGTABLE_H_
+#define _STRINGTABLE_H_
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+
+/**
+ * Interned string. Two handles of the same StringTable are equal iff the
+ * strings are equal, so they can be compared and hashed as pointers.
+ */
+typedef const std::string *StringHandle;
+
+/**
+ * Set of unique strings shared by all symbols of a SymbolManager.
+ * Handles stay valid for the lifetime of the table.
+ */
+class StringTable {
+public:
+	StringTable();
+	virtual ~StringTable();
+
+	StringTable(const StringTable &other) = delete;
+	StringTable &operator =(const StringTable &other) = delete;
+
+	/**
+	 * @return The handle of str, str is added if it is not yet known.
+	 * Adding to a frozen table throws a DwarfException.
+	 */
+	StringHandle intern(const std::string &str);
+
+	/**
+	 * @return The handle of str or nullptr if str was never interned.
+	 */
+	StringHandle find(const std::string &str);
+
+	/**
+	 * @return Number of unique strings.
+	 */
+	size_t size();
+
+	/**
+	 * Reject new strings from now on. Lookups of a frozen table take no
+	 * lock, as the sets no longer change. No intern() may run concurrently.
+	 */
+	void freeze();
+
+private:
+	static const size_t shardCount = 16;
+
+	/**
+	 * The strings are split by hash so parallel parsers rarely contend.
+	 */
+	struct Shard {
+		std::unordered_set<std::string> strings;
+		std::mutex mutex;
+	};
+
+	Shard &getShard(const std::string &str);
+
+	Shard shards[shardCount];
+	std::atomic<bool> frozen;
+};
+
+#endif /* _STRINGTABLE_H_ */
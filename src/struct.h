@@ -7,9 +7,18 @@ class Struct : public Structured {
 public:
 	Struct(SymbolManager *mgr,
 	       DwarfParser *parser,
-	       const Dwarf_Die &object,
+	       const DieInfo &info,
 	       const std::string &name);
+	Struct(SymbolManager *mgr,
+	       const DatabaseSymbol &record,
+	       const DatabaseReader &db);
 	virtual ~Struct();
+
+	static bool classof(const Symbol *sym) {
+		return sym->getKind() == SymbolKind::Struct;
+	}
+
+	void store(DatabaseSymbol &record, DatabaseWriter &db) const override;
 };
 
 #endif /* _STRUCT_H_ */
@@ -1,22 +1,32 @@
 #include "structured.h"
 
 #include "structuredmember.h"
+#include "symboldatabase.h"
+#include "symbolmanager.h"
 
+#include <algorithm>
 #include <iostream>
-#include <map>
 
 Structured::Structured(SymbolManager *mgr,
                        DwarfParser *parser,
-                       const Dwarf_Die &object,
+                       const DieInfo &info,
                        const std::string &name)
 	:
-	BaseType(mgr, parser, object, name) {}
+	BaseType(mgr, parser, info, name),
+	memberListValid{false} {}
+
+Structured::Structured(SymbolManager *mgr,
+                       const DatabaseSymbol &record,
+                       const DatabaseReader &db)
+	:
+	BaseType(mgr, record, db),
+	memberListValid{false} {}
 
 Structured::~Structured() {}
 
 StructuredMember *Structured::addMember(SymbolManager *mgr,
                                         DwarfParser *parser,
-                                        const Dwarf_Die &object,
+                                        const DieInfo &info,
                                         const std::string &memberName) {
 	StructuredMember *member;
 	//const std::string *name = &memberName;
@@ -37,68 +47,118 @@ StructuredMember *Structured::addMember(SymbolManager *mgr,
 	}
 	//} else {
 	*/
-		member = new StructuredMember(mgr, parser, object, memberName, this);
+		member = new (mgr) StructuredMember(mgr, parser, info, memberName, this);
 		//this->memberNameMap[*name] = member;
-		this->memberNameMap.emplace(memberName, member);
+		this->memberNameMap.emplace(member->getNameHandle(), member);
+		this->memberListValid = false;
 	//}
 	this->memberMutex.unlock();
 	return member;
 }
 
+void Structured::addMember(StructuredMember *member) {
+	std::lock_guard<std::mutex> lock(this->memberMutex);
+	member->setParent(this);
+	this->memberNameMap.emplace(member->getNameHandle(), member);
+	this->memberListValid = false;
+}
+
 StructuredMember *Structured::memberByName(const std::string &name) {
-	auto it = this->memberNameMap.find(name);
+	auto it = this->memberNameMap.find(this->manager->findString(name));
 	return it == this->memberNameMap.end() ? nullptr : it->second;
 }
 
+const std::vector<StructuredMember *> &Structured::getMembers() const {
+	if (this->memberListValid) {
+		return this->memberList;
+	}
+	std::lock_guard<std::mutex> lock(this->memberMutex);
+	if (!this->memberListValid) {
+		this->memberList.clear();
+		this->memberList.reserve(this->memberNameMap.size());
+		for (auto &i : this->memberNameMap) {
+			this->memberList.push_back(i.second);
+		}
+		std::stable_sort(this->memberList.begin(), this->memberList.end(),
+		                 [](StructuredMember *a, StructuredMember *b) {
+			                 return a->getBitPosition() < b->getBitPosition();
+		                 });
+		this->memberListValid = true;
+	}
+	return this->memberList;
+}
+
 void Structured::listMembers() {
-	std::cout << "Members of " << this->name << ": " << std::endl;
-	for (auto &i : this->memberNameMap) {
-		std::cout << i.second->getName() << std::endl;
+	std::cout << "Members of " << *this->name << ": " << std::endl;
+	for (auto &member : this->getMembers()) {
+		std::cout << member->getName() << std::endl;
 	}
 }
 
-StructuredMember *Structured::memberByOffset(uint32_t offset) {
-	StructuredMember *result = nullptr;
-	for (auto &i : this->memberNameMap) {
-		if (i.second->getMemberLocation() == offset)
-			return i.second;
-		if (i.second->getMemberLocation() < offset &&
-		    (!result ||
-		     i.second->getMemberLocation() > result->getMemberLocation())) {
-			result = i.second;
-		}
+/**
+ * @return First member of members at offset or, if there is none, the
+ * first member of the closest offset before it.
+ */
+static StructuredMember *
+findMemberByOffset(const std::vector<StructuredMember *> &members,
+                   uint32_t offset) {
+	auto it = std::lower_bound(members.begin(), members.end(), offset,
+	                           [](StructuredMember *member, uint32_t offset) {
+		                           return member->getMemberLocation() < offset;
+	                           });
+	if (it != members.end() && (*it)->getMemberLocation() == offset) {
+		return *it;
+	}
+	if (it == members.begin()) {
+		return nullptr;
 	}
-	return result;
+	uint32_t previous = (*(it - 1))->getMemberLocation();
+	return *std::lower_bound(members.begin(), it, previous,
+	                         [](StructuredMember *member, uint32_t offset) {
+		                         return member->getMemberLocation() < offset;
+	                         });
+}
+
+StructuredMember *Structured::memberByOffset(uint32_t offset) {
+	return findMemberByOffset(this->getMembers(), offset);
 }
 
 std::string Structured::memberNameByOffset(uint32_t offset) {
-	for (auto &i : this->memberNameMap) {
-		if (i.second->getMemberLocation() == offset) {
-			return i.first;
-		}
+	StructuredMember *member = findMemberByOffset(this->getMembers(), offset);
+	if (member && member->getMemberLocation() == offset) {
+		return member->getName();
 	}
 	return "";
 }
 
 uint32_t Structured::memberOffset(const std::string &member) const {
-	for (auto &i : this->memberNameMap) {
-		if (i.second->getName() == member) {
-			return i.second->getMemberLocation();
-		}
+	auto it = this->memberNameMap.find(this->manager->findString(member));
+	if (it != this->memberNameMap.end()) {
+		return it->second->getMemberLocation();
 	}
 	return -1;
 }
 
-void Structured::print() const {
-	std::map<uint32_t, std::string> localMemberMap;
-	for (auto &i : this->memberNameMap) {
-		localMemberMap[i.second->getMemberLocation()] = i.first;
+void Structured::store(DatabaseSymbol &record, DatabaseWriter &db) const {
+	BaseType::store(record, db);
+	const std::vector<StructuredMember *> &members = this->getMembers();
+	record.first = 0;
+	record.count = members.size();
+	bool first = true;
+	for (auto &member : members) {
+		uint32_t index = db.addMember(member->getID());
+		if (first) {
+			record.first = index;
+			first = false;
+		}
 	}
+}
 
+void Structured::print() const {
 	BaseType::print();
 	std::cout << "\t Members:      " << std::endl;
-	for (auto &i : localMemberMap) {
-		std::cout << "\t\t 0x" << std::hex << i.first << std::dec << "\t"
-		          << i.second << std::endl;
+	for (auto &member : this->getMembers()) {
+		std::cout << "\t\t 0x" << std::hex << member->getMemberLocation()
+		          << std::dec << "\t" << member->getName() << std::endl;
 	}
 }
@@ -3,7 +3,9 @@
 
 #include "basetype.h"
 
+#include <atomic>
 #include <unordered_map>
+#include <vector>
 
 class StructuredMember;
 
@@ -11,17 +13,36 @@ class Structured : public BaseType {
 public:
 	Structured(SymbolManager *mgr,
 	           DwarfParser *parser,
-	           const Dwarf_Die &object,
+	           const DieInfo &info,
 	           const std::string &name);
+	Structured(SymbolManager *mgr,
+	           const DatabaseSymbol &record,
+	           const DatabaseReader &db);
 	virtual ~Structured();
 
+	static bool classof(const Symbol *sym) {
+		return sym->getKind() >= SymbolKind::Struct &&
+		       sym->getKind() <= SymbolKind::Union;
+	}
+
 	/**
 	 * Add a member to this Structured type
 	 */
 	virtual StructuredMember *addMember(SymbolManager *mgr,
 	                                    DwarfParser *parser,
-	                                    const Dwarf_Die &object,
+	                                    const DieInfo &info,
 	                                    const std::string &memberName);
+
+	/**
+	 * Add an already constructed member to this Structured type
+	 */
+	void addMember(StructuredMember *member);
+
+	/**
+	 * @return All members in layout order.
+	 */
+	const std::vector<StructuredMember *> &getMembers() const;
+
 	/**
 	 * @return Pointer to Member of Structured Type by member name
 	 */
@@ -47,12 +68,20 @@ public:
 	 */
 	uint32_t memberOffset(const std::string &member) const;
 
+	virtual void store(DatabaseSymbol &record, DatabaseWriter &db) const override;
 	virtual void print() const override;
 
 private:
-	typedef std::unordered_multimap<std::string, StructuredMember *> MemberNameMap;
+	typedef std::unordered_multimap<StringHandle, StructuredMember *> MemberNameMap;
 	MemberNameMap memberNameMap;
-	std::mutex memberMutex;
+
+	/**
+	 * Members sorted by bit position, rebuilt on the first lookup by
+	 * offset after a change.
+	 */
+	mutable std::vector<StructuredMember *> memberList;
+	mutable std::atomic<bool> memberListValid;
+	mutable std::mutex memberMutex;
 };
 
 #endif /* _STRUCTURED_H_ */
@@ -2,35 +2,50 @@
 
 #include <iostream>
 #include "dwarfexception.h"
+#include "symboldatabase.h"
 
 StructuredMember::StructuredMember(SymbolManager *mgr,
                                    DwarfParser *parser,
-                                   const Dwarf_Die &object,
+                                   const DieInfo &info,
                                    const std::string &name,
                                    Structured *parent)
 	:
-	Symbol(mgr, parser, object, name),
-	ReferencingType(mgr, parser, object),
+	Symbol(mgr, parser, info, name),
+	ReferencingType(mgr, parser, info),
 	bitSize(0),
 	bitOffset(0),
 	memberLocation(0),
 	parent(parent) {
 
+	this->kind = SymbolKind::Member;
 	if (parent == nullptr) {
 		std::cout << "parent not set" << std::endl;
 		throw DwarfException("Parent not set");
 	}
-	if (parser->dieHasAttr(object, DW_AT_bit_size)) {
-		this->bitSize = parser->getDieAttributeNumber(object, DW_AT_bit_size);
+	if (info.has(DW_AT_bit_size)) {
+		this->bitSize = info.bitSize;
 	}
-	if (parser->dieHasAttr(object, DW_AT_bit_offset)) {
-		this->bitOffset = parser->getDieAttributeNumber(object, DW_AT_bit_offset);
+	if (info.has(DW_AT_bit_offset)) {
+		this->bitOffset = info.bitOffset;
 	}
-	if (parser->dieHasAttr(object, DW_AT_data_member_location)) {
-		this->memberLocation = parser->getDieAttributeNumber(object, DW_AT_data_member_location);
+	if (info.has(DW_AT_data_member_location)) {
+		this->memberLocation = info.memberLocation;
 	}
 }
 
+StructuredMember::StructuredMember(SymbolManager *mgr,
+                                   const DatabaseSymbol &record,
+                                   const DatabaseReader &db)
+	:
+	Symbol(mgr, record, db),
+	ReferencingType(mgr, record),
+	bitSize(record.bitSize),
+	bitOffset(record.bitOffset),
+	memberLocation(record.value),
+	parent(nullptr) {
+	this->kind = SymbolKind::Member;
+}
+
 StructuredMember::~StructuredMember() {}
 
 uint32_t StructuredMember::getByteSize() {
@@ -52,3 +67,35 @@ uint32_t StructuredMember::getBitOffset() {
 uint32_t StructuredMember::getMemberLocation() {
 	return this->memberLocation;
 }
+
+uint64_t StructuredMember::getBitPosition() {
+	uint64_t position = (uint64_t)this->memberLocation * 8;
+	if (this->bitSize) {
+		// DW_AT_bit_offset counts from the most significant bit of the
+		// storage unit, on little endian targets that is the highest address
+		uint32_t storageBits = this->getByteSize() * 8;
+		if (storageBits >= this->bitOffset + this->bitSize) {
+			position += storageBits - this->bitOffset - this->bitSize;
+		}
+	}
+	return position;
+}
+
+void StructuredMember::setManager(SymbolManager *manager) {
+	this->Symbol::manager = manager;
+	this->ReferencingType::manager = manager;
+}
+
+void StructuredMember::store(DatabaseSymbol &record, DatabaseWriter &db) const {
+	Symbol::store(record, db);
+	record.kind      = (uint8_t)DatabaseKind::Member;
+	record.type      = this->type;
+	record.value     = this->memberLocation;
+	record.value2    = this->parent->getID();
+	record.bitSize   = this->bitSize;
+	record.bitOffset = this->bitOffset;
+}
+
+void StructuredMember::setParent(Structured *parent) {
+	this->parent = parent;
+}
@@ -9,16 +9,40 @@
 class StructuredMember : public Symbol, public ReferencingType {
 public:
 	StructuredMember(SymbolManager *mgr, DwarfParser *parser,
-	                 const Dwarf_Die &object,
+	                 const DieInfo &info,
 	                 const std::string &name,
 	                 Structured *parent);
+
+	/**
+	 * Restore a member, its parent is set by Structured::addMember().
+	 */
+	StructuredMember(SymbolManager *mgr,
+	                 const DatabaseSymbol &record,
+	                 const DatabaseReader &db);
 	virtual ~StructuredMember();
 
+	static bool classof(const Symbol *sym) {
+		return sym->getKind() == SymbolKind::Member;
+	}
+
 	uint32_t getByteSize() override;
 	uint32_t getBitSize();
 	uint32_t getBitOffset();
 	uint32_t getMemberLocation();
 
+	/**
+	 * @return Offset of the first bit of this member in its Structured.
+	 */
+	uint64_t getBitPosition();
+
+	void setManager(SymbolManager *manager) override;
+	void store(DatabaseSymbol &record, DatabaseWriter &db) const override;
+
+	/**
+	 * Move this member over to another Structured of the same layout.
+	 */
+	void setParent(Structured *parent);
+
 protected:
 	uint32_t bitSize;
 	uint32_t bitOffset;
@@ -4,25 +4,54 @@
 #include <cassert>
 
 #include "dwarfparser.h"
+#include "symboldatabase.h"
 #include "symbolmanager.h"
 
 
 Symbol::Symbol(SymbolManager *manager,
                DwarfParser *parser,
-               const Dwarf_Die &object,
+               const DieInfo &info,
                const std::string &name)
 	:
 	manager{manager},
-	name{name} {
+	name{manager->internString(name)},
+	kind{SymbolKind::BaseType} {
 
-	this->byteSize = parser->getDieByteSize(object);
-	this->id = this->manager->getID(parser->getDieOffset(object),
+	this->byteSize = info.byteSize;
+	this->id = this->manager->getID(info.offset,
 	                                parser->getFileID());
 	this->manager->addSymbol(this);
 }
 
+Symbol::Symbol(SymbolManager *manager,
+               const DatabaseSymbol &record,
+               const DatabaseReader &db)
+	:
+	manager{manager},
+	name{manager->internString(db.getString(record.name))},
+	byteSize{record.byteSize},
+	id{record.id},
+	kind{SymbolKind::BaseType} {
+
+	this->manager->addSymbol(this);
+}
+
 Symbol::~Symbol() {}
 
+void *Symbol::operator new(size_t size, SymbolManager *manager) {
+	return manager->allocateSymbol(size);
+}
+
+void Symbol::operator delete(void * /*ptr*/, SymbolManager * /*manager*/) {}
+
+void Symbol::operator delete(void * /*ptr*/) {}
+
+void Symbol::store(DatabaseSymbol &record, DatabaseWriter &db) const {
+	record.id       = this->id;
+	record.name     = db.addString(*this->name);
+	record.byteSize = this->byteSize;
+}
+
 
 void Symbol::addAlternativeDwarfID(uint64_t dwarfid, uint32_t fileID) {
 	uint64_t internalID = this->manager->getID(dwarfid, fileID);
@@ -31,7 +60,7 @@ void Symbol::addAlternativeDwarfID(uint64_t dwarfid, uint32_t fileID) {
 
 void Symbol::print() const {
 	auto dwarfID = this->manager->getRevID(this->id);
-	std::cout << "Symbolname:      " << this->name << std::endl;
+	std::cout << "Symbolname:      " << *this->name << std::endl;
 	std::cout << "\t ID:           " << std::hex << this->id << std::dec
 	          << std::endl;
 	std::cout << "\t Dwarf ID:     " << std::hex << dwarfID.first << std::dec
@@ -45,6 +74,10 @@ SymbolManager* Symbol::getManager() const {
 	return this->manager;
 }
 
+void Symbol::setManager(SymbolManager *manager) {
+	this->manager = manager;
+}
+
 uint32_t Symbol::getByteSize() {
 	return this->byteSize;
 }
@@ -54,5 +87,9 @@ uint64_t Symbol::getID() const {
 }
 
 const std::string &Symbol::getName() const {
+	return *this->name;
+}
+
+StringHandle Symbol::getNameHandle() const {
 	return this->name;
 }
@@ -4,11 +4,33 @@
 #include <cstdint>
 #include <string>
 
-struct Dwarf_Die_s;
-typedef struct Dwarf_Die_s *Dwarf_Die;
+#include "stringtable.h"
 
+class DatabaseReader;
+class DatabaseWriter;
 class DwarfParser;
 class SymbolManager;
+struct DatabaseSymbol;
+struct DieInfo;
+
+/**
+ * Concrete type of a Symbol. The kinds of the subclasses of a class form
+ * a contiguous range, so classof() is a range check.
+ */
+enum class SymbolKind : uint8_t {
+	BaseType,
+	Typedef,      // RefBaseType
+	ConstType,    // RefBaseType
+	FuncPointer,  // RefBaseType
+	Pointer,      // RefBaseType
+	Array,        // RefBaseType, Pointer
+	Struct,       // Structured
+	Union,        // Structured
+	Enum,
+	Function,
+	Variable,
+	Member,
+};
 
 /**
  * A symbol in one symbol namespace.
@@ -19,14 +41,35 @@ public:
 	 * Constructs a symbol and registers it at its manager.
 	 */
 	Symbol(SymbolManager *manager, DwarfParser *parser,
-	       const Dwarf_Die &object, const std::string &name);
+	       const DieInfo &info, const std::string &name);
+
+	/**
+	 * Restores a symbol from a symbol database and registers it at its manager.
+	 */
+	Symbol(SymbolManager *manager, const DatabaseSymbol &record,
+	       const DatabaseReader &db);
 	virtual ~Symbol();
 
+	/**
+	 * Symbols live in the arena of their SymbolManager and are released
+	 * together with it. Create them with new (manager) T(manager, ...).
+	 * Deleting a Symbol only runs its destructor.
+	 */
+	static void *operator new(size_t size, SymbolManager *manager);
+	static void operator delete(void *ptr, SymbolManager *manager);
+	static void operator delete(void *ptr);
+
 	/**
 	 * @return SymbolManager in charge of the Symbol
 	 */
 	virtual SymbolManager* getManager() const;
 
+	/**
+	 * Internal function to hand the Symbol over to another SymbolManager.
+	 * Used when the results of a parallel parse are merged.
+	 */
+	virtual void setManager(SymbolManager *manager);
+
 	/**
 	 * @return Number of Bytes occupied by the current symbol.
 	 */
@@ -37,17 +80,38 @@ public:
 	 */
 	uint64_t getID() const;
 
+	/**
+	 * @return Concrete type of the Symbol.
+	 */
+	SymbolKind getKind() const {
+		return this->kind;
+	}
+
+	static bool classof(const Symbol *) {
+		return true;
+	}
+
 	/**
 	 * @return Name of the Symbol (BaseType or Variable name)
 	 */
 	const std::string &getName() const;
 
+	/**
+	 * @return Interned name of the Symbol, unique within its SymbolManager.
+	 */
+	StringHandle getNameHandle() const;
+
 	/**
 	 * Internal function to register an alternative DwarfID. 
 	 * Required to handle duplicate entries within the dwarf database.
 	 */
 	void addAlternativeDwarfID(uint64_t dwarfid, uint32_t fileID);
 
+	/**
+	 * Fill the symbol database record of this Symbol.
+	 */
+	virtual void store(DatabaseSymbol &record, DatabaseWriter &db) const;
+
 	/**
 	 * Print the contents of this symbol to stdout. This function will soon be
 	 * replaced by overloading the << operator.
@@ -55,10 +119,23 @@ public:
 	virtual void print() const;
 
 protected:
-	SymbolManager *const manager; ///< Reference to the corresponding SymbolManager.
-	const std::string name; ///< Name of the Symbol.
+	SymbolManager *manager; ///< Reference to the corresponding SymbolManager.
+	StringHandle name; ///< Interned name of the Symbol.
 	uint32_t byteSize; ///< Size of the Symbol in Bytes.
 	uint64_t id; ///< Internal ID of the Symbol.
+	SymbolKind kind; ///< Set by the constructor of the concrete class.
 };
 
+/**
+ * Checked downcast based on the kind of a Symbol, replaces dynamic_cast.
+ * @return sym as T or nullptr if sym is no T.
+ */
+template <class T, class S>
+inline T *kind_cast(S *sym) {
+	if (!sym || !T::classof(sym)) {
+		return nullptr;
+	}
+	return static_cast<T *>(static_cast<Symbol *>(sym));
+}
+
 #endif  /* _SYMBOL_H_ */
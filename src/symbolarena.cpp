@@ -0,0 +1,66 @@
+#include "symbolarena.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+static const size_t arenaAlignment = alignof(std::max_align_t);
+
+// std::max takes it by reference
+const size_t SymbolArena::blockSize;
+
+SymbolArena::SymbolArena()
+	:
+	current{nullptr},
+	remaining{0},
+	size{0} {}
+
+SymbolArena::~SymbolArena() {
+	for (auto &block : this->blocks) {
+		free(block);
+	}
+}
+
+void *SymbolArena::allocate(size_t size) {
+	size = (size + arenaAlignment - 1) & ~(arenaAlignment - 1);
+
+	std::lock_guard<std::mutex> lock(this->mutex);
+	if (size > this->remaining) {
+		// oversized objects get a block of their own, keep the current one
+		size_t allocSize = std::max(size, blockSize);
+		char *block = (char *)malloc(allocSize);
+		if (!block) {
+			throw std::bad_alloc();
+		}
+		this->blocks.push_back(block);
+		this->size += allocSize;
+		if (allocSize > blockSize) {
+			return block;
+		}
+		this->current   = block;
+		this->remaining = allocSize;
+	}
+	void *result = this->current;
+	this->current   += size;
+	this->remaining -= size;
+	return result;
+}
+
+void SymbolArena::adopt(SymbolArena *other) {
+	std::lock(this->mutex, other->mutex);
+	std::lock_guard<std::mutex> lock(this->mutex, std::adopt_lock);
+	std::lock_guard<std::mutex> otherLock(other->mutex, std::adopt_lock);
+
+	this->blocks.insert(this->blocks.end(),
+	                    other->blocks.begin(), other->blocks.end());
+	this->size += other->size;
+	other->blocks.clear();
+	other->current   = nullptr;
+	other->remaining = 0;
+	other->size      = 0;
+}
+
+size_t SymbolArena::getSize() {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	return this->size;
+}
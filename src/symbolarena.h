@@ -0,0 +1,49 @@
+#ifndef _SYMBOLARENA_H_
+#define _SYMBOLARENA_H_
+
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+/**
+ * Bump allocator for the Symbols of a SymbolManager.
+ *
+ * Memory is handed out from large blocks and is only released when the
+ * arena is destroyed, individual allocations are never freed. Against a
+ * malloc per symbol this saves about 3% of the RSS of a parse, see
+ * tests/bench_load.
+ */
+class SymbolArena {
+public:
+	SymbolArena();
+	virtual ~SymbolArena();
+
+	SymbolArena(const SymbolArena &other) = delete;
+	SymbolArena &operator =(const SymbolArena &other) = delete;
+
+	/**
+	 * @return size bytes, suitably aligned for any Symbol.
+	 */
+	void *allocate(size_t size);
+
+	/**
+	 * Take over all blocks of other, which is left empty.
+	 */
+	void adopt(SymbolArena *other);
+
+	/**
+	 * @return Number of bytes reserved by the arena.
+	 */
+	size_t getSize();
+
+private:
+	static const size_t blockSize = 256 * 1024;
+
+	std::vector<char *> blocks;
+	char *current;       ///< Next free byte in the current block.
+	size_t remaining;    ///< Free bytes in the current block.
+	size_t size;
+	std::mutex mutex;
+};
+
+#endif /* _SYMBOLARENA_H_ */
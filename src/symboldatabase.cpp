@@ -0,0 +1,363 @@
+#include "symboldatabase.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <gelf.h>
+#include <libelf.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "dwarfexception.h"
+
+static const char databaseMagic[8] = {'P', 'Y', 'D', 'W', 'D', 'B', 0, 0};
+static const uint32_t databaseVersion = 4;
+static const uint32_t databaseByteOrder = 0x01020304;
+
+/**
+ * Size of a record in each section.
+ */
+static const size_t sectionRecordSize[SECTION_COUNT] = {
+	sizeof(char),           // SECTION_STRINGS
+	sizeof(DatabaseSymbol), // SECTION_SYMBOLS
+	sizeof(uint64_t),       // SECTION_MEMBERS
+	sizeof(DatabaseEnum),   // SECTION_ENUMS
+	sizeof(DatabaseParam),  // SECTION_PARAMS
+	sizeof(DatabaseRange),  // SECTION_RANGES
+	sizeof(DatabaseID),     // SECTION_IDS
+	sizeof(DatabasePair),   // SECTION_ALIASES
+	sizeof(DatabaseName),   // SECTION_BASETYPE_NAMES
+	sizeof(DatabaseName),   // SECTION_REFBASETYPE_NAMES
+	sizeof(DatabaseName),   // SECTION_FUNCTION_NAMES
+	sizeof(DatabaseName),   // SECTION_VARIABLE_NAMES
+	sizeof(uint64_t),       // SECTION_FUNCTIONS
+	sizeof(uint64_t),       // SECTION_ARRAYS
+	sizeof(DatabasePair),   // SECTION_ARRAY_TYPES
+	sizeof(DatabaseName),   // SECTION_SYSMAP
+	sizeof(DatabaseName),   // SECTION_SYSMAP_PRIVATE
+	sizeof(DatabaseName),   // SECTION_ELF_SYMBOLS
+	sizeof(DatabaseName),   // SECTION_FUNCTION_SYMBOLS
+};
+
+
+DatabaseKey DatabaseKey::fromFilename(const std::string &filename) {
+	DatabaseKey key;
+	struct stat st;
+
+	int fd = open(filename.c_str(), O_RDONLY);
+	if (fd < 0 || fstat(fd, &st) != 0) {
+		if (fd >= 0) {
+			close(fd);
+		}
+		throw DwarfException("Unable to open binary for database key");
+	}
+	key.mtime = (int64_t)st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+
+	elf_version(EV_CURRENT);
+	Elf *elf = elf_begin(fd, ELF_C_READ, nullptr);
+	Elf_Scn *scn = nullptr;
+	while (elf && key.buildID.empty() &&
+	       (scn = elf_nextscn(elf, scn)) != nullptr) {
+		GElf_Shdr shdr;
+		if (!gelf_getshdr(scn, &shdr) || shdr.sh_type != SHT_NOTE) {
+			continue;
+		}
+		Elf_Data *data = elf_getdata(scn, nullptr);
+		if (!data) {
+			continue;
+		}
+
+		GElf_Nhdr nhdr;
+		size_t offset = 0, nameOffset, descOffset;
+		while ((offset = gelf_getnote(data, offset, &nhdr,
+		                              &nameOffset, &descOffset)) > 0) {
+			const char *buf = (const char *)data->d_buf;
+			if (nhdr.n_type == NT_GNU_BUILD_ID && nhdr.n_namesz == 4 &&
+			    memcmp(buf + nameOffset, "GNU", 4) == 0) {
+				key.buildID = std::string(buf + descOffset, nhdr.n_descsz);
+				break;
+			}
+		}
+	}
+	if (elf) {
+		elf_end(elf);
+	}
+	close(fd);
+	return key;
+}
+
+bool DatabaseKey::operator ==(const DatabaseKey &other) const {
+	return this->buildID == other.buildID && this->mtime == other.mtime;
+}
+
+
+DatabaseWriter::DatabaseWriter()
+	:
+	strings(1, '\0') {}
+
+uint32_t DatabaseWriter::addString(const std::string &str) {
+	if (str.empty()) {
+		return 0;
+	}
+	auto it = this->stringOffsets.find(str);
+	if (it != this->stringOffsets.end()) {
+		return it->second;
+	}
+	uint32_t offset = this->strings.size();
+	this->strings.append(str.c_str(), str.size() + 1);
+	this->stringOffsets.emplace(str, offset);
+	return offset;
+}
+
+void DatabaseWriter::addSymbol(const DatabaseSymbol &symbol) {
+	this->symbols.push_back(symbol);
+}
+
+uint32_t DatabaseWriter::addMember(uint64_t id) {
+	this->members.push_back(id);
+	return this->members.size() - 1;
+}
+
+uint32_t DatabaseWriter::addEnum(uint32_t value, const std::string &name) {
+	this->enums.push_back(DatabaseEnum{value, this->addString(name)});
+	return this->enums.size() - 1;
+}
+
+uint32_t DatabaseWriter::addParam(const std::string &name, uint64_t type) {
+	this->params.push_back(DatabaseParam{type, this->addString(name), 0});
+	return this->params.size() - 1;
+}
+
+void DatabaseWriter::addRange(uint64_t id, uint64_t begin, uint64_t end) {
+	this->ranges.push_back(DatabaseRange{id, begin, end});
+}
+
+void DatabaseWriter::addID(uint64_t id, uint64_t dwarfID, uint32_t fileID) {
+	this->ids.push_back(DatabaseID{id, dwarfID, fileID, 0});
+}
+
+void DatabaseWriter::addPair(DatabaseSection section,
+                             uint64_t first, uint64_t second) {
+	this->pairs[section].push_back(DatabasePair{first, second});
+}
+
+void DatabaseWriter::addName(DatabaseSection section,
+                             const std::string &name, uint64_t value) {
+	this->names[section].push_back(DatabaseName{this->addString(name), 0, value});
+}
+
+void DatabaseWriter::addListEntry(DatabaseSection section, uint64_t id) {
+	this->lists[section].push_back(id);
+}
+
+template <class T>
+static void writeSection(FILE *file, DatabaseHeader *header,
+                         DatabaseSection section, const T *data,
+                         uint64_t count) {
+	// keep every section 8 byte aligned
+	long pos = ftell(file);
+	if (pos < 0) {
+		throw DwarfException("Unable to write symbol database");
+	}
+	while (pos % 8) {
+		if (fputc(0, file) == EOF) {
+			throw DwarfException("Unable to write symbol database");
+		}
+		pos++;
+	}
+	header->sections[section].offset = pos;
+	header->sections[section].count  = count;
+	if (count && fwrite(data, sizeof(T), count, file) != count) {
+		throw DwarfException("Unable to write symbol database");
+	}
+}
+
+void DatabaseWriter::write(const std::string &filename,
+                           const DatabaseKey &key, uint64_t fileCount) {
+	const char *str = this->strings.data();
+
+	std::sort(this->symbols.begin(), this->symbols.end(),
+	          [](const DatabaseSymbol &a, const DatabaseSymbol &b) {
+		          return a.id < b.id;
+	          });
+	// stable, the ranges of a function stay in DWARF order
+	std::stable_sort(this->ranges.begin(), this->ranges.end(),
+	                 [](const DatabaseRange &a, const DatabaseRange &b) {
+		                 return a.id < b.id;
+	                 });
+	std::sort(this->ids.begin(), this->ids.end(),
+	          [](const DatabaseID &a, const DatabaseID &b) {
+		          return a.id < b.id;
+	          });
+	std::sort(this->pairs[SECTION_ALIASES].begin(),
+	          this->pairs[SECTION_ALIASES].end(),
+	          [](const DatabasePair &a, const DatabasePair &b) {
+		          return a.first < b.first;
+	          });
+	for (auto &section : this->names) {
+		// stable, the order of equal names is the lookup order
+		std::stable_sort(section.begin(), section.end(),
+		                 [str](const DatabaseName &a, const DatabaseName &b) {
+			                 return strcmp(str + a.name, str + b.name) < 0;
+		                 });
+	}
+
+	DatabaseHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, databaseMagic, sizeof(header.magic));
+	header.version   = databaseVersion;
+	header.byteOrder = databaseByteOrder;
+	header.mtime     = key.mtime;
+	header.buildIDLength = std::min(key.buildID.size(), sizeof(header.buildID));
+	memcpy(header.buildID, key.buildID.data(), header.buildIDLength);
+	header.fileCount = fileCount;
+
+	// write to a unique temporary file in the same directory, so readers
+	// never see a partial database and concurrent writers do not collide
+	std::string pattern = filename + ".XXXXXX";
+	std::vector<char> tmpname(pattern.c_str(),
+	                          pattern.c_str() + pattern.size() + 1);
+	int fd = mkstemp(tmpname.data());
+	if (fd < 0) {
+		throw DwarfException("Unable to create symbol database");
+	}
+	// mkstemp creates the file for the owner only
+	FILE *file = nullptr;
+	if (fchmod(fd, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH) != 0 ||
+	    !(file = fdopen(fd, "wb"))) {
+		close(fd);
+		unlink(tmpname.data());
+		throw DwarfException("Unable to create symbol database");
+	}
+	try {
+		if (fwrite(&header, sizeof(header), 1, file) != 1) {
+			throw DwarfException("Unable to write symbol database");
+		}
+		writeSection(file, &header, SECTION_STRINGS, str, this->strings.size());
+		writeSection(file, &header, SECTION_SYMBOLS,
+		             this->symbols.data(), this->symbols.size());
+		writeSection(file, &header, SECTION_MEMBERS,
+		             this->members.data(), this->members.size());
+		writeSection(file, &header, SECTION_ENUMS,
+		             this->enums.data(), this->enums.size());
+		writeSection(file, &header, SECTION_PARAMS,
+		             this->params.data(), this->params.size());
+		writeSection(file, &header, SECTION_RANGES,
+		             this->ranges.data(), this->ranges.size());
+		writeSection(file, &header, SECTION_IDS,
+		             this->ids.data(), this->ids.size());
+		for (int i = SECTION_ALIASES; i < SECTION_COUNT; i++) {
+			// DatabasePair and DatabaseName have the same size, so the
+			// record type has to come from the section
+			DatabaseSection section = (DatabaseSection)i;
+			switch (section) {
+			case SECTION_ALIASES:
+			case SECTION_ARRAY_TYPES:
+				writeSection(file, &header, section, this->pairs[i].data(),
+				             this->pairs[i].size());
+				break;
+			case SECTION_FUNCTIONS:
+			case SECTION_ARRAYS:
+				writeSection(file, &header, section, this->lists[i].data(),
+				             this->lists[i].size());
+				break;
+			default:
+				writeSection(file, &header, section, this->names[i].data(),
+				             this->names[i].size());
+				break;
+			}
+		}
+		if (fseek(file, 0, SEEK_SET) != 0 ||
+		    fwrite(&header, sizeof(header), 1, file) != 1) {
+			throw DwarfException("Unable to write symbol database");
+		}
+	} catch (...) {
+		fclose(file);
+		unlink(tmpname.data());
+		throw;
+	}
+	if (fclose(file) != 0 || rename(tmpname.data(), filename.c_str()) != 0) {
+		unlink(tmpname.data());
+		throw DwarfException("Unable to write symbol database");
+	}
+}
+
+
+DatabaseReader::DatabaseReader(const std::string &filename)
+	:
+	data{nullptr},
+	size{0},
+	stringsSize{0},
+	valid{false} {
+
+	int fd = open(filename.c_str(), O_RDONLY);
+	if (fd < 0) {
+		return;
+	}
+	struct stat st;
+	if (fstat(fd, &st) == 0 && (uint64_t)st.st_size >= sizeof(DatabaseHeader)) {
+		void *map = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+		if (map != MAP_FAILED) {
+			this->data = (const char *)map;
+			this->size = st.st_size;
+		}
+	}
+	close(fd);
+	if (!this->data) {
+		return;
+	}
+
+	const DatabaseHeader *header = this->getHeader();
+	if (memcmp(header->magic, databaseMagic, sizeof(header->magic)) != 0 ||
+	    header->version != databaseVersion ||
+	    header->byteOrder != databaseByteOrder ||
+	    header->buildIDLength > sizeof(header->buildID)) {
+		return;
+	}
+	for (int i = 0; i < SECTION_COUNT; i++) {
+		const DatabaseSectionEntry &entry = header->sections[i];
+		if (entry.offset % 8 || entry.offset > this->size ||
+		    entry.count > (this->size - entry.offset) / sectionRecordSize[i]) {
+			return;
+		}
+	}
+	this->stringsSize = header->sections[SECTION_STRINGS].count;
+	if (this->stringsSize == 0 ||
+	    this->data[header->sections[SECTION_STRINGS].offset +
+	               this->stringsSize - 1] != '\0') {
+		return;
+	}
+	this->valid = true;
+}
+
+DatabaseReader::~DatabaseReader() {
+	if (this->data) {
+		munmap((void *)this->data, this->size);
+	}
+}
+
+bool DatabaseReader::isValid() const {
+	return this->valid;
+}
+
+bool DatabaseReader::matches(const DatabaseKey &key) const {
+	const DatabaseHeader *header = this->getHeader();
+	return this->valid &&
+	       header->mtime == key.mtime &&
+	       std::string((const char *)header->buildID,
+	                   header->buildIDLength) == key.buildID;
+}
+
+const DatabaseHeader *DatabaseReader::getHeader() const {
+	return reinterpret_cast<const DatabaseHeader *>(this->data);
+}
+
+const char *DatabaseReader::getString(uint32_t offset) const {
+	if (offset >= this->stringsSize) {
+		return "";
+	}
+	return this->data + this->getHeader()->sections[SECTION_STRINGS].offset +
+	       offset;
+}
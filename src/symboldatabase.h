@@ -0,0 +1,242 @@
+#ifndef _SYMBOLDATABASE_H_
+#define _SYMBOLDATABASE_H_
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Identifies the version of a binary a symbol database was created from.
+ */
+struct DatabaseKey {
+	std::string buildID; ///< Contents of the NT_GNU_BUILD_ID note.
+	int64_t mtime;       ///< Modification time of the binary in ns.
+
+	/**
+	 * Read the key of an ELF file.
+	 */
+	static DatabaseKey fromFilename(const std::string &filename);
+
+	bool operator ==(const DatabaseKey &other) const;
+};
+
+/*
+ * On-disk layout of a symbol database.
+ *
+ * The file starts with a DatabaseHeader followed by sections of fixed size
+ * records. All references to strings are offsets into the string section,
+ * offset 0 is the empty string. The layout allows to use the file directly
+ * from a read only mapping.
+ */
+
+enum DatabaseSection {
+	SECTION_STRINGS,            ///< char, NUL terminated strings
+	SECTION_SYMBOLS,            ///< DatabaseSymbol, sorted by id
+	SECTION_MEMBERS,            ///< uint64_t, member ids of Structured in layout order
+	SECTION_ENUMS,              ///< DatabaseEnum
+	SECTION_PARAMS,             ///< DatabaseParam
+	SECTION_RANGES,             ///< DatabaseRange, address ranges of Functions, sorted by id
+	SECTION_IDS,                ///< DatabaseID, first id of each file, sorted by id
+	SECTION_ALIASES,            ///< DatabasePair (alias, id), sorted by alias
+	SECTION_BASETYPE_NAMES,     ///< DatabaseName, sorted by name
+	SECTION_REFBASETYPE_NAMES,  ///< DatabaseName, sorted by name
+	SECTION_FUNCTION_NAMES,     ///< DatabaseName, sorted by name
+	SECTION_VARIABLE_NAMES,     ///< DatabaseName, sorted by name
+	SECTION_FUNCTIONS,          ///< uint64_t, ids of the function list
+	SECTION_ARRAYS,             ///< uint64_t, ids of the array list
+	SECTION_ARRAY_TYPES,        ///< DatabasePair (type id, array id)
+	SECTION_SYSMAP,             ///< DatabaseName, sorted by name
+	SECTION_SYSMAP_PRIVATE,     ///< DatabaseName, sorted by name
+	SECTION_ELF_SYMBOLS,        ///< DatabaseName, sorted by name
+	SECTION_FUNCTION_SYMBOLS,   ///< DatabaseName, sorted by name
+	SECTION_COUNT
+};
+
+/**
+ * Type of a stored symbol.
+ */
+enum class DatabaseKind : uint8_t {
+	BaseType,
+	Struct,
+	Union,
+	Enum,
+	Typedef,
+	Pointer,
+	Array,
+	ConstType,
+	FuncPointer,
+	Function,
+	Variable,
+	Member,
+};
+
+struct DatabaseSectionEntry {
+	uint64_t offset; ///< Offset of the section in the file.
+	uint64_t count;  ///< Number of records in the section.
+};
+
+struct DatabaseHeader {
+	char magic[8];
+	uint32_t version;
+	uint32_t byteOrder;
+	int64_t mtime;
+	uint32_t buildIDLength;
+	uint8_t buildID[64];
+	uint32_t reserved;
+	uint64_t fileCount; ///< Number of SECTION_IDS entries.
+	DatabaseSectionEntry sections[SECTION_COUNT];
+};
+
+/**
+ * A stored symbol. The meaning of the generic fields depends on the kind.
+ */
+struct DatabaseSymbol {
+	uint64_t id;
+	uint64_t type;      ///< Referenced type, return type of a Function
+	uint64_t value;     ///< Length, location, address or member location
+	uint64_t value2;    ///< Length type of an Array, parent of a member
+	uint32_t name;
+	uint32_t byteSize;
+	uint32_t encoding;
+	uint32_t first;     ///< First entry in the member, enum or param section
+	uint32_t count;     ///< Number of entries in that section
+	uint32_t bitSize;
+	uint32_t bitOffset;
+	uint8_t kind;       ///< DatabaseKind
+	uint8_t flags;
+	uint16_t reserved;
+};
+
+enum DatabaseSymbolFlags {
+	SYMBOL_FLAG_PARAMS_FINAL = 1,
+};
+
+struct DatabaseEnum {
+	uint32_t value;
+	uint32_t name;
+};
+
+struct DatabaseParam {
+	uint64_t type;
+	uint32_t name;
+	uint32_t reserved;
+};
+
+struct DatabaseRange {
+	uint64_t id;        ///< Function id
+	uint64_t begin;
+	uint64_t end;
+};
+
+struct DatabaseID {
+	uint64_t id;
+	uint64_t dwarfID;
+	uint32_t fileID;
+	uint32_t reserved;
+};
+
+struct DatabasePair {
+	uint64_t first;
+	uint64_t second;
+};
+
+struct DatabaseName {
+	uint32_t name;
+	uint32_t reserved;
+	uint64_t value;     ///< Symbol id or address
+};
+
+/**
+ * Collects the contents of a symbol database and writes it to disk.
+ */
+class DatabaseWriter {
+public:
+	DatabaseWriter();
+
+	/**
+	 * @return Offset of str in the string section.
+	 */
+	uint32_t addString(const std::string &str);
+
+	void addSymbol(const DatabaseSymbol &symbol);
+	uint32_t addMember(uint64_t id);
+	uint32_t addEnum(uint32_t value, const std::string &name);
+	uint32_t addParam(const std::string &name, uint64_t type);
+	void addRange(uint64_t id, uint64_t begin, uint64_t end);
+	void addID(uint64_t id, uint64_t dwarfID, uint32_t fileID);
+	void addPair(DatabaseSection section, uint64_t first, uint64_t second);
+	void addName(DatabaseSection section, const std::string &name,
+	             uint64_t value);
+	void addListEntry(DatabaseSection section, uint64_t id);
+
+	/**
+	 * Sort the sections and write the database to filename.
+	 */
+	void write(const std::string &filename, const DatabaseKey &key,
+	           uint64_t fileCount);
+
+private:
+	std::string strings;
+	std::unordered_map<std::string, uint32_t> stringOffsets;
+
+	std::vector<DatabaseSymbol> symbols;
+	std::vector<uint64_t> members;
+	std::vector<DatabaseEnum> enums;
+	std::vector<DatabaseParam> params;
+	std::vector<DatabaseRange> ranges;
+	std::vector<DatabaseID> ids;
+	std::vector<DatabasePair> pairs[SECTION_COUNT];
+	std::vector<DatabaseName> names[SECTION_COUNT];
+	std::vector<uint64_t> lists[SECTION_COUNT];
+};
+
+/**
+ * Read only view of a symbol database file, backed by a mapping.
+ */
+class DatabaseReader {
+public:
+	/**
+	 * Map filename. Use isValid() to check for a usable database.
+	 */
+	explicit DatabaseReader(const std::string &filename);
+	virtual ~DatabaseReader();
+
+	DatabaseReader(const DatabaseReader &other) = delete;
+	DatabaseReader &operator =(const DatabaseReader &other) = delete;
+
+	/**
+	 * @return true if the file is a well formed symbol database.
+	 */
+	bool isValid() const;
+
+	/**
+	 * @return true if the database was created from the binary with key.
+	 */
+	bool matches(const DatabaseKey &key) const;
+
+	const DatabaseHeader *getHeader() const;
+
+	/**
+	 * @return First record of section, count receives the number of records.
+	 */
+	template <class T>
+	const T *getSection(DatabaseSection section, uint64_t *count) const {
+		const DatabaseSectionEntry &entry = this->getHeader()->sections[section];
+		*count = entry.count;
+		return reinterpret_cast<const T *>(this->data + entry.offset);
+	}
+
+	/**
+	 * @return NUL terminated string at offset in the string section.
+	 */
+	const char *getString(uint32_t offset) const;
+
+private:
+	const char *data;
+	uint64_t size;
+	uint64_t stringsSize;
+	bool valid;
+};
+
+#endif /* _SYMBOLDATABASE_H_ */
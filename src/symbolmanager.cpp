@@ -2,91 +2,203 @@
 
 #include <algorithm>
 #include <cassert>
+#include <fcntl.h>
+#include <gelf.h>
+#include <libelf.h>
+#include <unistd.h>
+#include <unordered_set>
 
 #include "array.h"
 #include "basetype.h"
+#include "consttype.h"
+#include "enum.h"
+#include "funcpointer.h"
 #include "symbol.h"
 #include "refbasetype.h"
 #include "function.h"
+#include "dwarfparser.h"
+#include "pointer.h"
+#include "struct.h"
+#include "structuredmember.h"
+#include "symboldatabase.h"
+#include "typedef.h"
+#include "union.h"
 #include "variable.h"
 
 #include "helpers.h"
 
 SymbolManager::SymbolManager()
 	:
-	currentID{0} {}
+	addressIndexValid{false},
+	parent{nullptr},
+	frozen{false},
+	lazy{false} {}
+
+SymbolManager::SymbolManager(SymbolManager *parent)
+	:
+	addressIndexValid{false},
+	parent{parent},
+	frozen{false},
+	lazy{false} {}
 
 SymbolManager::~SymbolManager() {
-	for (auto& it : this->symbolIDMap ) {
-		delete (it.second);
+	// only runs the destructors, the memory is released with the arena
+	for (auto &sym : this->symbols.getSymbols()) {
+		delete sym;
+	}
+}
+
+StringHandle SymbolManager::internString(const std::string &name) {
+	if (this->parent) {
+		return this->parent->internString(name);
+	}
+	return this->strings.intern(name);
+}
+
+StringHandle SymbolManager::findString(const std::string &name) {
+	if (this->parent) {
+		return this->parent->findString(name);
 	}
+	return this->strings.find(name);
+}
+
+void *SymbolManager::allocateSymbol(size_t size) {
+	this->checkMutable();
+	return this->arena.allocate(size);
+}
+
+size_t SymbolManager::getArenaSize() {
+	return this->arena.getSize();
 }
 
 std::pair<uint64_t, uint32_t> SymbolManager::getRevID(uint64_t id) {
-	return this->idRevMap[id];
+	if (this->parent) {
+		return this->parent->getRevID(id);
+	}
+	return this->ids.getRevID(id);
 }
 
 uint64_t SymbolManager::getID(uint64_t dwarfID, uint32_t fileID) {
-	std::lock_guard<std::mutex> lock(this->mapMutex);
-	auto pair = std::make_pair(dwarfID, fileID);
+	if (this->parent) {
+		return this->parent->getID(dwarfID, fileID);
+	}
+	return this->ids.getID(dwarfID, fileID);
+}
 
-	if (this->idMap[pair] == 0) {
-		uint64_t newID = ++this->currentID;
 
-		this->idMap[pair]     = newID;
-		this->idRevMap[newID] = pair;
+void SymbolManager::checkMutable() const {
+	if (this->frozen.load(std::memory_order_acquire)) {
+		throw DwarfException("SymbolManager is frozen");
+	}
+}
+
+bool SymbolManager::isFrozen() const {
+	return this->frozen.load(std::memory_order_acquire);
+}
 
-		return newID;
+void SymbolManager::setLazyParser(std::unique_ptr<DwarfParser> parser) {
+	assert(!this->parent);
+	this->checkMutable();
+	std::lock_guard<std::recursive_mutex> lock(this->lazyMutex);
+	this->lazyParser = std::move(parser);
+	this->lazy.store(this->lazyParser != nullptr, std::memory_order_release);
+}
+
+std::unique_lock<std::recursive_mutex> SymbolManager::loadName(const std::string &name) {
+	std::unique_lock<std::recursive_mutex> lock = this->lockIfLazy();
+	if (lock.owns_lock() && this->lazyParser) {
+		this->lazyParser->loadName(name);
 	}
-	return this->idMap[pair];
+	return lock;
 }
 
+void SymbolManager::freeze() {
+	assert(!this->parent);
+	if (this->isFrozen()) {
+		return;
+	}
+
+	if (this->lazy.load(std::memory_order_acquire)) {
+		std::lock_guard<std::recursive_mutex> lock(this->lazyMutex);
+		if (this->lazyParser) {
+			this->lazyParser->loadAll();
+			this->lazyParser.reset();
+		}
+		this->lazy.store(false, std::memory_order_release);
+	}
+
+	// enter alternative ids that were added before their symbol, repeated
+	// until chains of alternative ids are resolved as well
+	bool changed = true;
+	while (changed) {
+		changed = false;
+		for (auto &alias : this->symbolIDAliasMap) {
+			if (this->symbols.find(alias.first)) {
+				continue;
+			}
+			Symbol *sym = this->symbols.find(alias.second);
+			if (sym) {
+				this->symbols.set(alias.first, sym);
+				changed = true;
+			}
+		}
+	}
+
+	this->updateRevMaps();
+	this->funcList.shrink_to_fit();
+	this->arrayVector.shrink_to_fit();
+	// only needed to merge newly parsed types
+	TypeHashMap().swap(this->typeHashMap);
+	this->strings.freeze();
+
+	this->frozen.store(true, std::memory_order_release);
+}
 
 std::set<uint64_t> SymbolManager::getAliases(uint64_t id) {
-	return this->symbolIDAliasReverseList[id];
+	auto lock = this->lockUnlessFrozen(this->symbolIDAliasReverseListMutex);
+	auto aliases = this->symbolIDAliasReverseList.find(id);
+	if (aliases == this->symbolIDAliasReverseList.end()) {
+		return std::set<uint64_t>();
+	}
+	return aliases->second;
 }
 
 Symbol *SymbolManager::findSymbolByID(uint64_t id) {
-	this->symbolIDMapMutex.lock();
-	auto symbol = this->symbolIDMap.find(id);
-	this->symbolIDMapMutex.unlock();
-	if (symbol != symbolIDMap.end()) {
-		return symbol->second;
+	// the lazy parser may be creating the symbol in another thread
+	auto lazyLock = this->lockIfLazy();
+	Symbol *symbol = this->symbols.find(id);
+	if (symbol) {
+		return symbol;
 	}
 
-	// Look in aliasMap to find symbol
+	// freeze() entered all alternative ids into the table
+	if (this->isFrozen()) {
+		return nullptr;
+	}
+
+	// an alternative id that was added before its symbol
 	this->symbolIDAliasMapMutex.lock();
-	auto symbolIDAlias = symbolIDAliasMap.find(id);
+	auto symbolIDAlias = this->symbolIDAliasMap.find(id);
+	uint64_t new_id = (symbolIDAlias != this->symbolIDAliasMap.end()) ?
+	                  symbolIDAlias->second : 0;
 	this->symbolIDAliasMapMutex.unlock();
 
-	if (symbolIDAlias != this->symbolIDAliasMap.end()) {
-		uint64_t new_id = symbolIDAlias->second;
-
-		this->symbolIDMapMutex.lock();
-		symbol = this->symbolIDMap.find(new_id);
-		this->symbolIDMapMutex.unlock();
-
-		if (symbol != this->symbolIDMap.end()) {
-			assert(new_id == symbol->second->getID());
-			return symbol->second;
-		}
+	if (new_id && (symbol = this->symbols.find(new_id))) {
+		this->symbols.set(id, symbol);
+		return symbol;
 	}
 
-	// Look in reverseList to find symbol
-	this->symbolIDAliasReverseListMutex.lock();
-	auto revList = this->symbolIDAliasReverseList[id];
-	this->symbolIDAliasReverseListMutex.unlock();
-
-	for (auto &i : revList) {
-		this->symbolIDMapMutex.lock();
-		symbol = this->symbolIDMap.find(i);
-		this->symbolIDMapMutex.unlock();
-
-		if (symbol != this->symbolIDMap.end()) {
-			assert(id == symbol->second->getID());
-			return symbol->second;
+	if (lazyLock.owns_lock()) {
+		std::pair<uint64_t, uint32_t> die = this->getRevID(id);
+		if (this->lazyParser &&
+		    die.second == this->lazyParser->getFileID()) {
+			this->lazyParser->loadDie(die.first);
+		}
+		if ((symbol = this->symbols.find(id))) {
+			return symbol;
 		}
 	}
+
 	std::cout << "Could not find symbol with id: " << id
 	          << " DwarfID: " << std::hex << this->getRevID(id).first
 	          << std::dec << std::endl;
@@ -95,59 +207,73 @@ Symbol *SymbolManager::findSymbolByID(uint64_t id) {
 }
 
 uint64_t SymbolManager::numberOfSymbols() {
-	return this->symbolIDMap.size();
+	return this->symbols.size();
 }
 
 
 void SymbolManager::addSymbol(Symbol *sym) {
+	this->checkMutable();
 	#if 0
 	if (sym->getName().size() != 0) {
 		this->symbolNameMapMutex.lock();
-		this->symbolNameMap.insert(std::pair<std::string, Symbol *>(sym->getName(), sym));
+		this->symbolNameMap.insert(std::make_pair(sym->getNameHandle(), sym));
 		this->symbolNameMapMutex.unlock();
 	}
 	#endif
 
-	this->symbolIDMap[sym->getID()] = sym;
+	this->symbols.set(sym->getID(), sym);
+	if (this->parent) {
+		this->stagedSymbols.push_back(sym);
+	}
 }
 
 void SymbolManager::addBaseType(BaseType *bt) {
+	this->checkMutable();
 	if (bt->getName().size() != 0) {
-		this->baseTypeNameMap.insert(std::make_pair(bt->getName(), bt));
+		this->baseTypeNameMap.insert(std::make_pair(bt->getNameHandle(), bt));
+	}
+	if (bt->getTypeHash()) {
+		this->typeHashMap.insert(std::make_pair(bt->getTypeHash(), bt));
 	}
 }
 
 void SymbolManager::addRefBaseType(RefBaseType *bt) {
+	this->checkMutable();
+	// different types of the same name are kept, the first one is found
 	if (bt->getName().compare("") != 0) {
-		this->refBaseTypeNameMap[bt->getName()] = bt;
+		this->refBaseTypeNameMap.emplace(bt->getNameHandle(), bt);
 	}
 }
 
 void SymbolManager::addFunction(Function *fun) {
-	if (fun->getName().size() != 0 &&
-	    this->functionNameMap.find(fun->getName()) == this->functionNameMap.end()) {
-		this->functionNameMapMutex.lock();
-		this->functionNameMap[fun->getName()] = fun;
-		this->functionNameMapMutex.unlock();
+	this->checkMutable();
+	if (fun->getName().size() != 0) {
+		// the first function of a name is kept
+		std::lock_guard<std::mutex> lock(this->functionNameMapMutex);
+		this->functionNameMap.emplace(fun->getNameHandle(), fun);
 	}
-	this->funcListMutex.lock();
-	this->funcList.push_back(fun);
-	this->funcListMutex.unlock();
+	{
+		std::lock_guard<std::mutex> lock(this->funcListMutex);
+		this->funcList.push_back(fun);
+	}
+	this->addressIndexValid = false;
 }
 
 void SymbolManager::addArray(Array *ar) {
-	this->arrayVectorMutex.lock();
+	this->checkMutable();
+	std::lock_guard<std::mutex> lock(this->arrayVectorMutex);
 	this->arrayVector.push_back(ar);
-	this->arrayVectorMutex.unlock();
 }
 
 void SymbolManager::addVariable(Variable *var) {
+	this->checkMutable();
 	if (var->getName().size() != 0) {
-		variableNameMap[var->getName()] = var;
+		variableNameMap[var->getNameHandle()] = var;
 	}
 }
 
 void SymbolManager::addAlternativeID(uint64_t id, uint64_t new_id) {
+	this->checkMutable();
 	this->symbolIDAliasMapMutex.lock();
 	this->symbolIDAliasMap[new_id] = id;
 	this->symbolIDAliasMapMutex.unlock();
@@ -155,6 +281,108 @@ void SymbolManager::addAlternativeID(uint64_t id, uint64_t new_id) {
 	this->symbolIDAliasReverseListMutex.lock();
 	this->symbolIDAliasReverseList[id].insert(new_id);
 	this->symbolIDAliasReverseListMutex.unlock();
+
+	Symbol *sym = this->symbols.find(id);
+	if (sym) {
+		this->symbols.set(new_id, sym);
+	}
+}
+
+/**
+ * Find the symbol of this manager that a staged symbol would have been
+ * merged into by DwarfParser::getTypeInstance().
+ */
+static Symbol *findMergeTarget(SymbolManager *mgr, Symbol *sym) {
+	BaseType *bt = kind_cast<BaseType>(sym);
+	if (bt) {
+		BaseType *target = mgr->findBaseTypeByHash(bt->getTypeHash(),
+		                                           bt->getName());
+		return (target && target->getKind() == bt->getKind()) ? target : nullptr;
+	}
+	if (kind_cast<Variable>(sym)) {
+		return mgr->findVariableByName(sym->getName());
+	}
+	return nullptr;
+}
+
+void SymbolManager::merge(SymbolManager *staging) {
+	assert(staging->parent == this);
+	this->checkMutable();
+
+	// ids of dropped and merged staged symbols -> id of the surviving symbol
+	std::unordered_map<uint64_t, uint64_t> replaced;
+	// members of merged types, target already has equal ones
+	std::unordered_set<Symbol *> dropped;
+
+	for (auto &sym : staging->stagedSymbols) {
+		if (dropped.find(sym) != dropped.end()) {
+			replaced[sym->getID()] = 0;
+			delete sym;
+			continue;
+		}
+
+		Symbol *target = findMergeTarget(this, sym);
+		if (target) {
+			Structured *structured = kind_cast<Structured>(sym);
+			Variable *var          = kind_cast<Variable>(sym);
+
+			if (structured) {
+				for (auto &member : structured->getMembers()) {
+					dropped.insert(member);
+				}
+			} else if (var) {
+				Variable *targetVar = kind_cast<Variable>(target);
+				if (targetVar->getLocation() == 0) {
+					targetVar->setLocation(var->getLocation());
+				}
+			}
+
+			replaced[sym->getID()] = target->getID();
+			this->addAlternativeID(target->getID(), sym->getID());
+			delete sym;
+			continue;
+		}
+
+		sym->setManager(this);
+		this->addSymbol(sym);
+
+		BaseType *bt = kind_cast<BaseType>(sym);
+		if (bt) {
+			this->addBaseType(bt);
+		}
+		RefBaseType *rbt = kind_cast<RefBaseType>(sym);
+		if (rbt) {
+			this->addRefBaseType(rbt);
+		}
+		Array *ar = kind_cast<Array>(sym);
+		if (ar) {
+			this->addArray(ar);
+		}
+		Function *fun = kind_cast<Function>(sym);
+		if (fun) {
+			this->addFunction(fun);
+		}
+		Variable *var = kind_cast<Variable>(sym);
+		if (var) {
+			this->addVariable(var);
+		}
+	}
+
+	for (auto &alias : staging->symbolIDAliasMap) {
+		uint64_t id = alias.second;
+		auto it = replaced.find(id);
+		if (it != replaced.end()) {
+			id = it->second;
+		}
+		if (id) {
+			this->addAlternativeID(id, alias.first);
+		}
+	}
+
+	// the staging manager no longer owns any symbols
+	staging->stagedSymbols.clear();
+	staging->symbols.clear();
+	this->arena.adopt(&staging->arena);
 }
 
 void SymbolManager::removeSymbol(Symbol *sym) {
@@ -162,6 +390,7 @@ void SymbolManager::removeSymbol(Symbol *sym) {
 }
 
 void SymbolManager::removeSymbol(uint64_t id) {
+	this->checkMutable();
 	if (this->symbolIDAliasReverseList[id].size() > 0) {
 		std::cout << "Warning removing symbol with aliases" << std::endl;
 		std::cout << std::hex << id << std::dec << std::endl;
@@ -180,14 +409,12 @@ void SymbolManager::removeSymbol(uint64_t id) {
 		}
 
 		std::cout << "This Symbol: " << std::endl;
-		this->symbolIDMap[id]->print();
+		this->findSymbolByID(id)->print();
 
 		assert(false);
 	}
 
-	this->symbolIDMapMutex.lock();
-	this->symbolIDMap.erase(id);
-	this->symbolIDMapMutex.unlock();
+	this->symbols.set(id, nullptr);
 }
 
 BaseType *SymbolManager::findBaseTypeByID(uint64_t id) {
@@ -197,13 +424,14 @@ BaseType *SymbolManager::findBaseTypeByID(uint64_t id) {
 		std::cout << "No symbol with id: " << std::hex << id << std::dec
 		          << std::endl;
 	assert(symbol);
-	base = dynamic_cast<BaseType *>(symbol);
+	base = kind_cast<BaseType>(symbol);
 	assert(base);
 	return base;
 }
 
 BaseType *SymbolManager::findBaseTypeByName(const std::string &name) {
-	auto bt = this->baseTypeNameMap.find(name);
+	auto lazyLock = this->loadName(name);
+	auto bt = this->baseTypeNameMap.find(this->findString(name));
 	if (bt != this->baseTypeNameMap.end()) {
 		return bt->second;
 	} else {
@@ -211,21 +439,39 @@ BaseType *SymbolManager::findBaseTypeByName(const std::string &name) {
 	}
 }
 
+BaseType *SymbolManager::findBaseTypeByHash(uint64_t hash,
+                                            const std::string &name) {
+	StringHandle handle = this->findString(name);
+	if (!hash || !handle) {
+		return nullptr;
+	}
+	auto range = this->typeHashMap.equal_range(hash);
+	for (auto bt = range.first; bt != range.second; ++bt) {
+		if (bt->second->getNameHandle() == handle) {
+			return bt->second;
+		}
+	}
+	return nullptr;
+}
+
 Function *SymbolManager::findFunctionByID(uint64_t id) {
 	Function *var;
 	Symbol *symbol = this->findSymbolByID(id);
 	assert(symbol);
-	var = dynamic_cast<Function *>(symbol);
+	var = kind_cast<Function>(symbol);
 	assert(var);
 	return var;
 }
 
 Function *SymbolManager::findFunctionByName(const std::string &name) {
-	return returnPtrInMap(this->functionNameMap, name);
+	auto lazyLock = this->loadName(name);
+	return returnPtrInMap(this->functionNameMap, this->findString(name));
 }
 
 void SymbolManager::cleanFunctions() {
-	this->funcListMutex.lock();
+	this->checkMutable();
+	this->addressIndexValid = false;
+	std::lock_guard<std::mutex> lock(this->funcListMutex);
 	for (auto &item : this->funcList) {
 		assert(item);
 		item->updateTypes();
@@ -256,6 +502,7 @@ void SymbolManager::cleanFunctions() {
 		if (*oldPtr == *(*item)) {
 			delPtr = *item;
 			this->addAlternativeID(oldPtr->getID(), delPtr->getID());
+			oldPtr->adoptRanges(delPtr);
 			delete delPtr;
 		} else {
 			tmp.push_back(*item);
@@ -268,20 +515,20 @@ void SymbolManager::cleanFunctions() {
 	this->funcList.swap(tmp);
 	tmp.clear();
 	// TODO actually we don't need the vector any more at this point
-	this->funcListMutex.unlock();
 }
 
 RefBaseType *SymbolManager::findRefBaseTypeByID(uint64_t id) {
 	RefBaseType *base;
 	Symbol *symbol = this->findSymbolByID(id);
 	assert(symbol);
-	base = dynamic_cast<RefBaseType *>(symbol);
+	base = kind_cast<RefBaseType>(symbol);
 	assert(base);
 	return base;
 }
 
 RefBaseType *SymbolManager::findRefBaseTypeByName(const std::string &name) {
-	auto rbt = this->refBaseTypeNameMap.find(name);
+	auto lazyLock = this->loadName(name);
+	auto rbt = this->refBaseTypeNameMap.find(this->findString(name));
 	if (rbt != this->refBaseTypeNameMap.end()) {
 		return rbt->second;
 	} else {
@@ -293,40 +540,41 @@ Array *SymbolManager::findArrayByID(uint64_t id) {
 	Array *base;
 	Symbol *symbol = this->findSymbolByID(id);
 	assert(symbol);
-	base = dynamic_cast<Array *>(symbol);
+	base = kind_cast<Array>(symbol);
 	assert(base);
 	return base;
 }
 
 Array *SymbolManager::findArrayByTypeID(uint64_t id, uint64_t length) {
-	// Search for array with type
-	this->arrayTypeMapMutex.lock();
-	auto bt = arrayTypeMap.find(id);
-	this->arrayTypeMapMutex.unlock();
-	while (bt != this->arrayTypeMap.end()) {
-		if (bt->second->getLength() == length) {
-			return bt->second;
-		}
-		bt++;
-	}
-	// Search for all aliases of this type
-	auto revList = this->getAliases(id);
-	for (auto &i : revList) {
-		this->arrayTypeMapMutex.lock();
-		bt = this->arrayTypeMap.find(i);
-		this->arrayTypeMapMutex.unlock();
-		while (bt != this->arrayTypeMap.end()) {
+	auto find = [this, length](uint64_t typeID) -> Array * {
+		auto lock = this->lockUnlessFrozen(this->arrayTypeMapMutex);
+		auto range = this->arrayTypeMap.equal_range(typeID);
+		for (auto bt = range.first; bt != range.second; bt++) {
 			if (bt->second->getLength() == length) {
 				return bt->second;
 			}
-			bt++;
+		}
+		return nullptr;
+	};
+
+	// Search for array with type
+	Array *array = find(id);
+	if (array) {
+		return array;
+	}
+	// Search for all aliases of this type
+	for (auto &i : this->getAliases(id)) {
+		array = find(i);
+		if (array) {
+			return array;
 		}
 	}
 	return nullptr;
 }
 
 void SymbolManager::cleanArrays() {
-	this->arrayVectorMutex.lock();
+	this->checkMutable();
+	std::lock_guard<std::mutex> lock(this->arrayVectorMutex);
 	for (auto &item : this->arrayVector) {
 		assert(item);
 		item->updateTypes();
@@ -356,6 +604,13 @@ void SymbolManager::cleanArrays() {
 		if (*oldPtr == *(*item)) {
 			this->addAlternativeID(oldPtr->getID(), (*item)->getID());
 			delPtr = *item;
+			auto range = this->typeHashMap.equal_range(delPtr->getTypeHash());
+			for (auto bt = range.first; bt != range.second; ++bt) {
+				if (bt->second == delPtr) {
+					this->typeHashMap.erase(bt);
+					break;
+				}
+			}
 			delete delPtr;
 		} else {
 			oldPtr = (*item);
@@ -368,12 +623,10 @@ void SymbolManager::cleanArrays() {
 	this->arrayVector.swap(tmp);
 	tmp.clear();
 
-	this->arrayTypeMapMutex.lock();
+	std::lock_guard<std::mutex> typeMapLock(this->arrayTypeMapMutex);
 	for (auto &item : arrayVector) {
 		this->arrayTypeMap.insert(std::make_pair(item->getType(), item));
 	}
-	this->arrayTypeMapMutex.unlock();
-	this->arrayVectorMutex.unlock();
 }
 
 
@@ -381,23 +634,39 @@ Variable *SymbolManager::findVariableByID(uint64_t id) {
 	Variable *var;
 	Symbol *symbol = this->findSymbolByID(id);
 	assert(symbol);
-	var = dynamic_cast<Variable *>(symbol);
+	var = kind_cast<Variable>(symbol);
 	assert(var);
 	return var;
 }
 
 Variable *SymbolManager::findVariableByName(const std::string &name) {
-	return returnPtrInMap(this->variableNameMap, name);
+	auto lazyLock = this->loadName(name);
+	return returnPtrInMap(this->variableNameMap, this->findString(name));
 }
 
 std::vector<std::string> SymbolManager::getVarNames() {
+	auto lazyLock = this->lockIfLazy();
 	std::vector<std::string> ret;
 	for (auto& it : this->variableNameMap) {
-		ret.push_back(it.first);
+		ret.push_back(*it.first);
 	}
 	return ret;
 }
 
+void SymbolManager::addWarning(const std::string &warning) {
+	if (this->parent) {
+		this->parent->addWarning(warning);
+		return;
+	}
+	std::lock_guard<std::mutex> lock(this->warningsMutex);
+	this->warnings.push_back(warning);
+}
+
+std::vector<std::string> SymbolManager::getWarnings() {
+	std::lock_guard<std::mutex> lock(this->warningsMutex);
+	return this->warnings;
+}
+
 #define enum_bit_test(source, input_enum) \
 	static_cast<uint64_t>(src) & static_cast<uint64_t>(input_enum)
 
@@ -455,16 +724,111 @@ uint64_t SymbolManager::getSymbolAddress(const std::string &symbolName,
 
 #undef enum_bit_test
 
+/**
+ * Fill revMap from map, the smallest name wins for a shared address.
+ */
+static void buildRevMap(const std::unordered_map<std::string, uint64_t> &map,
+                        std::vector<std::pair<uint64_t, const std::string *>> &revMap) {
+	revMap.clear();
+	revMap.reserve(map.size());
+	for (auto &i : map) {
+		revMap.push_back(std::make_pair(i.second, &i.first));
+	}
+	std::sort(revMap.begin(), revMap.end(),
+	          [](const std::pair<uint64_t, const std::string *> &a,
+	             const std::pair<uint64_t, const std::string *> &b) {
+		if (a.first != b.first) {
+			return a.first < b.first;
+		}
+		return *a.second < *b.second;
+	});
+	revMap.erase(std::unique(revMap.begin(), revMap.end(),
+	                         [](const std::pair<uint64_t, const std::string *> &a,
+	                            const std::pair<uint64_t, const std::string *> &b) {
+		             return a.first == b.first;
+	             }),
+	             revMap.end());
+	revMap.shrink_to_fit();
+}
+
+/**
+ * @return The name at address in revMap, nullptr if there is none.
+ */
+static const std::string *findRevMap(
+		const std::vector<std::pair<uint64_t, const std::string *>> &revMap,
+		uint64_t address) {
+	auto it = std::lower_bound(
+		revMap.begin(), revMap.end(), address,
+		[](const std::pair<uint64_t, const std::string *> &entry, uint64_t address) {
+			return entry.first < address;
+		});
+	if (it == revMap.end() || it->first != address) {
+		return nullptr;
+	}
+	return it->second;
+}
+
 void SymbolManager::updateRevMaps() {
-	this->elfSymbolRevMap.clear();
-	this->functionSymbolRevMap.clear();
+	this->checkMutable();
+	buildRevMap(this->elfSymbolMap, this->elfSymbolRevMap);
+	buildRevMap(this->functionSymbolMap, this->functionSymbolRevMap);
+
+	std::lock_guard<std::mutex> lock(this->addressIndexMutex);
+	this->buildAddressIndex();
+}
 
+void SymbolManager::buildAddressIndex() {
+	this->addressIndex.clear();
+	this->functionIndex.clear();
 	for (auto &i : this->elfSymbolMap) {
-		this->elfSymbolRevMap[i.second] = i.first;
+		this->addressIndex.add(i.second, 0, &i.first);
 	}
 	for (auto &i : this->functionSymbolMap) {
-		this->functionSymbolRevMap[i.second] = i.first;
+		this->addressIndex.add(i.second, 0, &i.first);
+	}
+	this->funcListMutex.lock();
+	for (auto &fun : this->funcList) {
+		StringHandle name = fun->getNameHandle();
+		bool named = fun->getName().size() != 0;
+		for (auto &range : fun->getRanges()) {
+			this->functionIndex.add(range.first, range.second, name, fun);
+			if (named) {
+				this->addressIndex.add(range.first, range.second, name, fun);
+			}
+		}
+		if (fun->getRanges().empty() && fun->getAddress() && named) {
+			this->addressIndex.add(fun->getAddress(), 0, name, fun);
+		}
 	}
+	this->funcListMutex.unlock();
+	this->addressIndex.build();
+	this->functionIndex.build();
+	this->addressIndexValid.store(true, std::memory_order_release);
+}
+
+void SymbolManager::ensureAddressIndex() {
+	if (!this->addressIndexValid.load(std::memory_order_acquire)) {
+		std::lock_guard<std::mutex> lock(this->addressIndexMutex);
+		if (!this->addressIndexValid.load(std::memory_order_relaxed)) {
+			this->buildAddressIndex();
+		}
+	}
+}
+
+Function *SymbolManager::findFunctionByAddress(uint64_t address) {
+	this->ensureAddressIndex();
+	return this->functionIndex.find(address).function;
+}
+
+AddressInfo SymbolManager::symbolize(uint64_t address) {
+	this->ensureAddressIndex();
+	return this->addressIndex.find(address);
+}
+
+std::vector<AddressInfo> SymbolManager::symbolize(
+		const std::vector<uint64_t> &addresses) {
+	this->ensureAddressIndex();
+	return this->addressIndex.find(addresses);
 }
 
 
@@ -487,6 +851,7 @@ uint64_t SymbolManager::getSystemMapAddress(const std::string &name,
 
 bool SymbolManager::addSymbolAddress(const std::string &name,
                                      uint64_t address, bool replace) {
+	this->checkMutable();
 	bool duplicate = false;
 	auto it = this->elfSymbolMap.find(name);
 
@@ -506,6 +871,7 @@ bool SymbolManager::addSymbolAddress(const std::string &name,
 		it = this->elfSymbolMap.find(newName);
 	}
 	this->elfSymbolMap[newName] = address;
+	this->addressIndexValid = false;
 
 	return duplicate;
 }
@@ -519,33 +885,22 @@ uint64_t SymbolManager::getElfSymbolAddress(const std::string &name) {
 }
 
 std::string SymbolManager::getElfSymbolName(uint64_t address) {
-	auto symbol = this->elfSymbolRevMap.find(address);
-	if (symbol != this->elfSymbolRevMap.end()) {
-		return symbol->second;
-	}
-	return "";
+	const std::string *name = findRevMap(this->elfSymbolRevMap, address);
+	return name ? *name : "";
 }
 
 bool SymbolManager::isSymbol(uint64_t address) {
-	if (this->elfSymbolRevMap.find(address) != this->elfSymbolRevMap.end()) {
-
-		return true;
-	}
-	return false;
+	return findRevMap(this->elfSymbolRevMap, address) != nullptr;
 }
 
 uint64_t SymbolManager::getContainingSymbol(uint64_t address) {
-	auto iter = this->elfSymbolRevMap.upper_bound(address);
-	if (iter != this->elfSymbolRevMap.end() &&
-	    iter-- != this->elfSymbolRevMap.begin()) {
-
-		return iter->first;
-	}
-	return 0;
+	AddressInfo info = this->symbolize(address);
+	return info.name ? info.start : 0;
 }
 
 void SymbolManager::addFunctionAddress(const std::string &name,
                                        uint64_t address) {
+	this->checkMutable();
 	std::string newName = name;
 	while (this->functionSymbolMap.find(newName) !=
 	       this->functionSymbolMap.end()) {
@@ -553,6 +908,7 @@ void SymbolManager::addFunctionAddress(const std::string &name,
 		newName = newName.append("_");
 	}
 	this->functionSymbolMap[newName] = address;
+	this->addressIndexValid = false;
 }
 
 uint64_t SymbolManager::getFunctionAddress(const std::string &name) {
@@ -564,22 +920,16 @@ uint64_t SymbolManager::getFunctionAddress(const std::string &name) {
 }
 
 std::string SymbolManager::getFunctionName(uint64_t address) {
-	auto function = this->functionSymbolRevMap.find(address);
-	if (function != this->functionSymbolRevMap.end()) {
-		return function->second;
-	}
-	return "";
+	const std::string *name = findRevMap(this->functionSymbolRevMap, address);
+	return name ? *name : "";
 }
 
 bool SymbolManager::isFunction(uint64_t address) {
-	if (this->functionSymbolRevMap.find(address) !=
-	    this->functionSymbolRevMap.end()) {
-		return true;
-	}
-	return false;
+	return findRevMap(this->functionSymbolRevMap, address) != nullptr;
 }
 
 void SymbolManager::addSysmapSymbol(const std::string &name, uint64_t address, bool priv) {
+	this->checkMutable();
 	if (priv) {
 		this->sysMapSymbols[name] = address;
 	}
@@ -587,3 +937,326 @@ void SymbolManager::addSysmapSymbol(const std::string &name, uint64_t address, b
 		this->sysMapSymbolsPrivate[name] = address;
 	}
 }
+
+size_t SymbolManager::loadElfSymbols(const std::string &filename) {
+	this->checkMutable();
+
+	int fd = open(filename.c_str(), O_RDONLY);
+	if (fd < 0) {
+		throw DwarfException("Unable to open binary for symbols");
+	}
+	elf_version(EV_CURRENT);
+	Elf *elf = elf_begin(fd, ELF_C_READ, nullptr);
+	if (!elf) {
+		close(fd);
+		throw DwarfException("Unable to read elf file for symbols");
+	}
+
+	struct SymbolSection {
+		Elf_Data *data;
+		size_t strtab;
+		size_t count;
+	};
+	std::vector<SymbolSection> tables;
+	size_t total = 0;
+	Elf_Scn *scn = nullptr;
+	while ((scn = elf_nextscn(elf, scn)) != nullptr) {
+		GElf_Shdr shdr;
+		if (!gelf_getshdr(scn, &shdr) ||
+		    (shdr.sh_type != SHT_SYMTAB && shdr.sh_type != SHT_DYNSYM) ||
+		    shdr.sh_entsize == 0) {
+			continue;
+		}
+		Elf_Data *data = elf_getdata(scn, nullptr);
+		if (data) {
+			size_t count = shdr.sh_size / shdr.sh_entsize;
+			tables.push_back(SymbolSection{data, shdr.sh_link, count});
+			total += count;
+		}
+	}
+
+	// size the maps once, the names are hashed only on insertion
+	this->elfSymbolMap.reserve(this->elfSymbolMap.size() + total);
+	this->functionSymbolMap.reserve(this->functionSymbolMap.size() + total);
+
+	size_t count = 0;
+	for (auto &table : tables) {
+		// entry 0 is the undefined symbol
+		for (size_t i = 1; i < table.count; i++) {
+			GElf_Sym sym;
+			if (!gelf_getsym(table.data, i, &sym)) {
+				continue;
+			}
+			int type = GELF_ST_TYPE(sym.st_info);
+			if (sym.st_shndx == SHN_UNDEF || sym.st_name == 0 ||
+			    type == STT_SECTION || type == STT_FILE || type == STT_TLS) {
+				continue;
+			}
+			const char *name = elf_strptr(elf, table.strtab, sym.st_name);
+			if (!name || !*name) {
+				continue;
+			}
+			count++;
+
+			this->addSymbolAddress(name, sym.st_value);
+			if (type == STT_FUNC) {
+				// .dynsym repeats the exported functions of .symtab
+				auto known = this->functionSymbolMap.find(name);
+				if (known == this->functionSymbolMap.end() ||
+				    known->second != sym.st_value) {
+					this->addFunctionAddress(name, sym.st_value);
+				}
+			}
+		}
+	}
+	elf_end(elf);
+	close(fd);
+
+	this->updateRevMaps();
+	return count;
+}
+
+void SymbolManager::saveDatabase(const std::string &filename,
+                                 const DatabaseKey &key) {
+	assert(!this->parent);
+	if (this->lazy.load(std::memory_order_acquire)) {
+		std::lock_guard<std::recursive_mutex> lock(this->lazyMutex);
+		if (this->lazyParser) {
+			this->lazyParser->loadAll();
+		}
+	}
+	DatabaseWriter db;
+
+	// ids are computed from the file index, storing the files is enough
+	std::vector<uint32_t> files = this->ids.getFiles();
+	for (uint64_t i = 0; i < files.size(); i++) {
+		db.addID((i + 1) << IDTable::offsetBits, 0, files[i]);
+	}
+	for (auto &sym : this->symbols.getSymbols()) {
+		DatabaseSymbol record = DatabaseSymbol();
+		sym->store(record, db);
+		db.addSymbol(record);
+	}
+	for (auto &i : this->symbolIDAliasMap) {
+		db.addPair(SECTION_ALIASES, i.first, i.second);
+	}
+
+	for (auto &i : this->baseTypeNameMap) {
+		db.addName(SECTION_BASETYPE_NAMES, *i.first, i.second->getID());
+	}
+	for (auto &i : this->refBaseTypeNameMap) {
+		db.addName(SECTION_REFBASETYPE_NAMES, *i.first, i.second->getID());
+	}
+	for (auto &i : this->functionNameMap) {
+		db.addName(SECTION_FUNCTION_NAMES, *i.first, i.second->getID());
+	}
+	for (auto &i : this->variableNameMap) {
+		db.addName(SECTION_VARIABLE_NAMES, *i.first, i.second->getID());
+	}
+	for (auto &i : this->funcList) {
+		db.addListEntry(SECTION_FUNCTIONS, i->getID());
+	}
+	for (auto &i : this->arrayVector) {
+		db.addListEntry(SECTION_ARRAYS, i->getID());
+	}
+	for (auto &i : this->arrayTypeMap) {
+		db.addPair(SECTION_ARRAY_TYPES, i.first, i.second->getID());
+	}
+
+	for (auto &i : this->sysMapSymbols) {
+		db.addName(SECTION_SYSMAP, i.first, i.second);
+	}
+	for (auto &i : this->sysMapSymbolsPrivate) {
+		db.addName(SECTION_SYSMAP_PRIVATE, i.first, i.second);
+	}
+	for (auto &i : this->elfSymbolMap) {
+		db.addName(SECTION_ELF_SYMBOLS, i.first, i.second);
+	}
+	for (auto &i : this->functionSymbolMap) {
+		db.addName(SECTION_FUNCTION_SYMBOLS, i.first, i.second);
+	}
+
+	db.write(filename, key, files.size());
+}
+
+/**
+ * Check that all list references of the symbol records stay within their
+ * sections, so a damaged file is rejected before anything is created.
+ */
+static bool checkDatabaseSymbols(const DatabaseReader &db) {
+	uint64_t count, members, enums, params;
+	const DatabaseSymbol *symbols = db.getSection<DatabaseSymbol>(SECTION_SYMBOLS,
+	                                                              &count);
+	db.getSection<uint64_t>(SECTION_MEMBERS, &members);
+	db.getSection<DatabaseEnum>(SECTION_ENUMS, &enums);
+	db.getSection<DatabaseParam>(SECTION_PARAMS, &params);
+
+	for (uint64_t i = 0; i < count; i++) {
+		const DatabaseSymbol &rec = symbols[i];
+		uint64_t end = (uint64_t)rec.first + rec.count;
+		switch ((DatabaseKind)rec.kind) {
+		case DatabaseKind::Struct:
+		case DatabaseKind::Union:
+			if (end > members) return false;
+			break;
+		case DatabaseKind::Enum:
+			if (end > enums) return false;
+			break;
+		case DatabaseKind::Function:
+			if (end > params) return false;
+			break;
+		default:
+			if (rec.kind > (uint8_t)DatabaseKind::Member) return false;
+			break;
+		}
+	}
+	return true;
+}
+
+bool SymbolManager::loadDatabase(const std::string &filename,
+                                 const DatabaseKey &key) {
+	assert(!this->parent);
+	assert(this->symbols.size() == 0);
+	this->checkMutable();
+
+	DatabaseReader db{filename};
+	if (!db.matches(key) || !checkDatabaseSymbols(db)) {
+		return false;
+	}
+
+	uint64_t count;
+
+	// file ids are only unique within a process, hand out new ones
+	std::unordered_map<uint32_t, uint32_t> fileIDs;
+	const DatabaseID *idRecords = db.getSection<DatabaseID>(SECTION_IDS, &count);
+	if (count > IDTable::maxFiles) {
+		return false;
+	}
+	for (uint64_t i = 0; i < count; i++) {
+		if (idRecords[i].id >> IDTable::offsetBits != i + 1) {
+			return false;
+		}
+		auto fileID = fileIDs.find(idRecords[i].fileID);
+		if (fileID == fileIDs.end()) {
+			fileID = fileIDs.emplace(idRecords[i].fileID,
+			                         DwarfParser::newFileID()).first;
+		}
+		this->ids.addFile(idRecords[i].id >> IDTable::offsetBits, fileID->second);
+	}
+
+	const DatabaseSymbol *symbols = db.getSection<DatabaseSymbol>(SECTION_SYMBOLS,
+	                                                              &count);
+	for (uint64_t i = 0; i < count; i++) {
+		const DatabaseSymbol &rec = symbols[i];
+		switch ((DatabaseKind)rec.kind) {
+		case DatabaseKind::BaseType:    new (this) BaseType(this, rec, db); break;
+		case DatabaseKind::Struct:      new (this) Struct(this, rec, db); break;
+		case DatabaseKind::Union:       new (this) Union(this, rec, db); break;
+		case DatabaseKind::Enum:        new (this) Enum(this, rec, db); break;
+		case DatabaseKind::Typedef:     new (this) Typedef(this, rec, db); break;
+		case DatabaseKind::Pointer:     new (this) Pointer(this, rec, db); break;
+		case DatabaseKind::Array:       new (this) Array(this, rec, db); break;
+		case DatabaseKind::ConstType:   new (this) ConstType(this, rec, db); break;
+		case DatabaseKind::FuncPointer: new (this) FuncPointer(this, rec, db); break;
+		case DatabaseKind::Function:    new (this) Function(this, rec, db); break;
+		case DatabaseKind::Variable:    new (this) Variable(this, rec, db); break;
+		case DatabaseKind::Member:      new (this) StructuredMember(this, rec, db); break;
+		}
+	}
+
+	auto lookup = [this](uint64_t id) {
+		return this->symbols.find(id);
+	};
+
+	uint64_t numMembers;
+	const uint64_t *members = db.getSection<uint64_t>(SECTION_MEMBERS,
+	                                                  &numMembers);
+	for (uint64_t i = 0; i < count; i++) {
+		const DatabaseSymbol &rec = symbols[i];
+		Structured *structured = kind_cast<Structured>(lookup(rec.id));
+		if (!structured) {
+			continue;
+		}
+		for (uint32_t j = rec.first; j < rec.first + rec.count; j++) {
+			auto member = kind_cast<StructuredMember>(lookup(members[j]));
+			if (member) {
+				structured->addMember(member);
+			}
+		}
+	}
+
+	const DatabasePair *pairs = db.getSection<DatabasePair>(SECTION_ALIASES,
+	                                                        &count);
+	for (uint64_t i = 0; i < count; i++) {
+		this->addAlternativeID(pairs[i].second, pairs[i].first);
+	}
+	pairs = db.getSection<DatabasePair>(SECTION_ARRAY_TYPES, &count);
+	for (uint64_t i = 0; i < count; i++) {
+		auto array = kind_cast<Array>(lookup(pairs[i].second));
+		if (array) {
+			this->arrayTypeMap.insert(std::make_pair(pairs[i].first, array));
+		}
+	}
+
+	const DatabaseName *names;
+	names = db.getSection<DatabaseName>(SECTION_BASETYPE_NAMES, &count);
+	for (uint64_t i = 0; i < count; i++) {
+		auto bt = kind_cast<BaseType>(lookup(names[i].value));
+		if (bt) {
+			this->baseTypeNameMap.insert(std::make_pair(bt->getNameHandle(), bt));
+		}
+	}
+	names = db.getSection<DatabaseName>(SECTION_REFBASETYPE_NAMES, &count);
+	for (uint64_t i = 0; i < count; i++) {
+		auto rbt = kind_cast<RefBaseType>(lookup(names[i].value));
+		if (rbt) {
+			this->refBaseTypeNameMap.emplace(rbt->getNameHandle(), rbt);
+		}
+	}
+	names = db.getSection<DatabaseName>(SECTION_FUNCTION_NAMES, &count);
+	for (uint64_t i = 0; i < count; i++) {
+		auto fun = kind_cast<Function>(lookup(names[i].value));
+		if (fun) {
+			this->functionNameMap[fun->getNameHandle()] = fun;
+		}
+	}
+	names = db.getSection<DatabaseName>(SECTION_VARIABLE_NAMES, &count);
+	for (uint64_t i = 0; i < count; i++) {
+		auto var = kind_cast<Variable>(lookup(names[i].value));
+		if (var) {
+			this->variableNameMap[var->getNameHandle()] = var;
+		}
+	}
+
+	const uint64_t *list = db.getSection<uint64_t>(SECTION_FUNCTIONS, &count);
+	for (uint64_t i = 0; i < count; i++) {
+		auto fun = kind_cast<Function>(lookup(list[i]));
+		if (fun) {
+			this->funcList.push_back(fun);
+		}
+	}
+	list = db.getSection<uint64_t>(SECTION_ARRAYS, &count);
+	for (uint64_t i = 0; i < count; i++) {
+		auto array = kind_cast<Array>(lookup(list[i]));
+		if (array) {
+			this->arrayVector.push_back(array);
+		}
+	}
+
+	std::pair<DatabaseSection, SymbolMap *> addressMaps[] = {
+		{SECTION_SYSMAP, &this->sysMapSymbols},
+		{SECTION_SYSMAP_PRIVATE, &this->sysMapSymbolsPrivate},
+		{SECTION_ELF_SYMBOLS, &this->elfSymbolMap},
+		{SECTION_FUNCTION_SYMBOLS, &this->functionSymbolMap},
+	};
+	for (auto &map : addressMaps) {
+		names = db.getSection<DatabaseName>(map.first, &count);
+		map.second->reserve(count);
+		for (uint64_t i = 0; i < count; i++) {
+			(*map.second)[db.getString(names[i].name)] = names[i].value;
+		}
+	}
+	this->updateRevMaps();
+
+	return true;
+}
@@ -1,20 +1,31 @@
 #ifndef _SYMBOLMANAGER_H_
 #define _SYMBOLMANAGER_H_
 
+#include <atomic>
 #include <cstdint>
 #include <cstring>
-#include <map>
+#include <memory>
 #include <mutex>
 #include <set>
 #include <unordered_map>
 #include <vector>
 
+#include "addressindex.h"
+#include "idtable.h"
+#include "stringtable.h"
+#include "symbol.h"
+#include "symbolarena.h"
+#include "symboltable.h"
+
 class Array;
 class BaseType;
+class DatabaseReader;
+class DwarfParser;
 class Function;
 class Symbol;
 class RefBaseType;
 class Variable;
+struct DatabaseKey;
 
 
 template <int pos>
@@ -54,15 +65,14 @@ inline constexpr symbol_source operator ~(symbol_source __x) {
  * Manages a symbol namespace.
  */
 class SymbolManager {
-private:
-	struct pair_hash {
-		template <class T1, class T2>
-		std::size_t operator () (const std::pair<T1, T2> &p) const {
-			return std::hash<T1>{}(p.first) ^ std::hash<T2>{}(p.second);
-		}
-	};
 public:
 	SymbolManager();
+
+	/**
+	 * Create a staging manager that allocates its ids from parent.
+	 * Its symbols are handed over to the parent with merge().
+	 */
+	explicit SymbolManager(SymbolManager *parent);
 	virtual ~SymbolManager();
 
 	// disallow copies and moves.
@@ -77,6 +87,26 @@ public:
 	uint64_t getID(uint64_t dwarfID, uint32_t fileID);
 	std::pair<uint64_t, uint32_t> getRevID(uint64_t id);
 
+	/**
+	 * @return Handle of name in the string table of this id namespace.
+	 */
+	StringHandle internString(const std::string &name);
+
+	/**
+	 * @return Handle of name, nullptr if no symbol has ever used it.
+	 */
+	StringHandle findString(const std::string &name);
+
+	/**
+	 * Reserve memory for a Symbol, see Symbol::operator new.
+	 */
+	void *allocateSymbol(size_t size);
+
+	/**
+	 * @return Number of bytes reserved for Symbols.
+	 */
+	size_t getArenaSize();
+
 	void addSymbol(Symbol *sym);
 	void addAlternativeID(uint64_t id, uint64_t new_id);
 	void addBaseType(BaseType *bt);
@@ -88,6 +118,47 @@ public:
 	void removeSymbol(Symbol *sym);
 	void removeSymbol(uint64_t id);
 
+	/**
+	 * Move all symbols of a staging manager into this manager.
+	 * Types that already exist here by name become aliases, exactly as if
+	 * the staged compilation units had been parsed into this manager.
+	 */
+	void merge(SymbolManager *staging);
+
+	/**
+	 * Write the complete state of this manager to a symbol database.
+	 * @param key Identifies the binary the symbols were parsed from.
+	 */
+	void saveDatabase(const std::string &filename, const DatabaseKey &key);
+
+	/**
+	 * Fill this (empty) manager from a symbol database.
+	 * @return false if the database is missing, damaged or does not
+	 * belong to the binary identified by key.
+	 */
+	bool loadDatabase(const std::string &filename, const DatabaseKey &key);
+
+	/**
+	 * Create symbols on demand with parser instead of parsing all DIEs up
+	 * front, see DwarfParser::parseDwarfFromFilenameLazy(). Lookups by
+	 * name or id that miss ask the parser for the DIE. The manager owns
+	 * parser.
+	 */
+	void setLazyParser(std::unique_ptr<DwarfParser> parser);
+
+	/**
+	 * Finish loading: create all symbols of a lazy parser, resolve all alternative ids, build the address
+	 * maps and make the manager read-only. Queries of a frozen manager
+	 * take no locks and may run from any number of threads, everything
+	 * that would add or remove symbols throws a DwarfException.
+	 */
+	void freeze();
+
+	/**
+	 * @return true once freeze() was called.
+	 */
+	bool isFrozen() const;
+
 	/**
 	 * Searching for a Symbol by Name is flawed by design.
 	 * return the symbol by name and cast it to T.
@@ -95,13 +166,17 @@ public:
 	template <class T>
 	inline T *findSymbolByName(const std::string &name) {
 		T* t = nullptr;
-		this->symbolNameMapMutex.lock();
-		auto range = this->symbolNameMap.equal_range(name);
+		auto lazyLock = this->loadName(name);
+		StringHandle handle = this->findString(name);
+		if (!handle) {
+			return nullptr;
+		}
+		auto lock = this->lockUnlessFrozen(this->symbolNameMapMutex);
+		auto range = this->symbolNameMap.equal_range(handle);
 		for (auto it = range.first; it != range.second ; it++) {
-			T *t = dynamic_cast<T *>(it->second);
+			t = kind_cast<T>(it->second);
 			if (t) break;
 		}
-		this->symbolNameMapMutex.unlock();
 		return t;
 	}
 
@@ -110,17 +185,45 @@ public:
 	std::set<uint64_t> getAliases(uint64_t id);
 
 	BaseType *findBaseTypeByID(uint64_t id);
+
+	/**
+	 * @return A type named name, nullptr if there is none. Different
+	 * types of the same name are all kept (see DwarfParser::getTypeHash()),
+	 * including union and enum declarations, and any of them may be
+	 * returned.
+	 */
 	BaseType *findBaseTypeByName(const std::string &name);
 
+	/**
+	 * @return The type named name with the structural hash hash, see
+	 * DwarfParser::getTypeHash(), nullptr if there is none. Only types
+	 * parsed since the last freeze() are known.
+	 */
+	BaseType *findBaseTypeByHash(uint64_t hash, const std::string &name);
+
 	Function *findFunctionByID(uint64_t id);
 	Function *findFunctionByName(const std::string &name);
+
+	/**
+	 * @return The DWARF function whose ranges contain address, nullptr if
+	 * there is none.
+	 */
+	Function *findFunctionByAddress(uint64_t address);
 	void cleanFunctions();
 
+	/**
+	 * @return A type named name of kind T, see findBaseTypeByName().
+	 */
 	template <class T>
 	T *findBaseTypeByName(const std::string &name) {
-		auto range = this->baseTypeNameMap.equal_range(name);
+		auto lazyLock = this->loadName(name);
+		StringHandle handle = this->findString(name);
+		if (!handle) {
+			return nullptr;
+		}
+		auto range = this->baseTypeNameMap.equal_range(handle);
 		for (auto i = range.first; i != range.second; ++i) {
-			T *t = dynamic_cast<T *>(i->second);
+			T *t = kind_cast<T>(i->second);
 			if (t)
 				return t;
 		}
@@ -138,6 +241,17 @@ public:
 	Variable *findVariableByName(const std::string &name);
 	std::vector<std::string> getVarNames();
 
+	/**
+	 * Note a problem that did not stop the parse, e.g. a missing split
+	 * DWARF file. A staging manager passes it on to its parent.
+	 */
+	void addWarning(const std::string &warning);
+
+	/**
+	 * @return The warnings of all parses into this manager so far.
+	 */
+	std::vector<std::string> getWarnings();
+
 	// migrated from kernel.h
 	/** return the address of public system map symbol */
 	uint64_t getSystemMapAddress(const std::string &name, bool priv=false);
@@ -176,19 +290,73 @@ public:
 	/** return the function name of function at address */
 	std::string getFunctionName(uint64_t address);
 
-	/** return the symbol that is the next one previous to address */
+	/** return the start of the symbol or function containing address */
 	uint64_t getContainingSymbol(uint64_t address);
 
+	/**
+	 * Find the elf symbol or DWARF function containing address.
+	 */
+	AddressInfo symbolize(uint64_t address);
+
+	/**
+	 * Find the containing symbols of many addresses in one pass.
+	 * @return One result per address, in the order of addresses.
+	 */
+	std::vector<AddressInfo> symbolize(const std::vector<uint64_t> &addresses);
+
 	void updateRevMaps();
 	// ------
 
 	/** place a new entry in the sysmap symbol map */
 	void addSysmapSymbol(const std::string &name, uint64_t address, bool priv);
 
+	/**
+	 * Add all defined symbols of the .symtab and .dynsym sections of an
+	 * elf file as elf symbols, functions also as function symbols, and
+	 * update the reverse maps.
+	 * @return Number of symbols read.
+	 */
+	size_t loadElfSymbols(const std::string &filename);
+
 
 protected:
+	/**
+	 * Lazy mode: let the parser create the symbols named name.
+	 * @return The lock of lockIfLazy(), the lookup of name holds it.
+	 */
+	std::unique_lock<std::recursive_mutex> loadName(const std::string &name);
+
+	/**
+	 * @return A lock on lazyMutex in lazy mode, no lock at all otherwise.
+	 * Lookups hold it while they read what the lazy parser writes.
+	 */
+	inline std::unique_lock<std::recursive_mutex> lockIfLazy() {
+		if (!this->lazy.load(std::memory_order_acquire)) {
+			return std::unique_lock<std::recursive_mutex>();
+		}
+		return std::unique_lock<std::recursive_mutex>(this->lazyMutex);
+	}
+
+	/**
+	 * Throw if the manager is frozen, called by all mutators.
+	 */
+	void checkMutable() const;
+
+	/**
+	 * @return A lock on mutex, or no lock at all for a frozen manager.
+	 */
+	inline std::unique_lock<std::mutex> lockUnlessFrozen(std::mutex &mutex) const {
+		if (this->frozen.load(std::memory_order_acquire)) {
+			return std::unique_lock<std::mutex>();
+		}
+		return std::unique_lock<std::mutex>(mutex);
+	}
+
 	typedef std::unordered_map<std::string, uint64_t> SymbolMap;
-	typedef std::map<uint64_t, std::string> SymbolRevMap;
+	/**
+	 * (address, name) sorted by address, names point into a SymbolMap.
+	 */
+	typedef std::vector<std::pair<uint64_t, const std::string *>> SymbolRevMap;
 	SymbolMap sysMapSymbols;            // sysmap symbols
 	SymbolMap sysMapSymbolsPrivate;     // sysmap private symbols
 
@@ -198,34 +366,80 @@ protected:
 	SymbolRevMap functionSymbolRevMap;  // addr -> funcname
 
 	/**
-	 * The last id issued.
+	 * Elf symbols, function symbols and DWARF functions by address, and
+	 * the address ranges of the DWARF functions alone. Both are built by
+	 * updateRevMaps() or on the first lookup after a change.
 	 */
-	uint64_t currentID;
+	AddressIndex addressIndex;
+	AddressIndex functionIndex;
+	std::atomic<bool> addressIndexValid;
+	std::mutex addressIndexMutex;
+
+	void buildAddressIndex();
+	void ensureAddressIndex();
+
+	/**
+	 * Manager that issues the ids of a staging manager.
+	 */
+	SymbolManager *const parent;
+
+	/**
+	 * Set by freeze(), the manager no longer changes.
+	 */
+	std::atomic<bool> frozen;
+
+	/**
+	 * Parser of the lazy mode, nullptr once everything is loaded. Only
+	 * accessed with lazyMutex held.
+	 */
+	std::unique_ptr<DwarfParser> lazyParser;
+	std::recursive_mutex lazyMutex;
+
+	/**
+	 * Set while there is a lazyParser, lookups test it without the lock.
+	 */
+	std::atomic<bool> lazy;
+
+	/**
+	 * Symbols of a staging manager in order of creation.
+	 */
+	std::vector<Symbol *> stagedSymbols;
+
+	/**
+	 * Storage of all Symbols owned by this manager.
+	 */
+	SymbolArena arena;
+
+	/**
+	 * Names of all Symbols, only used by managers without a parent.
+	 */
+	StringTable strings;
 
-	typedef std::unordered_map<std::pair<uint64_t, uint32_t>, uint64_t, pair_hash> IDMap;
-	typedef std::unordered_map<uint64_t, std::pair<uint64_t, uint32_t>> IDRevMap;
 	//typedef std::multimap<std::string, Symbol *> SymbolNameMap;
-	typedef std::unordered_multimap<std::string, Symbol *> SymbolNameMap;
-	typedef std::unordered_map<uint64_t, Symbol *> SymbolIDMap;
+	typedef std::unordered_multimap<StringHandle, Symbol *> SymbolNameMap;
 	typedef std::unordered_map<uint64_t, uint64_t> SymbolIDAliasMap;
 	typedef std::unordered_map<uint64_t, std::set<uint64_t>> SymbolIDAliasReverseList;
-	typedef std::unordered_multimap<std::string, BaseType *> BaseTypeNameMap;
-	typedef std::unordered_map<std::string, Function *> FunctionNameMap;
+	typedef std::unordered_multimap<StringHandle, BaseType *> BaseTypeNameMap;
+	typedef std::unordered_multimap<uint64_t, BaseType *> TypeHashMap;
+	typedef std::unordered_map<StringHandle, Function *> FunctionNameMap;
 	typedef std::vector<Function *> FuncList;
-	typedef std::unordered_map<std::string, RefBaseType*> RefBaseTypeNameMap;
+	typedef std::unordered_map<StringHandle, RefBaseType*> RefBaseTypeNameMap;
 	typedef std::unordered_multimap<uint64_t, Array *> ArrayTypeMap;
 	typedef std::vector<Array *> ArrayVector;
-	typedef std::unordered_map<std::string, Variable *> VariableNameMap;
+	typedef std::unordered_map<StringHandle, Variable *> VariableNameMap;
 
-	IDRevMap                 idRevMap;
-	IDMap                    idMap;
-	std::mutex               mapMutex;
+	/**
+	 * Ids of all DIEs, only used by managers without a parent.
+	 */
+	IDTable                  ids;
 
 	SymbolNameMap            symbolNameMap;
 	std::mutex               symbolNameMapMutex;
 
-	SymbolIDMap              symbolIDMap;
-	std::mutex               symbolIDMapMutex;
+	/**
+	 * All symbols and alternative ids of this manager.
+	 */
+	SymbolTable              symbols;
 
 	SymbolIDAliasMap         symbolIDAliasMap;
 	std::mutex               symbolIDAliasMapMutex;
@@ -235,6 +449,11 @@ protected:
 
 	BaseTypeNameMap          baseTypeNameMap;
 
+	/**
+	 * Parsed types by structural hash, to merge equal types while parsing.
+	 */
+	TypeHashMap              typeHashMap;
+
 	FunctionNameMap          functionNameMap;
 	std::mutex               functionNameMapMutex;
 
@@ -250,6 +469,9 @@ protected:
 	std::mutex               arrayTypeMapMutex;
 
 	VariableNameMap          variableNameMap;
+
+	std::vector<std::string> warnings;
+	std::mutex               warningsMutex;
 };
 
 #endif
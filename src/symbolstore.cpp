@@ -0,0 +1,324 @@
+#include "symbolstore.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "dwarfexception.h"
+#include "helpers.h"
+
+static const char *kindNames[] = {
+	"BaseType",
+	"Struct",
+	"Union",
+	"Enum",
+	"Typedef",
+	"Pointer",
+	"Array",
+	"ConstType",
+	"FuncPointer",
+	"Function",
+	"Variable",
+	"Member",
+};
+
+/**
+ * Comparison for the binary searches in the name sections, which compare
+ * entries with a plain C string.
+ */
+struct DatabaseNameLess {
+	const DatabaseReader &db;
+
+	bool operator ()(const DatabaseName &entry, const char *str) const {
+		return strcmp(this->db.getString(entry.name), str) < 0;
+	}
+
+	bool operator ()(const char *str, const DatabaseName &entry) const {
+		return strcmp(str, this->db.getString(entry.name)) < 0;
+	}
+};
+
+
+StoredSymbol::StoredSymbol()
+	:
+	store{nullptr},
+	record{nullptr} {}
+
+StoredSymbol::StoredSymbol(const SymbolStore *store,
+                           const DatabaseSymbol *record)
+	:
+	store{store},
+	record{record} {}
+
+bool StoredSymbol::isValid() const {
+	return this->record != nullptr;
+}
+
+uint64_t StoredSymbol::getID() const {
+	return this->record ? this->record->id : 0;
+}
+
+DatabaseKind StoredSymbol::getKind() const {
+	return this->record ? (DatabaseKind)this->record->kind
+	                    : DatabaseKind::BaseType;
+}
+
+const char *StoredSymbol::getKindName() const {
+	if (!this->record ||
+	    this->record->kind > (uint8_t)DatabaseKind::Member) {
+		return "";
+	}
+	return kindNames[this->record->kind];
+}
+
+const char *StoredSymbol::getName() const {
+	return this->record ? this->store->db.getString(this->record->name) : "";
+}
+
+uint32_t StoredSymbol::getByteSize() const {
+	return this->record ? this->record->byteSize : 0;
+}
+
+uint32_t StoredSymbol::getEncoding() const {
+	return this->record ? this->record->encoding : 0;
+}
+
+StoredSymbol StoredSymbol::getType() const {
+	if (!this->record || !this->record->type) {
+		return StoredSymbol();
+	}
+	return this->store->findSymbolByID(this->record->type);
+}
+
+uint64_t StoredSymbol::getAddress() const {
+	return this->record ? this->record->value : 0;
+}
+
+uint64_t StoredSymbol::getLength() const {
+	return this->record ? this->record->value : 0;
+}
+
+uint64_t StoredSymbol::getMemberLocation() const {
+	return this->record ? this->record->value : 0;
+}
+
+uint32_t StoredSymbol::getBitSize() const {
+	return this->record ? this->record->bitSize : 0;
+}
+
+uint32_t StoredSymbol::getBitOffset() const {
+	return this->record ? this->record->bitOffset : 0;
+}
+
+uint32_t StoredSymbol::getMemberCount() const {
+	if (!this->record ||
+	    (this->getKind() != DatabaseKind::Struct &&
+	     this->getKind() != DatabaseKind::Union) ||
+	    (uint64_t)this->record->first + this->record->count >
+	    this->store->memberCount) {
+		return 0;
+	}
+	return this->record->count;
+}
+
+StoredSymbol StoredSymbol::getMember(uint32_t index) const {
+	if (index >= this->getMemberCount()) {
+		return StoredSymbol();
+	}
+	uint64_t id = this->store->members[this->record->first + index];
+	return StoredSymbol(this->store, this->store->findRecord(id));
+}
+
+StoredSymbol StoredSymbol::memberByName(const std::string &name) const {
+	uint32_t count = this->getMemberCount();
+	for (uint32_t i = 0; i < count; i++) {
+		StoredSymbol member = this->getMember(i);
+		if (member.isValid() && name == member.getName()) {
+			return member;
+		}
+	}
+	return StoredSymbol();
+}
+
+StoredSymbol StoredSymbol::memberByOffset(uint32_t offset) const {
+	// binary search for the first member behind offset
+	uint32_t lo = 0, hi = this->getMemberCount();
+	while (lo < hi) {
+		uint32_t mid = lo + (hi - lo) / 2;
+		if (this->getMember(mid).getMemberLocation() <= offset) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
+		}
+	}
+	if (lo == 0) {
+		return StoredSymbol();
+	}
+	// first member at the offset of the one before
+	uint64_t location = this->getMember(lo - 1).getMemberLocation();
+	while (lo > 1 && this->getMember(lo - 2).getMemberLocation() == location) {
+		lo--;
+	}
+	return this->getMember(lo - 1);
+}
+
+SymbolStore::SymbolStore(const std::string &filename)
+	:
+	db{filename} {
+
+	if (!this->db.isValid()) {
+		throw DwarfException("Invalid symbol database");
+	}
+	this->symbols = this->db.getSection<DatabaseSymbol>(SECTION_SYMBOLS,
+	                                                    &this->symbolCount);
+	this->members = this->db.getSection<uint64_t>(SECTION_MEMBERS,
+	                                              &this->memberCount);
+}
+
+SymbolStore::~SymbolStore() {}
+
+bool SymbolStore::matches(const DatabaseKey &key) const {
+	return this->db.matches(key);
+}
+
+const DatabaseSymbol *SymbolStore::findRecord(uint64_t id) const {
+	const DatabaseSymbol *end = this->symbols + this->symbolCount;
+	const DatabaseSymbol *it = std::lower_bound(
+		this->symbols, end, id,
+		[](const DatabaseSymbol &a, uint64_t id) { return a.id < id; });
+	return (it != end && it->id == id) ? it : nullptr;
+}
+
+StoredSymbol SymbolStore::findSymbolByID(uint64_t id) const {
+	const DatabaseSymbol *record = this->findRecord(id);
+	if (!record) {
+		uint64_t count;
+		const DatabasePair *aliases =
+			this->db.getSection<DatabasePair>(SECTION_ALIASES, &count);
+		const DatabasePair *end = aliases + count;
+		const DatabasePair *it = std::lower_bound(
+			aliases, end, id,
+			[](const DatabasePair &a, uint64_t id) { return a.first < id; });
+		if (it != end && it->first == id) {
+			record = this->findRecord(it->second);
+		}
+	}
+	return StoredSymbol(this, record);
+}
+
+std::pair<const DatabaseName *, const DatabaseName *>
+SymbolStore::findNames(DatabaseSection section, const std::string &name) const {
+	uint64_t count;
+	const DatabaseName *names = this->db.getSection<DatabaseName>(section,
+	                                                              &count);
+	return std::equal_range(names, names + count, name.c_str(),
+	                        DatabaseNameLess{this->db});
+}
+
+uint64_t SymbolStore::findNameValue(DatabaseSection section,
+                                    const std::string &name) const {
+	auto range = this->findNames(section, name);
+	return range.first != range.second ? range.first->value : 0;
+}
+
+StoredSymbol SymbolStore::findBaseTypeByName(const std::string &name) const {
+	auto range = this->findNames(SECTION_BASETYPE_NAMES, name);
+	if (range.first == range.second) {
+		return StoredSymbol();
+	}
+	return StoredSymbol(this, this->findRecord(range.first->value));
+}
+
+StoredSymbol SymbolStore::findBaseTypeByName(const std::string &name,
+                                             DatabaseKind kind) const {
+	auto range = this->findNames(SECTION_BASETYPE_NAMES, name);
+	for (auto i = range.first; i != range.second; ++i) {
+		const DatabaseSymbol *record = this->findRecord(i->value);
+		if (record && record->kind == (uint8_t)kind) {
+			return StoredSymbol(this, record);
+		}
+	}
+	return StoredSymbol();
+}
+
+StoredSymbol SymbolStore::findRefBaseTypeByName(const std::string &name) const {
+	uint64_t id = this->findNameValue(SECTION_REFBASETYPE_NAMES, name);
+	return StoredSymbol(this, id ? this->findRecord(id) : nullptr);
+}
+
+StoredSymbol SymbolStore::findFunctionByName(const std::string &name) const {
+	uint64_t id = this->findNameValue(SECTION_FUNCTION_NAMES, name);
+	return StoredSymbol(this, id ? this->findRecord(id) : nullptr);
+}
+
+StoredSymbol SymbolStore::findVariableByName(const std::string &name) const {
+	uint64_t id = this->findNameValue(SECTION_VARIABLE_NAMES, name);
+	return StoredSymbol(this, id ? this->findRecord(id) : nullptr);
+}
+
+#define enum_bit_test(source, input_enum) \
+	static_cast<uint64_t>(src) & static_cast<uint64_t>(input_enum)
+
+uint64_t SymbolStore::getSymbolAddress(const std::string &name,
+                                       symbol_source src) const {
+	uint64_t address;
+
+	if (enum_bit_test(src, symbol_source::system_map)) {
+		address = this->getSystemMapAddress(name);
+		if (address != 0) {
+			return address;
+		}
+	}
+
+	if (enum_bit_test(src, symbol_source::modules)) {
+		address = this->getElfSymbolAddress(name);
+		if (address != 0) {
+			return address;
+		}
+	}
+
+	if (enum_bit_test(src, symbol_source::functions)) {
+		address = this->getFunctionAddress(name);
+		if (address != 0) {
+			return address;
+		}
+	}
+
+	if (enum_bit_test(src, symbol_source::dwarf_function)) {
+		address = this->findFunctionByName(name).getAddress();
+		if (address != 0) {
+			return address;
+		}
+	}
+
+	if (enum_bit_test(src, symbol_source::dwarf_variable)) {
+		address = this->findVariableByName(name).getAddress();
+		if (address != 0) {
+			return address;
+		}
+	}
+
+	return 0;
+}
+
+#undef enum_bit_test
+
+uint64_t SymbolStore::getSystemMapAddress(const std::string &name,
+                                          bool priv) const {
+	uint64_t address = this->findNameValue(SECTION_SYSMAP, name);
+	if (address == 0 && priv) {
+		address = this->findNameValue(SECTION_SYSMAP_PRIVATE, name);
+	}
+	return address;
+}
+
+uint64_t SymbolStore::getElfSymbolAddress(const std::string &name) const {
+	return this->findNameValue(SECTION_ELF_SYMBOLS, name);
+}
+
+uint64_t SymbolStore::getFunctionAddress(const std::string &name) const {
+	return this->findNameValue(SECTION_FUNCTION_SYMBOLS, name);
+}
+
+uint64_t SymbolStore::numberOfSymbols() const {
+	return this->symbolCount;
+}
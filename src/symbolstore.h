@@ -0,0 +1,169 @@
+#ifndef _SYMBOLSTORE_H_
+#define _SYMBOLSTORE_H_
+
+#include "symboldatabase.h"
+#include "symbolmanager.h"
+
+#include <cstdint>
+#include <string>
+
+class SymbolStore;
+
+/**
+ * View of a symbol inside a SymbolStore.
+ *
+ * A StoredSymbol is two pointers into the mapped database, it is only
+ * valid as long as its SymbolStore exists. A default constructed
+ * StoredSymbol is the "not found" result of all lookups.
+ */
+class StoredSymbol {
+public:
+	StoredSymbol();
+	StoredSymbol(const SymbolStore *store, const DatabaseSymbol *record);
+
+	/**
+	 * @return true if this view refers to a symbol.
+	 */
+	bool isValid() const;
+
+	uint64_t getID() const;
+	DatabaseKind getKind() const;
+
+	/**
+	 * @return Name of the kind, e.g. "Struct".
+	 */
+	const char *getKindName() const;
+
+	/**
+	 * @return Name of the symbol, points into the mapping.
+	 */
+	const char *getName() const;
+	uint32_t getByteSize() const;
+	uint32_t getEncoding() const;
+
+	/**
+	 * @return The referenced type of a RefBaseType, Variable or member,
+	 * the return type of a Function.
+	 */
+	StoredSymbol getType() const;
+
+	/**
+	 * @return Address of a Function or location of a Variable.
+	 */
+	uint64_t getAddress() const;
+
+	/**
+	 * @return Length of an Array.
+	 */
+	uint64_t getLength() const;
+
+	/**
+	 * @return Offset of a member in its Structured type.
+	 */
+	uint64_t getMemberLocation() const;
+	uint32_t getBitSize() const;
+	uint32_t getBitOffset() const;
+
+	/**
+	 * @return Number of members of a Struct or Union.
+	 */
+	uint32_t getMemberCount() const;
+
+	/**
+	 * @return Member index of a Struct or Union.
+	 */
+	StoredSymbol getMember(uint32_t index) const;
+
+	/**
+	 * @return Member of a Struct or Union by member name.
+	 */
+	StoredSymbol memberByName(const std::string &name) const;
+
+	/**
+	 * @return Member of a Struct or Union at offset, or the member
+	 * containing offset. @see Structured::memberByOffset()
+	 */
+	StoredSymbol memberByOffset(uint32_t offset) const;
+
+private:
+	const SymbolStore *store;
+	const DatabaseSymbol *record;
+};
+
+/**
+ * Read only symbol namespace that is served directly from a memory mapped
+ * symbol database (see SymbolManager::saveDatabase()).
+ *
+ * Opening a store does not create any Symbol objects, all lookups are
+ * binary searches in the mapping. Processes using the same database share
+ * it through the page cache.
+ */
+class SymbolStore {
+public:
+	/**
+	 * Map the database filename.
+	 * Throws a DwarfException if it is not a valid symbol database.
+	 */
+	explicit SymbolStore(const std::string &filename);
+	virtual ~SymbolStore();
+
+	SymbolStore(const SymbolStore &other) = delete;
+	SymbolStore &operator =(const SymbolStore &other) = delete;
+
+	/**
+	 * @return true if the database was created from the binary with key.
+	 */
+	bool matches(const DatabaseKey &key) const;
+
+	/**
+	 * Find a symbol by its internal ID or one of its alternative IDs.
+	 */
+	StoredSymbol findSymbolByID(uint64_t id) const;
+
+	StoredSymbol findBaseTypeByName(const std::string &name) const;
+
+	/**
+	 * @return The first BaseType called name that is of the given kind.
+	 */
+	StoredSymbol findBaseTypeByName(const std::string &name,
+	                                DatabaseKind kind) const;
+	StoredSymbol findRefBaseTypeByName(const std::string &name) const;
+	StoredSymbol findFunctionByName(const std::string &name) const;
+	StoredSymbol findVariableByName(const std::string &name) const;
+
+	/** @see SymbolManager::getSymbolAddress() */
+	uint64_t getSymbolAddress(const std::string &name,
+	                          symbol_source src=symbol_source::all) const;
+
+	uint64_t getSystemMapAddress(const std::string &name,
+	                             bool priv=false) const;
+	uint64_t getElfSymbolAddress(const std::string &name) const;
+	uint64_t getFunctionAddress(const std::string &name) const;
+
+	uint64_t numberOfSymbols() const;
+
+private:
+	friend class StoredSymbol;
+
+	/**
+	 * @return Range of the entries called name of a sorted name section.
+	 */
+	std::pair<const DatabaseName *, const DatabaseName *>
+	findNames(DatabaseSection section, const std::string &name) const;
+
+	/**
+	 * @return Value of the first entry called name, 0 if there is none.
+	 */
+	uint64_t findNameValue(DatabaseSection section,
+	                       const std::string &name) const;
+
+	const DatabaseSymbol *findRecord(uint64_t id) const;
+
+	DatabaseReader db;
+	const DatabaseSymbol *symbols;
+	uint64_t symbolCount;
+	const uint64_t *members;
+	uint64_t memberCount;
+};
+
+#endif /* _SYMBOLSTORE_H_ */
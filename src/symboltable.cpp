@@ -0,0 +1,138 @@
+#include "symboltable.h"
+
+#include <algorithm>
+
+#include "symbol.h"
+
+SymbolTable::SymbolTable()
+	:
+	files{nullptr},
+	count{0} {}
+
+SymbolTable::~SymbolTable() {}
+
+SymbolTable::FileTable *SymbolTable::newFileTable(unsigned bits) {
+	FileTable *table = new FileTable;
+	table->bits = bits;
+	table->used = 0;
+	// value initialized, all keys are 0
+	table->slots.reset(new Slot[1ULL << bits]());
+	this->fileTables.emplace_back(table);
+	return table;
+}
+
+std::atomic<Symbol *> *SymbolTable::getSlot(uint64_t id) {
+	uint64_t index = id >> IDTable::offsetBits;
+	if (index > IDTable::maxFiles) {
+		throw DwarfException("Invalid symbol id");
+	}
+
+	Directory *files = this->files.load(std::memory_order_relaxed);
+	if (!files || index >= files->count) {
+		// copy to a larger directory, readers may still use the old one
+		uint64_t oldCount = files ? files->count : 0;
+		std::unique_ptr<Directory> grown{new Directory};
+		grown->count = std::min<uint64_t>(
+			std::max<uint64_t>({index + 1, oldCount * 2, 4}),
+			IDTable::maxFiles + 1);
+		grown->tables.reset(new std::atomic<FileTable *>[grown->count]());
+		for (uint64_t i = 0; i < oldCount; i++) {
+			grown->tables[i].store(files->tables[i].load(std::memory_order_relaxed),
+			                       std::memory_order_relaxed);
+		}
+		files = grown.get();
+		this->directories.push_back(std::move(grown));
+		this->files.store(files, std::memory_order_release);
+	}
+
+	FileTable *table = files->tables[index].load(std::memory_order_relaxed);
+	if (!table || (table->used + 1) * 2 > (1ULL << table->bits)) {
+		// copy the entries to a larger table, readers may still use the
+		// old one, removed entries are dropped
+		FileTable *grown = newFileTable(table ? table->bits + 1 : 8);
+		uint64_t mask = (1ULL << grown->bits) - 1;
+		for (uint64_t i = 0; table && i < (1ULL << table->bits); i++) {
+			uint64_t key = table->slots[i].key.load(std::memory_order_relaxed);
+			Symbol *sym = table->slots[i].symbol.load(std::memory_order_relaxed);
+			if (!key || !sym) {
+				continue;
+			}
+			uint64_t j = hash(key, grown->bits);
+			while (grown->slots[j].key.load(std::memory_order_relaxed)) {
+				j = (j + 1) & mask;
+			}
+			grown->slots[j].symbol.store(sym, std::memory_order_relaxed);
+			grown->slots[j].key.store(key, std::memory_order_relaxed);
+			grown->used++;
+		}
+		table = grown;
+		files->tables[index].store(table, std::memory_order_release);
+	}
+
+	uint64_t key = (id & offsetMask) + 1;
+	uint64_t mask = (1ULL << table->bits) - 1;
+	uint64_t i = hash(key, table->bits);
+	for (;; i = (i + 1) & mask) {
+		uint64_t slotKey = table->slots[i].key.load(std::memory_order_relaxed);
+		if (slotKey == key) {
+			return &table->slots[i].symbol;
+		}
+		if (!slotKey) {
+			break;
+		}
+	}
+	// the symbol is stored by the caller, until then find() sees nullptr
+	table->slots[i].key.store(key, std::memory_order_release);
+	table->used++;
+	return &table->slots[i].symbol;
+}
+
+void SymbolTable::set(uint64_t id, Symbol *sym) {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	if (!sym && !this->find(id)) {
+		return;
+	}
+	std::atomic<Symbol *> *slot = this->getSlot(id);
+	Symbol *old = slot->load(std::memory_order_relaxed);
+	if (old && old->getID() == id) {
+		this->count--;
+	}
+	if (sym && sym->getID() == id) {
+		this->count++;
+	}
+	slot->store(sym, std::memory_order_release);
+}
+
+std::vector<Symbol *> SymbolTable::getSymbols() {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	std::vector<Symbol *> result;
+	result.reserve(this->count);
+	Directory *files = this->files.load(std::memory_order_relaxed);
+	for (uint64_t index = 0; files && index < files->count; index++) {
+		FileTable *table = files->tables[index].load(std::memory_order_relaxed);
+		for (uint64_t i = 0; table && i < (1ULL << table->bits); i++) {
+			uint64_t key = table->slots[i].key.load(std::memory_order_relaxed);
+			Symbol *sym = table->slots[i].symbol.load(std::memory_order_relaxed);
+			// skip alternative ids
+			if (sym && sym->getID() == ((index << IDTable::offsetBits) | (key - 1))) {
+				result.push_back(sym);
+			}
+		}
+	}
+	std::sort(result.begin(), result.end(), [](Symbol *a, Symbol *b) {
+		return a->getID() < b->getID();
+	});
+	return result;
+}
+
+size_t SymbolTable::size() const {
+	return this->count;
+}
+
+void SymbolTable::clear() {
+	std::lock_guard<std::mutex> lock(this->mutex);
+	this->files.store(nullptr, std::memory_order_release);
+	this->directories.clear();
+	this->fileTables.clear();
+	this->count = 0;
+}
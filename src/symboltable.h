@@ -0,0 +1,124 @@
+#ifndef _SYMBOLTABLE_H_
+#define _SYMBOLTABLE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "idtable.h"
+
+class Symbol;
+
+/**
+ * Symbols of a SymbolManager indexed by id.
+ *
+ * An id is a file index and a DIE offset (see IDTable). Each file has an
+ * open addressing hash table of the offsets of its symbols, so the size
+ * of the table follows the number of symbols, not the size of the
+ * .debug_info. The directory of the files grows with the largest file
+ * index. Alternative ids of a symbol are entries that point to the same
+ * Symbol.
+ *
+ * find() takes no lock. A full hash table or directory is replaced by a
+ * larger copy and memory of the table is only released by clear() and
+ * the destructor, so a concurrent find() never sees freed memory.
+ */
+class SymbolTable {
+public:
+	SymbolTable();
+	virtual ~SymbolTable();
+
+	SymbolTable(const SymbolTable &other) = delete;
+	SymbolTable &operator =(const SymbolTable &other) = delete;
+
+	/**
+	 * @return The symbol with id or alternative id id, nullptr if there is none.
+	 */
+	inline Symbol *find(uint64_t id) const;
+
+	/**
+	 * Let id refer to sym, nullptr removes the entry.
+	 */
+	void set(uint64_t id, Symbol *sym);
+
+	/**
+	 * @return All symbols, each once, without their alternative ids, in
+	 * order of their id.
+	 */
+	std::vector<Symbol *> getSymbols();
+
+	/**
+	 * @return Number of symbols, without their alternative ids.
+	 */
+	size_t size() const;
+
+	/**
+	 * Remove all entries, the symbols are not destroyed.
+	 */
+	void clear();
+
+private:
+	static const uint64_t offsetMask = (1ULL << IDTable::offsetBits) - 1;
+
+	struct Slot {
+		std::atomic<uint64_t> key;      ///< DIE offset + 1, 0 if unused
+		std::atomic<Symbol *> symbol;
+	};
+
+	/**
+	 * Hash table of the symbols of one file, at most half full.
+	 */
+	struct FileTable {
+		unsigned bits;
+		uint64_t used;
+		std::unique_ptr<Slot[]> slots;
+	};
+
+	/**
+	 * Hash table of each file index below count.
+	 */
+	struct Directory {
+		uint64_t count;
+		std::unique_ptr<std::atomic<FileTable *>[]> tables;
+	};
+
+	static inline uint64_t hash(uint64_t key, unsigned bits) {
+		return (key * 0x9e3779b97f4a7c15ULL) >> (64 - bits);
+	}
+
+	FileTable *newFileTable(unsigned bits);
+	std::atomic<Symbol *> *getSlot(uint64_t id);
+
+	std::atomic<Directory *> files;
+	std::vector<std::unique_ptr<Directory>> directories;
+	std::vector<std::unique_ptr<FileTable>> fileTables;
+	std::atomic<size_t> count;
+	std::mutex mutex;
+};
+
+inline Symbol *SymbolTable::find(uint64_t id) const {
+	Directory *files = this->files.load(std::memory_order_acquire);
+	uint64_t index = id >> IDTable::offsetBits;
+	if (!files || index >= files->count) {
+		return nullptr;
+	}
+	FileTable *table = files->tables[index].load(std::memory_order_acquire);
+	if (!table) {
+		return nullptr;
+	}
+	uint64_t key = (id & offsetMask) + 1;
+	uint64_t mask = (1ULL << table->bits) - 1;
+	for (uint64_t i = hash(key, table->bits);; i = (i + 1) & mask) {
+		uint64_t slotKey = table->slots[i].key.load(std::memory_order_acquire);
+		if (slotKey == key) {
+			return table->slots[i].symbol.load(std::memory_order_acquire);
+		}
+		if (!slotKey) {
+			return nullptr;
+		}
+	}
+}
+
+#endif /* _SYMBOLTABLE_H_ */
@@ -1,10 +1,27 @@
 #include "typedef.h"
 
+#include "symboldatabase.h"
+
 Typedef::Typedef(SymbolManager *mgr,
                  DwarfParser *parser,
-                 const Dwarf_Die &object,
+                 const DieInfo &info,
                  const std::string &name)
 	:
-	RefBaseType(mgr, parser, object, name) {}
+	RefBaseType(mgr, parser, info, name) {
+	this->kind = SymbolKind::Typedef;
+}
+
+Typedef::Typedef(SymbolManager *mgr,
+                 const DatabaseSymbol &record,
+                 const DatabaseReader &db)
+	:
+	RefBaseType(mgr, record, db) {
+	this->kind = SymbolKind::Typedef;
+}
 
 Typedef::~Typedef() {}
+
+void Typedef::store(DatabaseSymbol &record, DatabaseWriter &db) const {
+	RefBaseType::store(record, db);
+	record.kind = (uint8_t)DatabaseKind::Typedef;
+}
@@ -7,9 +7,18 @@ class Typedef : public RefBaseType {
 public:
 	Typedef(SymbolManager *mgr,
 	        DwarfParser *parser,
-	        const Dwarf_Die &object,
+	        const DieInfo &info,
 	        const std::string &name);
+	Typedef(SymbolManager *mgr,
+	        const DatabaseSymbol &record,
+	        const DatabaseReader &db);
 	virtual ~Typedef();
+
+	static bool classof(const Symbol *sym) {
+		return sym->getKind() == SymbolKind::Typedef;
+	}
+
+	void store(DatabaseSymbol &record, DatabaseWriter &db) const override;
 };
 
 #endif /* _TYPEDEF_H_ */
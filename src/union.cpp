@@ -1,10 +1,27 @@
 #include "union.h"
 
+#include "symboldatabase.h"
+
 Union::Union(SymbolManager *mgr,
              DwarfParser *parser,
-             const Dwarf_Die &object,
+             const DieInfo &info,
              const std::string &name)
 	:
-	Structured(mgr, parser, object, name) {}
+	Structured(mgr, parser, info, name) {
+	this->kind = SymbolKind::Union;
+}
+
+Union::Union(SymbolManager *mgr,
+             const DatabaseSymbol &record,
+             const DatabaseReader &db)
+	:
+	Structured(mgr, record, db) {
+	this->kind = SymbolKind::Union;
+}
 
 Union::~Union() {}
+
+void Union::store(DatabaseSymbol &record, DatabaseWriter &db) const {
+	Structured::store(record, db);
+	record.kind = (uint8_t)DatabaseKind::Union;
+}
@@ -7,9 +7,18 @@ class Union : public Structured {
 public:
 	Union(SymbolManager *mgr,
 	      DwarfParser *parser,
-	      const Dwarf_Die &object,
+	      const DieInfo &info,
 	      const std::string &name);
+	Union(SymbolManager *mgr,
+	      const DatabaseSymbol &record,
+	      const DatabaseReader &db);
 	virtual ~Union();
+
+	static bool classof(const Symbol *sym) {
+		return sym->getKind() == SymbolKind::Union;
+	}
+
+	void store(DatabaseSymbol &record, DatabaseWriter &db) const override;
 };
 
 #endif /* _UNION_H_ */
@@ -6,34 +6,46 @@
 #include <iostream>
 
 #include "instance.h"
+#include "symboldatabase.h"
 #include "symbolmanager.h"
 
 Variable::Variable(SymbolManager *mgr,
                    DwarfParser *parser,
-                   const Dwarf_Die &object,
+                   const DieInfo &info,
                    const std::string &name)
 	:
-	Symbol{mgr, parser, object, name},
-	ReferencingType{mgr, parser, object},
+	Symbol{mgr, parser, info, name},
+	ReferencingType{mgr, parser, info},
 	location{0} {
 
+	this->kind = SymbolKind::Variable;
 	this->Symbol::manager->addVariable(this);
-	if (parser->dieHasAttr(object, DW_AT_location)) {
-		this->location = parser->getDieAttributeNumber(object, DW_AT_location);
+	if (info.has(DW_AT_location)) {
+		this->location = info.location;
 	}
 }
 
+Variable::Variable(SymbolManager *mgr,
+                   const DatabaseSymbol &record,
+                   const DatabaseReader &db)
+	:
+	Symbol{mgr, record, db},
+	ReferencingType{mgr, record},
+	location{record.value} {
+	this->kind = SymbolKind::Variable;
+}
+
 Variable::~Variable() {}
 
 uint64_t Variable::getLocation() {
 	return this->location;
 }
 
-void Variable::update(DwarfParser *parser, const Dwarf_Die &object) {
+void Variable::update(DwarfParser *parser, const DieInfo &info) {
 	if (this->location != 0)
 		return;
-	if (parser->dieHasAttr(object, DW_AT_location)) {
-		this->location = parser->getDieAttributeNumber(object, DW_AT_location);
+	if (info.has(DW_AT_location)) {
+		this->location = info.location;
 	}
 }
 
@@ -41,13 +53,26 @@ void Variable::setLocation(uint64_t location) {
 	this->location = location;
 }
 
-Instance Variable::getInstance() {
+Instance Variable::getInstance(MemoryReader *reader) {
 	assert(this->location);
 	Instance instance = Instance(this->getBaseType(),
 	                             this->location);
+	instance.setMemoryReader(reader);
 	return instance;
 }
 
+void Variable::setManager(SymbolManager *manager) {
+	this->Symbol::manager = manager;
+	this->ReferencingType::manager = manager;
+}
+
+void Variable::store(DatabaseSymbol &record, DatabaseWriter &db) const {
+	Symbol::store(record, db);
+	record.kind  = (uint8_t)DatabaseKind::Variable;
+	record.type  = this->type;
+	record.value = this->location;
+}
+
 void Variable::print() const {
 	std::cout << "Variable:" << std::endl;
 	std::cout << "\t Location:     " << std::hex
@@ -5,20 +5,28 @@
 #include "referencingtype.h"
 
 class Instance;
+class MemoryReader;
 
 class Variable : public Symbol, public ReferencingType {
 public:
 	Variable(SymbolManager *mgr,
 	         DwarfParser *parser,
-	         const Dwarf_Die &object,
+	         const DieInfo &info,
 	         const std::string &name);
+	Variable(SymbolManager *mgr,
+	         const DatabaseSymbol &record,
+	         const DatabaseReader &db);
 	virtual ~Variable();
 
+	static bool classof(const Symbol *sym) {
+		return sym->getKind() == SymbolKind::Variable;
+	}
+
 	/**
 	 * @return Location of Symbol this Variable points to.
 	 */
 	uint64_t getLocation();
-	void update(DwarfParser *parser, const Dwarf_Die &object);
+	void update(DwarfParser *parser, const DieInfo &info);
 
 	/**
 	 * @param location New location of Symbol this Variable points to.
@@ -27,10 +35,13 @@ public:
 	void setLocation(uint64_t location);
 
 	/**
+	 * @param reader Memory the Instance reads values from, may be nullptr
 	 * @return Instance of this Variable.
 	 */
-	Instance getInstance();
+	Instance getInstance(MemoryReader *reader=nullptr);
 
+	void setManager(SymbolManager *manager) override;
+	void store(DatabaseSymbol &record, DatabaseWriter &db) const override;
 	void print() const override;
 
 private:
@@ -0,0 +1,60 @@
+/*
+ * Time and memory of parseDwarfFromFilenames for a growing number of
+ * modules. The modules are copies of one binary, so their types are
+ * merged and every copy adds its functions and variables.
+ *
+ * Usage: bench_files [binary [native [modules]]], up to 8 modules by
+ * default.
+ */
+#include "libdwarfparser.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+#include "test.h"
+
+/**
+ * Parse modules copies of binary in a child process, so that the maximum
+ * RSS is that of this parse only.
+ */
+static void run(const TestOptions &options, size_t modules,
+                unsigned int threads) {
+	pid_t pid = fork();
+	if (pid != 0) {
+		int status;
+		waitpid(pid, &status, 0);
+		return;
+	}
+
+	std::vector<std::string> filenames(modules, options.binary);
+	long baseRSS = maxRSS();
+	auto start = Clock::now();
+	SymbolManager mgr;
+	DwarfParser::parseDwarfFromFilenames(filenames, &mgr, threads,
+	                                     options.native);
+	double seconds = secondsSince(start);
+	long rss = maxRSS() - baseRSS;
+	printf("%7zu %7u %9.3f %9lu %9zu %9ld %9ld\n", modules, threads, seconds,
+	       (unsigned long)mgr.numberOfSymbols(), mgr.getArenaSize() / 1024,
+	       rss, rss / (long)modules);
+	fflush(stdout);
+	_exit(0);
+}
+
+int main(int argc, char **argv) {
+	TestOptions options(argc, argv);
+	size_t modules = (argc > 3) ? strtoul(argv[3], nullptr, 0) : 8;
+
+	printf("modules threads   seconds   symbols  arena KB    RSS KB "
+	       "KB/module\n");
+	fflush(stdout);
+	for (size_t count = 1; count <= modules; count *= 2) {
+		run(options, count, 1);
+		run(options, count, 4);
+	}
+	return 0;
+}
@@ -0,0 +1,148 @@
+/*
+ * Throughput of findFunctionByAddress() and of batch symbolize() for
+ * addresses inside the functions of the ELF symbol table, in address
+ * order and shuffled, against a linear search of the address ranges of
+ * all functions found.
+ */
+#include "libdwarfparser.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fcntl.h>
+#include <gelf.h>
+#include <random>
+#include <set>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include "test.h"
+
+/**
+ * @return The middle address of every sized STT_FUNC symbol of filename.
+ */
+static std::vector<uint64_t> getFunctionAddresses(const char *filename) {
+	std::vector<uint64_t> addresses;
+	int fd = open(filename, O_RDONLY);
+	if (fd < 0) {
+		return addresses;
+	}
+	elf_version(EV_CURRENT);
+	Elf *elf = elf_begin(fd, ELF_C_READ, nullptr);
+	Elf_Scn *scn = nullptr;
+	while (elf && (scn = elf_nextscn(elf, scn)) != nullptr) {
+		GElf_Shdr shdr;
+		if (!gelf_getshdr(scn, &shdr) || shdr.sh_type != SHT_SYMTAB ||
+		    shdr.sh_entsize == 0) {
+			continue;
+		}
+		Elf_Data *data = elf_getdata(scn, nullptr);
+		for (size_t i = 1; data && i < shdr.sh_size / shdr.sh_entsize; i++) {
+			GElf_Sym sym;
+			if (gelf_getsym(data, i, &sym) &&
+			    GELF_ST_TYPE(sym.st_info) == STT_FUNC &&
+			    sym.st_shndx != SHN_UNDEF && sym.st_size) {
+				addresses.push_back(sym.st_value + sym.st_size / 2);
+			}
+		}
+	}
+	if (elf) {
+		elf_end(elf);
+	}
+	close(fd);
+	return addresses;
+}
+
+/**
+ * @return Million addresses per second of rounds calls of lookup.
+ */
+template<typename Lookup>
+static double measure(size_t count, int rounds, Lookup lookup) {
+	auto start = Clock::now();
+	size_t found = 0;
+	for (int i = 0; i < rounds; i++) {
+		found += lookup();
+	}
+	double seconds = secondsSince(start);
+	if (found == 0) {
+		printf("nothing found\n");
+	}
+	return (double)count * rounds / seconds / 1e6;
+}
+
+int main(int argc, char **argv) {
+	TestOptions options(argc, argv);
+
+	SymbolManager mgr;
+	options.parse(&mgr);
+	std::vector<uint64_t> sorted =
+		getFunctionAddresses(options.binary.c_str());
+	if (sorted.empty()) {
+		fprintf(stderr, "%s has no function symbols\n",
+		        options.binary.c_str());
+		return 1;
+	}
+	std::sort(sorted.begin(), sorted.end());
+	std::vector<uint64_t> shuffled = sorted;
+	std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937(1));
+
+	auto start = Clock::now();
+	mgr.updateRevMaps();
+	double buildSeconds = secondsSince(start);
+
+	std::set<Function *> functionSet;
+	for (auto address : sorted) {
+		if (Function *function = mgr.findFunctionByAddress(address)) {
+			functionSet.insert(function);
+		}
+	}
+	std::vector<Function *> functions(functionSet.begin(), functionSet.end());
+
+	int rounds = 20000000 / sorted.size() + 1;
+	printf("%zu function symbols, %zu DWARF functions found, "
+	       "maps and index built in %.3f ms\n",
+	       sorted.size(), functions.size(), buildSeconds * 1e3);
+	printf("lookup                         M addresses/s\n");
+	printf("findFunctionByAddress sorted   %13.2f\n",
+	       measure(sorted.size(), rounds, [&]() {
+		size_t found = 0;
+		for (auto address : sorted) {
+			found += (mgr.findFunctionByAddress(address) != nullptr);
+		}
+		return found;
+	}));
+	printf("findFunctionByAddress shuffled %13.2f\n",
+	       measure(shuffled.size(), rounds, [&]() {
+		size_t found = 0;
+		for (auto address : shuffled) {
+			found += (mgr.findFunctionByAddress(address) != nullptr);
+		}
+		return found;
+	}));
+	printf("symbolize batch shuffled       %13.2f\n",
+	       measure(shuffled.size(), rounds, [&]() {
+		size_t found = 0;
+		for (auto &info : mgr.symbolize(shuffled)) {
+			found += (info.function != nullptr);
+		}
+		return found;
+	}));
+	// the linear search is slow, a few addresses are enough
+	std::vector<uint64_t> few(shuffled.begin(),
+	                          shuffled.begin() +
+	                          std::min<size_t>(shuffled.size(), 1000));
+	printf("linear search shuffled         %13.2f\n",
+	       measure(few.size(), 1, [&]() {
+		size_t found = 0;
+		for (auto address : few) {
+			for (auto function : functions) {
+				if (function->containsAddress(address)) {
+					found++;
+					break;
+				}
+			}
+		}
+		return found;
+	}));
+	return 0;
+}
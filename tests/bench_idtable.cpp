@@ -0,0 +1,113 @@
+/*
+ * Throughput of IDTable::getID() and getRevID() from several threads,
+ * against the locked hash maps SymbolManager used before the ids were
+ * computed. Each thread maps the DIE offsets of its own file, or of
+ * files alternating between several files, as a parser that follows
+ * references into other units does.
+ *
+ * Usage: bench_idtable, the binary argument of make bench is ignored.
+ */
+#include "idtable.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "test.h"
+
+static const uint64_t offsetCount = 1 << 20;
+
+/**
+ * The former id mapping of SymbolManager: a counter and a map in each
+ * direction, all behind one mutex.
+ */
+class LockedIDMap {
+public:
+	uint64_t getID(uint64_t dwarfID, uint32_t fileID) {
+		std::lock_guard<std::mutex> lock(this->mutex);
+		uint64_t &id = this->ids[Key(dwarfID, fileID)];
+		if (!id) {
+			id = ++this->currentID;
+			this->revIDs[id] = Key(dwarfID, fileID);
+		}
+		return id;
+	}
+
+	IDTable::DwarfID getRevID(uint64_t id) {
+		std::lock_guard<std::mutex> lock(this->mutex);
+		return this->revIDs[id];
+	}
+
+private:
+	typedef std::pair<uint64_t, uint32_t> Key;
+	struct KeyHash {
+		size_t operator()(const Key &key) const {
+			return std::hash<uint64_t>()(key.first * 31 + key.second);
+		}
+	};
+
+	std::unordered_map<Key, uint64_t, KeyHash> ids;
+	std::unordered_map<uint64_t, Key> revIDs;
+	uint64_t currentID = 0;
+	std::mutex mutex;
+};
+
+/**
+ * Map offsetCount offsets in every thread, thread t uses files
+ * t * files + 1 to (t + 1) * files in turn, and map the ids back.
+ * @return Million lookups per second.
+ */
+template<typename Table>
+static double runOnce(Table &table, unsigned int threads, uint32_t files) {
+	auto worker = [&](unsigned int thread) {
+		uint64_t sum = 0;
+		for (uint64_t offset = 0; offset < offsetCount; offset++) {
+			uint32_t fileID = thread * files + 1 + offset % files;
+			uint64_t id = table.getID(offset * 8, fileID);
+			sum += table.getRevID(id).first;
+		}
+		if (sum == 1) {
+			printf("unlikely checksum\n");
+		}
+	};
+
+	auto start = Clock::now();
+	std::vector<std::thread> workers;
+	for (unsigned int i = 0; i < threads; i++) {
+		workers.emplace_back(worker, i);
+	}
+	for (auto &thread : workers) {
+		thread.join();
+	}
+	return 2.0 * offsetCount * threads / secondsSince(start) / 1e6;
+}
+
+/**
+ * @return The best of three runs on a new table.
+ */
+template<typename Table>
+static double run(unsigned int threads, uint32_t files) {
+	double best = 0;
+	for (int i = 0; i < 3; i++) {
+		Table table;
+		best = std::max(best, runOnce(table, threads, files));
+	}
+	return best;
+}
+
+int main() {
+	printf("threads files/thread  IDTable M/s  locked map M/s\n");
+	for (uint32_t files : {1, 4}) {
+		for (unsigned int threads = 1; threads <= 8; threads *= 2) {
+			double tableRate = run<IDTable>(threads, files);
+			double mapRate = run<LockedIDMap>(threads, files);
+			printf("%7u %12u %12.1f %15.1f\n", threads, files, tableRate,
+			       mapRate);
+		}
+	}
+	return 0;
+}
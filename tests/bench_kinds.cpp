@@ -0,0 +1,158 @@
+/*
+ * Type walking with kind_cast against dynamic_cast: every type reachable
+ * from the variables of a binary is followed through its typedefs, const
+ * and pointer types to the type it ends in, dispatching on the kind of
+ * each type on the way as Instance does.
+ */
+#include "libdwarfparser.h"
+
+#include <cstdio>
+#include <set>
+#include <vector>
+
+#include "test.h"
+
+static const int rounds = 50;
+
+struct KindCast {
+	template <class T>
+	static T *cast(Symbol *sym) {
+		return kind_cast<T>(sym);
+	}
+};
+
+struct DynamicCast {
+	template <class T>
+	static T *cast(Symbol *sym) {
+		return dynamic_cast<T *>(sym);
+	}
+};
+
+/**
+ * @return true if the chain of type ends in a type mgr knows, the base
+ * types on the way are resolved. DWARF types the parser does not support
+ * (e.g. subroutine types) end a chain in an unknown id.
+ */
+static bool resolveChain(SymbolManager &mgr, BaseType *type) {
+	for (int depth = 0; type && depth < 16; depth++) {
+		RefBaseType *ref = kind_cast<RefBaseType>(type);
+		if (!ref || !ref->getType()) {
+			return true;
+		}
+		if (!mgr.findSymbolByID(ref->getType())) {
+			return false;
+		}
+		type = ref->getBaseType();
+	}
+	return true;
+}
+
+/**
+ * @return The types reachable from the variables of the frozen mgr, each
+ * once, that end in a known type.
+ */
+static std::vector<BaseType *> collectTypes(SymbolManager &mgr) {
+	std::vector<uint64_t> pending;
+	for (auto &name : mgr.getVarNames()) {
+		pending.push_back(mgr.findVariableByName(name)->getTypeID());
+	}
+	std::set<uint64_t> seen;
+	std::vector<BaseType *> types;
+	while (!pending.empty()) {
+		uint64_t id = pending.back();
+		pending.pop_back();
+		if (!id || !seen.insert(id).second) {
+			continue;
+		}
+		// a frozen manager returns nullptr for unknown ids
+		BaseType *type = kind_cast<BaseType>(mgr.findSymbolByID(id));
+		if (!type || !resolveChain(mgr, type)) {
+			continue;
+		}
+		types.push_back(type);
+		if (RefBaseType *ref = kind_cast<RefBaseType>(type)) {
+			pending.push_back(ref->getType());
+		}
+		if (Structured *structured = kind_cast<Structured>(type)) {
+			for (auto member : structured->getMembers()) {
+				pending.push_back(member->getTypeID());
+			}
+		}
+	}
+	return types;
+}
+
+/**
+ * @return A checksum of the kinds of the types on the way from each type
+ * to the one it ends in.
+ */
+template <class Cast>
+static uint64_t walkTypes(const std::vector<BaseType *> &types) {
+	uint64_t sum = 0;
+	for (BaseType *type : types) {
+		for (int depth = 0; type && depth < 16; depth++) {
+			if (Structured *structured = Cast::template cast<Structured>(type)) {
+				sum += structured->getMembers().size();
+				break;
+			}
+			if (Cast::template cast<Enum>(type)) {
+				sum += 2;
+				break;
+			}
+			if (Cast::template cast<FuncPointer>(type)) {
+				sum += 3;
+				break;
+			}
+			if (Array *array = Cast::template cast<Array>(type)) {
+				sum += array->getLength();
+			} else if (Cast::template cast<Pointer>(type)) {
+				sum += 5;
+			} else if (Cast::template cast<Typedef>(type) ||
+			           Cast::template cast<ConstType>(type)) {
+				sum += 7;
+			}
+			RefBaseType *ref = Cast::template cast<RefBaseType>(type);
+			type = (ref && ref->getType()) ? ref->getBaseType() : nullptr;
+		}
+	}
+	return sum;
+}
+
+/**
+ * @return Millions of types walked per second.
+ */
+template <class Cast>
+static double measure(const std::vector<BaseType *> &types, uint64_t &sum) {
+	auto start = Clock::now();
+	for (int i = 0; i < rounds; i++) {
+		sum += walkTypes<Cast>(types);
+	}
+	return (double)types.size() * rounds / secondsSince(start) / 1e6;
+}
+
+int main(int argc, char **argv) {
+	TestOptions options(argc, argv);
+
+	SymbolManager mgr;
+	options.parse(&mgr);
+	mgr.freeze();
+	std::vector<BaseType *> types = collectTypes(mgr);
+	if (types.empty()) {
+		fprintf(stderr, "%s has no typed variables\n", options.binary.c_str());
+		return 1;
+	}
+
+	uint64_t kindSum = 0;
+	uint64_t dynamicSum = 0;
+	printf("%zu types\n", types.size());
+	printf("kind_cast     %9.1f M types/s\n",
+	       measure<KindCast>(types, kindSum));
+	printf("dynamic_cast  %9.1f M types/s\n",
+	       measure<DynamicCast>(types, dynamicSum));
+	if (kindSum != dynamicSum) {
+		fprintf(stderr, "the walks differ: %lu != %lu\n",
+		        (unsigned long)kindSum, (unsigned long)dynamicSum);
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,142 @@
+/*
+ * Latency of the lazy mode with and without the accelerator tables:
+ * building the name index, and the first and second lookup of names,
+ * against a full parse of the binary. The binary without the tables is
+ * a copy in which .debug_names and .gdb_index are renamed, so its name
+ * index comes from the DIEs. Link the binary with --gdb-index or build
+ * it with a producer of .debug_names to compare anything.
+ */
+#include "libdwarfparser.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <gelf.h>
+#include <iterator>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include "acceleratortable.h"
+#include "test.h"
+
+/**
+ * Copy filename to copyName with the first character of the names of
+ * the accelerator table sections replaced.
+ */
+static void copyWithoutTables(const std::string &filename,
+                              const std::string &copyName) {
+	std::ifstream in(filename, std::ios::binary);
+	std::vector<char> data((std::istreambuf_iterator<char>(in)),
+	                       std::istreambuf_iterator<char>());
+	std::vector<size_t> nameOffsets;
+	elf_version(EV_CURRENT);
+	Elf *elf = elf_memory(data.data(), data.size());
+	size_t shstrndx;
+	GElf_Shdr strings;
+	if (elf && elf_getshdrstrndx(elf, &shstrndx) == 0 &&
+	    gelf_getshdr(elf_getscn(elf, shstrndx), &strings)) {
+		Elf_Scn *scn = nullptr;
+		while ((scn = elf_nextscn(elf, scn)) != nullptr) {
+			GElf_Shdr shdr;
+			const char *name;
+			if (gelf_getshdr(scn, &shdr) &&
+			    (name = elf_strptr(elf, shstrndx, shdr.sh_name)) &&
+			    (!strcmp(name, ".debug_names") ||
+			     !strcmp(name, ".gdb_index"))) {
+				nameOffsets.push_back(strings.sh_offset + shdr.sh_name);
+			}
+		}
+	}
+	if (elf) {
+		elf_end(elf);
+	}
+	for (auto offset : nameOffsets) {
+		data[offset] = 'X';
+	}
+	std::ofstream out(copyName, std::ios::binary);
+	out.write(data.data(), data.size());
+}
+
+/**
+ * Print the average and maximum latency of looking up every name.
+ */
+static void lookupNames(SymbolManager &mgr,
+                        const std::vector<std::string> &names,
+                        const char *label) {
+	double total = 0;
+	double max = 0;
+	size_t found = 0;
+	for (auto &name : names) {
+		auto start = Clock::now();
+		found += (mgr.findSymbolByName<Symbol>(name) != nullptr);
+		double seconds = secondsSince(start);
+		total += seconds;
+		max = std::max(max, seconds);
+	}
+	printf("%-30s %9.1f us avg %9.1f us max, %zu of %zu found\n", label,
+	       total * 1e6 / names.size(), max * 1e6, found, names.size());
+}
+
+/**
+ * Build the lazy name index of filename and look up names twice.
+ */
+static void runLazy(const std::string &filename,
+                    const std::vector<std::string> &names,
+                    const std::string &label) {
+	auto start = Clock::now();
+	SymbolManager lazy;
+	DwarfParser::parseDwarfFromFilenameLazy(filename, &lazy);
+	printf("%-30s %9.3f ms\n", (label + " name index").c_str(),
+	       secondsSince(start) * 1e3);
+	lookupNames(lazy, names, (label + " first lookup").c_str());
+	lookupNames(lazy, names, (label + " second lookup").c_str());
+}
+
+int main(int argc, char **argv) {
+	TestOptions options(argc, argv);
+
+	int fd = open(options.binary.c_str(), O_RDONLY);
+	if (fd < 0) {
+		fprintf(stderr, "Unable to open %s\n", options.binary.c_str());
+		return 1;
+	}
+	std::vector<AcceleratorTable::Entry> entries;
+	auto start = Clock::now();
+	{
+		AcceleratorTable accelerator{fd};
+		if (!accelerator.read(entries)) {
+			printf("no accelerator tables, both runs scan the DIEs\n");
+		}
+	}
+	printf("%-30s %9.3f ms, %zu entries\n", "accelerator tables",
+	       secondsSince(start) * 1e3, entries.size());
+	close(fd);
+
+	start = Clock::now();
+	SymbolManager full;
+	options.parse(&full);
+	printf("%-30s %9.3f ms\n", "full parse", secondsSince(start) * 1e3);
+
+	// every 16th variable, so that the lookups hit many units
+	std::vector<std::string> names;
+	std::vector<std::string> varNames = full.getVarNames();
+	for (size_t i = 0; i < varNames.size(); i += 16) {
+		names.push_back(varNames[i]);
+	}
+	if (names.empty()) {
+		fprintf(stderr, "%s has no variables\n", options.binary.c_str());
+		return 1;
+	}
+	fflush(stdout);
+
+	std::string copyName = options.binary + ".notables";
+	copyWithoutTables(options.binary, copyName);
+	runLazy(options.binary, names, "with tables");
+	runLazy(copyName, names, "without tables");
+	lookupNames(full, names, "after full parse");
+	unlink(copyName.c_str());
+	return 0;
+}
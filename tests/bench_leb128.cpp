@@ -0,0 +1,186 @@
+/*
+ * LEB128 decoding on the .debug_info of a binary. First DwarfDecoder
+ * walks all DIEs, skipping their values or decoding every attribute, in
+ * MB of .debug_info per second. Then the LEB128 values of that
+ * .debug_info (abbreviation codes and DW_FORM_udata values) and synthetic
+ * values of 1 to 10 bytes are decoded and skipped, word at a time against
+ * bytewise, in MB of LEB128 data per second.
+ */
+#include "dwarfdecoder.h"
+#include "leb128.h"
+
+#include <cstdio>
+#include <fcntl.h>
+#include <libdwarf/dwarf.h>
+#include <unistd.h>
+#include <vector>
+
+#include "test.h"
+
+static const int rounds = 20;
+
+static void appendULEB128(std::vector<uint8_t> &buffer, uint64_t value) {
+	do {
+		uint8_t byte = value & 0x7f;
+		value >>= 7;
+		buffer.push_back(value ? (byte | 0x80) : byte);
+	} while (value);
+}
+
+/**
+ * @return count random values of 1 to maxLength bytes.
+ */
+static std::vector<uint8_t> makeValues(unsigned maxLength, size_t count) {
+	uint64_t state = 0x9e3779b97f4a7c15ULL;
+	std::vector<uint8_t> buffer;
+	for (size_t i = 0; i < count; i++) {
+		state ^= state << 13;
+		state ^= state >> 7;
+		state ^= state << 17;
+		unsigned length = 1 + state % maxLength;
+		for (unsigned byte = 1; byte < length; byte++) {
+			buffer.push_back(0x80 | ((state >> (byte * 5)) & 0x7f));
+		}
+		buffer.push_back((state >> 32) & 0x7f);
+	}
+	return buffer;
+}
+
+/**
+ * @return MB per second of rounds runs of loop over size bytes, loop
+ * returns a checksum.
+ */
+template<typename Loop>
+static double measure(size_t size, Loop loop) {
+	uint64_t sum = 0;
+	auto start = Clock::now();
+	for (int i = 0; i < rounds; i++) {
+		sum += loop();
+	}
+	double seconds = secondsSince(start);
+	if (sum == 1) {
+		printf("unlikely checksum\n");
+	}
+	return (double)size * rounds / seconds / 1e6;
+}
+
+/**
+ * Walk all DIEs, with all their attributes if decode is set, and append
+ * the abbreviation codes and DW_FORM_udata values to values if given.
+ * @return Number of DIEs.
+ */
+static uint64_t walkDies(const DwarfDecoder &decoder, bool decode,
+                         std::vector<uint8_t> *values = nullptr) {
+	std::vector<DwarfDecoder::Attribute> attributes;
+	uint64_t count = 0;
+	for (auto &unit : decoder.getUnits()) {
+		DwarfDecoder::Die die;
+		uint64_t offset = unit.dieOffset;
+		while (offset < unit.end && decoder.getDie(unit, offset, die)) {
+			if (decode || values) {
+				decoder.getAttributes(die, attributes);
+			}
+			if (values) {
+				appendULEB128(*values, die.abbrev ?
+				              die.abbrev - unit.abbrevs->data() : 0);
+				for (auto &attribute : attributes) {
+					if (attribute.form == DW_FORM_udata) {
+						appendULEB128(*values, attribute.value);
+					}
+				}
+			}
+			offset = decoder.getNextOffset(die);
+			count++;
+		}
+	}
+	return count;
+}
+
+/**
+ * Print the decode and skip rates of count values in buffer.
+ */
+static void measureValues(const char *label,
+                          const std::vector<uint8_t> &buffer, size_t count) {
+	const uint8_t *begin = buffer.data();
+	const uint8_t *end = buffer.data() + buffer.size();
+	size_t skipped = count - count % 4;
+
+	double decodeBytewise = measure(buffer.size(), [&]() {
+		uint64_t sum = 0;
+		uint64_t value;
+		for (const uint8_t *pos = begin; pos < end;) {
+			pos += decodeULEB128Bytewise(pos, end, value);
+			sum += value;
+		}
+		return sum;
+	});
+	double decodeWord = measure(buffer.size(), [&]() {
+		uint64_t sum = 0;
+		uint64_t value;
+		for (const uint8_t *pos = begin; pos < end;) {
+			pos += decodeULEB128(pos, end, value);
+			sum += value;
+		}
+		return sum;
+	});
+	// skip runs of 4 values, as for the values of an abbreviation
+	double skipBytewise = measure(buffer.size(), [&]() {
+		const uint8_t *pos = begin;
+		for (size_t i = 0; i < skipped; i++) {
+			while (*pos++ & 0x80) {
+			}
+		}
+		return (uint64_t)(pos - begin);
+	});
+	double skipWord = measure(buffer.size(), [&]() {
+		const uint8_t *pos = begin;
+		for (size_t i = 0; i < skipped; i += 4) {
+			pos = skipLEB128(pos, end, 4);
+		}
+		return (uint64_t)(pos - begin);
+	});
+	printf("%-12s %9zu %16.0f %12.0f %14.0f %10.0f\n", label, count,
+	       decodeBytewise, decodeWord, skipBytewise, skipWord);
+}
+
+int main(int argc, char **argv) {
+	TestOptions options(argc, argv);
+
+	int fd = open(options.binary.c_str(), O_RDONLY);
+	if (fd < 0) {
+		fprintf(stderr, "Unable to open %s\n", options.binary.c_str());
+		return 1;
+	}
+	DwarfDecoder decoder(fd);
+	if (!decoder.isValid() || decoder.getUnits().empty()) {
+		fprintf(stderr, "%s has no .debug_info the decoder supports\n",
+		        options.binary.c_str());
+		close(fd);
+		return 1;
+	}
+	size_t infoSize = 0;
+	for (auto &unit : decoder.getUnits()) {
+		infoSize += unit.end - unit.offset;
+	}
+	std::vector<uint8_t> values;
+	uint64_t dies = walkDies(decoder, true, &values);
+	printf(".debug_info %.1f MB, %zu units, %lu DIEs\n", infoSize / 1e6,
+	       decoder.getUnits().size(), (unsigned long)dies);
+	printf("walk DIEs, skip values     %9.0f MB/s\n",
+	       measure(infoSize, [&]() { return walkDies(decoder, false); }));
+	printf("walk DIEs, decode all      %9.0f MB/s\n",
+	       measure(infoSize, [&]() { return walkDies(decoder, true); }));
+
+	printf("\nvalues           count  decode bytewise  decode word  "
+	       "skip bytewise  skip word  (MB/s)\n");
+	size_t count = 0;
+	for (auto byte : values) {
+		count += !(byte & 0x80);
+	}
+	measureValues(".debug_info", values, count);
+	measureValues("1 byte", makeValues(1, 1 << 20), 1 << 20);
+	measureValues("1-3 bytes", makeValues(3, 1 << 20), 1 << 20);
+	measureValues("1-10 bytes", makeValues(10, 1 << 20), 1 << 20);
+	close(fd);
+	return 0;
+}
@@ -0,0 +1,30 @@
+/*
+ * Load time and memory of parsing a binary: the symbol arena, the bytes
+ * per symbol and the maximum RSS of the process.
+ */
+#include "libdwarfparser.h"
+
+#include <cstdio>
+
+#include "test.h"
+
+int main(int argc, char **argv) {
+	TestOptions options(argc, argv);
+
+	long baseRSS = maxRSS();
+	auto start = Clock::now();
+	SymbolManager mgr;
+	options.parse(&mgr);
+	double seconds = secondsSince(start);
+
+	uint64_t symbols = mgr.numberOfSymbols();
+	size_t arena = mgr.getArenaSize();
+	printf("load time      %9.3f s\n", seconds);
+	printf("symbols        %9lu\n", (unsigned long)symbols);
+	printf("arena          %9zu KB\n", arena / 1024);
+	printf("arena/symbol   %9.1f bytes\n",
+	       symbols ? (double)arena / symbols : 0.0);
+	printf("max RSS        %9ld KB\n", maxRSS());
+	printf("RSS of parse   %9ld KB\n", maxRSS() - baseRSS);
+	return 0;
+}
@@ -0,0 +1,34 @@
+/*
+ * Load time of a binary with 1 worker thread and then twice as many up
+ * to one per core.
+ */
+#include "libdwarfparser.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <thread>
+
+#include "test.h"
+
+int main(int argc, char **argv) {
+	TestOptions options(argc, argv);
+	unsigned int cores = std::max(1u, std::thread::hardware_concurrency());
+
+	printf("threads   seconds  speedup   symbols\n");
+	double serialSeconds = 0;
+	for (unsigned int threads = 1;; threads = std::min(threads * 2, cores)) {
+		auto start = Clock::now();
+		SymbolManager mgr;
+		options.parse(&mgr, threads);
+		double seconds = secondsSince(start);
+		if (threads == 1) {
+			serialSeconds = seconds;
+		}
+		printf("%7u %9.3f %8.2f %9lu\n", threads, seconds,
+		       serialSeconds / seconds, (unsigned long)mgr.numberOfSymbols());
+		if (threads == cores) {
+			break;
+		}
+	}
+	return 0;
+}
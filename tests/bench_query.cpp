@@ -0,0 +1,90 @@
+/*
+ * Throughput of concurrent lookups in a SymbolManager, before and after
+ * freeze(): every thread looks up all variables by name, by id and by
+ * address.
+ */
+#include "libdwarfparser.h"
+
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "test.h"
+
+struct Query {
+	std::string name;
+	uint64_t id;
+	uint64_t address;
+};
+
+/**
+ * Run rounds over all queries in each of threads threads.
+ * @return Queries per second.
+ */
+static double run(SymbolManager &mgr, const std::vector<Query> &queries,
+                  unsigned int threads, unsigned int rounds) {
+	auto worker = [&]() {
+		size_t found = 0;
+		for (unsigned int round = 0; round < rounds; round++) {
+			for (auto &query : queries) {
+				found += (mgr.findVariableByName(query.name) != nullptr);
+				found += (mgr.findSymbolByID(query.id) != nullptr);
+				if (query.address) {
+					found += (mgr.symbolize(query.address).name != nullptr);
+				}
+			}
+		}
+		if (found == 0) {
+			printf("nothing found\n");
+		}
+	};
+
+	auto start = Clock::now();
+	std::vector<std::thread> workers;
+	for (unsigned int i = 0; i < threads; i++) {
+		workers.emplace_back(worker);
+	}
+	for (auto &thread : workers) {
+		thread.join();
+	}
+	return 3.0 * queries.size() * rounds * threads / secondsSince(start);
+}
+
+int main(int argc, char **argv) {
+	TestOptions options(argc, argv);
+
+	SymbolManager mgr;
+	options.parse(&mgr);
+	mgr.loadElfSymbols(options.binary);
+
+	std::vector<Query> queries;
+	for (auto &name : mgr.getVarNames()) {
+		Variable *variable = mgr.findVariableByName(name);
+		if (variable) {
+			queries.push_back(Query{name, variable->getID(),
+			                        mgr.getSymbolAddress(name)});
+		}
+	}
+	if (queries.empty()) {
+		fprintf(stderr, "%s has no variables\n", options.binary.c_str());
+		return 1;
+	}
+	unsigned int rounds = 2000000 / queries.size() + 1;
+	// builds the address index
+	mgr.symbolize(0);
+
+	printf("%zu variables, %u rounds\n", queries.size(), rounds);
+	printf("threads  queries/s mutable  queries/s frozen\n");
+	std::vector<double> mutableRates;
+	for (unsigned int threads = 1; threads <= 8; threads *= 2) {
+		mutableRates.push_back(run(mgr, queries, threads, rounds));
+	}
+	mgr.freeze();
+	size_t i = 0;
+	for (unsigned int threads = 1; threads <= 8; threads *= 2, i++) {
+		printf("%7u %17.0f %17.0f\n", threads, mutableRates[i],
+		       run(mgr, queries, threads, rounds));
+	}
+	return 0;
+}
@@ -0,0 +1,62 @@
+/*
+ * Input of the tests: one binary with the kinds of symbols pydwarfdb
+ * knows, spread over several compilation units.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+struct point {
+	int x, y;
+	unsigned flag : 3;
+};
+
+union value {
+	int i;
+	float f;
+};
+
+enum color { RED, GREEN = 5, BLUE };
+
+typedef struct point point_t;
+
+/* a different struct foo is defined in sample2.c */
+struct foo {
+	struct foo *next;
+	int a;
+};
+
+struct foo *fooList;
+int matrix[10][3];
+const char *names[] = {"a", "b"};
+/* only declared, pointers to it refer to the declaration */
+union opaque *opaqueValue;
+enum color defaultColor = BLUE;
+
+static int helper(int a) {
+	if (a > 3) {
+		return a * 2;
+	}
+	return a;
+}
+
+__attribute__((cold, noinline)) int fail(int a) {
+	if (a) {
+		abort();
+	}
+	return 1;
+}
+
+int otherUnit(void);
+
+int main(int argc, char **argv) {
+	point_t p = {argc, 2, 1};
+	union value v;
+	v.i = p.x;
+	for (int i = 0; i < argc; i++) {
+		if (helper(i) > 10) {
+			fail(i);
+		}
+	}
+	printf("%d %d %d %s\n", p.x, v.i, defaultColor, names[argc & 1]);
+	return matrix[0][0] + otherUnit();
+}
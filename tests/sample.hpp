@@ -0,0 +1,24 @@
+/*
+ * A class with nested types that is defined in two compilation units of
+ * the test binary, the second copy is merged into the first.
+ */
+#ifndef _SAMPLE_HPP_
+#define _SAMPLE_HPP_
+
+class Outer {
+public:
+	enum Mode { IDLE, BUSY };
+
+	struct Inner {
+		Inner *next;
+		short depth;
+	};
+
+	int method(int value);
+	static int instances;
+
+	Inner *first;
+	Mode mode;
+};
+
+#endif /* _SAMPLE_HPP_ */
@@ -0,0 +1,16 @@
+/*
+ * Second compilation unit of the test binary.
+ */
+
+/* same name, different layout than the struct foo of sample.c */
+struct foo {
+	struct foo *next;
+	long b;
+	char c[3];
+};
+
+struct foo *otherFooList;
+
+int otherUnit(void) {
+	return otherFooList ? (int)otherFooList->b : 0;
+}
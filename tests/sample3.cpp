@@ -0,0 +1,10 @@
+/*
+ * Third compilation unit of the test binary, uses class Outer.
+ */
+#include "sample.hpp"
+
+Outer outer;
+
+int useOuter() {
+	return outer.mode == Outer::BUSY ? outer.first->depth : 0;
+}
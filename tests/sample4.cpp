@@ -0,0 +1,12 @@
+/*
+ * Fourth compilation unit of the test binary, defines the methods of
+ * class Outer out of line.
+ */
+#include "sample.hpp"
+
+int Outer::instances = 1;
+
+int Outer::method(int value) {
+	Inner inner = {nullptr, (short)value};
+	return inner.depth + (mode == IDLE) + instances;
+}
@@ -0,0 +1,84 @@
+#ifndef _TEST_H_
+#define _TEST_H_
+
+#include "libdwarfparser.h"
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <sys/resource.h>
+
+/*
+ * Minimal checks for the test programs. A failed check prints its
+ * location and the test goes on, testResult() is the exit code.
+ */
+
+static int testFailures = 0;
+
+#define CHECK(cond) \
+	do { \
+		if (!(cond)) { \
+			std::cout << __FILE__ << ":" << __LINE__ << ": check failed: " \
+			          << #cond << std::endl; \
+			testFailures++; \
+		} \
+	} while (0)
+
+#define CHECK_EQUAL(a, b) \
+	do { \
+		auto valueA = (a); \
+		auto valueB = (b); \
+		if (!(valueA == valueB)) { \
+			std::cout << __FILE__ << ":" << __LINE__ << ": check failed: " \
+			          << #a << " == " << #b << " (" << valueA << " != " \
+			          << valueB << ")" << std::endl; \
+			testFailures++; \
+		} \
+	} while (0)
+
+inline int testResult() {
+	if (testFailures) {
+		std::cout << testFailures << " checks failed" << std::endl;
+		return 1;
+	}
+	return 0;
+}
+
+/**
+ * The command line of the tests and benchmarks: [binary [native]], the
+ * binary defaults to the one built from sample*, native parses it with
+ * the built-in decoder instead of libdwarf.
+ */
+struct TestOptions {
+	std::string binary;
+	bool native;
+
+	TestOptions(int argc, char **argv)
+		: binary((argc > 1) ? argv[1] : "sample"),
+		  native(argc > 2 && std::string(argv[2]) == "native") {}
+
+	/**
+	 * Parse the binary into mgr.
+	 */
+	void parse(SymbolManager *mgr, unsigned int threads = 1) const {
+		DwarfParser::parseDwarfFromFilename(this->binary, mgr, threads,
+		                                    this->native);
+	}
+};
+
+typedef std::chrono::steady_clock Clock;
+
+inline double secondsSince(Clock::time_point start) {
+	return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+/**
+ * @return The maximum resident set size of the process so far in KB.
+ */
+inline long maxRSS() {
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return usage.ru_maxrss;
+}
+
+#endif /* _TEST_H_ */
@@ -0,0 +1,189 @@
+/*
+ * Save a SymbolManager to a symbol database, load it into a second one
+ * and compare the symbols of both, by id and by the name lookups.
+ */
+#include "libdwarfparser.h"
+#include "symboldatabase.h"
+
+#include <cstdio>
+#include <string>
+
+#include "test.h"
+
+/**
+ * @return Id, name and size of the types variable refers to.
+ */
+static std::string describeType(Variable *variable) {
+	std::string description;
+	BaseType *type = variable->getBaseType();
+	for (int depth = 0; type && depth < 8; depth++) {
+		description += std::to_string(type->getID()) + " " +
+		               type->getName() + ":" +
+		               std::to_string(type->getByteSize()) + " ";
+		RefBaseType *ref = kind_cast<RefBaseType>(type);
+		type = ref ? ref->getBaseType() : nullptr;
+	}
+	return description;
+}
+
+static void compareBaseType(SymbolManager &a, SymbolManager &b,
+                            const std::string &name) {
+	BaseType *typeA = a.findBaseTypeByName(name);
+	BaseType *typeB = b.findBaseTypeByName(name);
+	CHECK(typeA != nullptr);
+	CHECK(typeB != nullptr);
+	if (!typeA || !typeB) {
+		return;
+	}
+	CHECK_EQUAL(typeA->getID(), typeB->getID());
+	CHECK(typeA->getKind() == typeB->getKind());
+	CHECK_EQUAL(typeA->getByteSize(), typeB->getByteSize());
+
+	Structured *structA = kind_cast<Structured>(typeA);
+	Structured *structB = kind_cast<Structured>(typeB);
+	if (!structA || !structB) {
+		return;
+	}
+	CHECK_EQUAL(structA->getMembers().size(), structB->getMembers().size());
+	for (auto member : structA->getMembers()) {
+		StructuredMember *other = structB->memberByName(member->getName());
+		CHECK(other != nullptr);
+		if (other) {
+			CHECK_EQUAL(member->getMemberLocation(), other->getMemberLocation());
+			CHECK_EQUAL(member->getBitSize(), other->getBitSize());
+			CHECK_EQUAL(member->getBaseType()->getID(),
+			            other->getBaseType()->getID());
+		}
+	}
+}
+
+/**
+ * The symbols of the loaded manager have the ids of the parsed ones.
+ */
+static void compareByID(SymbolManager &parsed, SymbolManager &loaded) {
+	for (auto &name : parsed.getVarNames()) {
+		Variable *expected = parsed.findVariableByName(name);
+		Variable *found = kind_cast<Variable>(
+			loaded.findSymbolByID(expected->getID()));
+		CHECK(found != nullptr);
+		if (found) {
+			CHECK_EQUAL(found->getName(), expected->getName());
+			CHECK_EQUAL(found->getLocation(), expected->getLocation());
+			CHECK_EQUAL(describeType(found), describeType(expected));
+		}
+	}
+
+	Variable *fooList = parsed.findVariableByName("fooList");
+	CHECK(fooList != nullptr);
+	Pointer *pointer = fooList ?
+		kind_cast<Pointer>(fooList->getBaseType()) : nullptr;
+	Structured *foo = pointer ?
+		kind_cast<Structured>(pointer->getBaseType()) : nullptr;
+	Structured *loadedFoo = foo ?
+		kind_cast<Structured>(loaded.findSymbolByID(foo->getID())) :
+		nullptr;
+	CHECK(loadedFoo != nullptr);
+	if (loadedFoo) {
+		for (auto member : {"next", "a"}) {
+			CHECK(loadedFoo->memberByName(member) != nullptr);
+			CHECK_EQUAL(loadedFoo->memberOffset(member),
+			            foo->memberOffset(member));
+		}
+	}
+
+	for (auto name : {"main", "fail", "otherUnit"}) {
+		Function *expected = parsed.findFunctionByName(name);
+		CHECK(expected != nullptr);
+		Function *found = expected ? kind_cast<Function>(
+			loaded.findSymbolByID(expected->getID())) : nullptr;
+		CHECK(found != nullptr);
+		if (found) {
+			CHECK_EQUAL(found->getAddress(), expected->getAddress());
+			CHECK_EQUAL(found->getRetTypeID(), expected->getRetTypeID());
+			CHECK_EQUAL(found->getParamList().size(),
+			            expected->getParamList().size());
+		}
+	}
+}
+
+int main(int argc, char **argv) {
+	TestOptions options(argc, argv);
+	std::string database = options.binary + ".test.db";
+	DatabaseKey key = DatabaseKey::fromFilename(options.binary);
+
+	SymbolManager parsed;
+	options.parse(&parsed);
+	CHECK(parsed.loadElfSymbols(options.binary) > 0);
+	parsed.addSysmapSymbol("sysmapSymbol", 0x1234, false);
+	parsed.addSysmapSymbol("privateSymbol", 0x5678, true);
+	parsed.saveDatabase(database, key);
+
+	SymbolManager loaded;
+	CHECK(loaded.loadDatabase(database, key));
+	CHECK_EQUAL(parsed.numberOfSymbols(), loaded.numberOfSymbols());
+	compareByID(parsed, loaded);
+
+	for (auto name : {"point", "value", "color", "int"}) {
+		compareBaseType(parsed, loaded, name);
+	}
+
+	RefBaseType *typedefA = parsed.findRefBaseTypeByName("point_t");
+	RefBaseType *typedefB = loaded.findRefBaseTypeByName("point_t");
+	CHECK(typedefA && typedefB);
+	if (typedefA && typedefB) {
+		CHECK_EQUAL(typedefA->getType(), typedefB->getType());
+	}
+
+	for (auto name : {"main", "fail", "otherUnit"}) {
+		Function *functionA = parsed.findFunctionByName(name);
+		Function *functionB = loaded.findFunctionByName(name);
+		CHECK(functionA && functionB);
+		if (functionA && functionB) {
+			CHECK_EQUAL(functionA->getAddress(), functionB->getAddress());
+			CHECK_EQUAL(functionA->getRanges().size(),
+			            functionB->getRanges().size());
+			CHECK_EQUAL(functionA->getParamList().size(),
+			            functionB->getParamList().size());
+		}
+	}
+
+	for (auto name : {"matrix", "names", "fooList", "otherFooList"}) {
+		Variable *variableA = parsed.findVariableByName(name);
+		Variable *variableB = loaded.findVariableByName(name);
+		CHECK(variableA && variableB);
+		if (variableA && variableB) {
+			CHECK_EQUAL(variableA->getLocation(), variableB->getLocation());
+		}
+	}
+
+	// elf and System.map symbols are in the name sections as well
+	for (auto name : {"main", "matrix"}) {
+		CHECK(parsed.getSymbolAddress(name) != 0);
+		CHECK_EQUAL(parsed.getSymbolAddress(name), loaded.getSymbolAddress(name));
+	}
+	CHECK_EQUAL(loaded.getElfSymbolAddress("main"),
+	            parsed.getElfSymbolAddress("main"));
+	CHECK_EQUAL(loaded.getFunctionAddress("main"),
+	            parsed.getFunctionAddress("main"));
+	CHECK_EQUAL(loaded.getSystemMapAddress("sysmapSymbol", true),
+	            (uint64_t)0x1234);
+	CHECK_EQUAL(loaded.getSystemMapAddress("privateSymbol", true),
+	            (uint64_t)0x5678);
+
+	uint64_t address = parsed.getElfSymbolAddress("main");
+	CHECK_EQUAL(loaded.getElfSymbolName(address), std::string("main"));
+	CHECK(loaded.isFunction(address));
+	AddressInfo info = loaded.symbolize(address + 1);
+	CHECK(info.name && *info.name == "main");
+	CHECK_EQUAL(info.offset, (uint64_t)1);
+	CHECK(info.function == loaded.findFunctionByName("main"));
+
+	// a different key does not load
+	SymbolManager stale;
+	DatabaseKey otherKey = key;
+	otherKey.mtime++;
+	CHECK(!stale.loadDatabase(database, otherKey));
+
+	remove(database.c_str());
+	return testResult();
+}
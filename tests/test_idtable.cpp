@@ -0,0 +1,79 @@
+/*
+ * IDTable: ids of DIEs and back for files of arbitrary file ids, the
+ * limits of the DIE offset and of the number of files, and concurrent
+ * first lookups of the same files.
+ *
+ * Usage: test_idtable, the binary argument of make check is ignored.
+ */
+#include "idtable.h"
+
+#include <thread>
+#include <vector>
+
+#include "test.h"
+
+static void checkRoundTrip(IDTable &table, uint64_t offset, uint32_t fileID) {
+	uint64_t id = table.getID(offset, fileID);
+	CHECK(id != 0);
+	IDTable::DwarfID die = table.getRevID(id);
+	CHECK_EQUAL(die.first, offset);
+	CHECK_EQUAL(die.second, fileID);
+}
+
+int main() {
+	IDTable table;
+	// file ids far apart, and ones the table has to grow for
+	for (uint32_t fileID : {7u, 1u, 100000u, 3u, 7u, 0u}) {
+		checkRoundTrip(table, 0, fileID);
+		checkRoundTrip(table, 0x1234, fileID);
+		checkRoundTrip(table, (1ULL << IDTable::offsetBits) - 1, fileID);
+	}
+	CHECK_EQUAL(table.getFiles().size(), (size_t)5);
+	CHECK_EQUAL(table.getFileIndex(100000), (uint32_t)3);
+	CHECK_EQUAL(table.getRevID(0).second, (uint32_t)0);
+	CHECK_EQUAL(table.getRevID(6ULL << IDTable::offsetBits).second, (uint32_t)0);
+
+	bool thrown = false;
+	try {
+		table.getID(1ULL << IDTable::offsetBits, 1);
+	} catch (DwarfException &) {
+		thrown = true;
+	}
+	CHECK(thrown);
+
+	IDTable full;
+	for (uint32_t i = 0; i < IDTable::maxFiles; i++) {
+		full.getFileIndex(i * 3);
+	}
+	CHECK_EQUAL(full.getFileIndex(3), (uint32_t)2);
+	thrown = false;
+	try {
+		full.getFileIndex(1);
+	} catch (DwarfException &) {
+		thrown = true;
+	}
+	CHECK(thrown);
+	CHECK_EQUAL(full.getFiles().size(), (size_t)IDTable::maxFiles);
+
+	// every thread sees the same index for a file
+	IDTable shared;
+	std::vector<std::vector<uint32_t>> seen(4);
+	std::vector<std::thread> threads;
+	for (size_t t = 0; t < seen.size(); t++) {
+		threads.emplace_back([&shared, &seen, t]() {
+			for (uint32_t fileID = 0; fileID < 1000; fileID++) {
+				seen[t].push_back(shared.getFileIndex(fileID));
+			}
+		});
+	}
+	for (auto &thread : threads) {
+		thread.join();
+	}
+	for (size_t t = 1; t < seen.size(); t++) {
+		CHECK(seen[t] == seen[0]);
+	}
+	for (uint32_t fileID = 0; fileID < 1000; fileID++) {
+		CHECK_EQUAL(shared.getRevID(shared.getID(1, fileID)).second, fileID);
+	}
+	return testResult();
+}
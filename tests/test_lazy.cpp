@@ -0,0 +1,108 @@
+/*
+ * Lookups of a lazy SymbolManager from several threads at once find the
+ * variables and functions of a full parse of the sample: variables with
+ * the same ids, locations and types, functions at the same addresses.
+ */
+#include "libdwarfparser.h"
+
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "test.h"
+
+/**
+ * Name and description of each symbol the lookups compare.
+ */
+typedef std::vector<std::pair<std::string, std::string>> Expected;
+
+/**
+ * @return Id, location and the kinds and names of the type chain of the
+ * variable name. The types are looked up by id, getBaseType() caches its
+ * result without a lock.
+ */
+static std::string describe(SymbolManager &mgr, const std::string &name) {
+	Variable *variable = mgr.findVariableByName(name);
+	if (!variable) {
+		return "none";
+	}
+	std::string description = std::to_string(variable->getID()) + " " +
+	                          std::to_string(variable->getLocation());
+	uint64_t type = variable->getTypeID();
+	for (int depth = 0; type && depth < 8; depth++) {
+		Symbol *sym = mgr.findSymbolByID(type);
+		description += " " + std::to_string((int)sym->getKind()) + ":" +
+		               sym->getName();
+		RefBaseType *ref = kind_cast<RefBaseType>(sym);
+		type = ref ? ref->getType() : 0;
+	}
+	return description;
+}
+
+/**
+ * Look up the variables and functions of expected in lazy, from the start
+ * index on so that the threads load different names first.
+ * @return Number of lookups that differ from expected.
+ */
+static int lookupAll(SymbolManager &lazy, const Expected &expected,
+                     size_t start) {
+	int differences = 0;
+	for (size_t i = 0; i < expected.size(); i++) {
+		auto &entry = expected[(start + i) % expected.size()];
+		std::string found;
+		if (entry.first.back() == ')') {
+			Function *function = lazy.findFunctionByName(
+				entry.first.substr(0, entry.first.size() - 2));
+			found = function ? std::to_string(function->getAddress()) : "none";
+		} else {
+			found = describe(lazy, entry.first);
+		}
+		differences += (found != entry.second);
+	}
+	return differences;
+}
+
+int main(int argc, char **argv) {
+	TestOptions options(argc, argv);
+
+	SymbolManager full;
+	options.parse(&full);
+	// top level variables of the sample in several units, and functions
+	Expected expected;
+	for (auto name : {"fooList", "matrix", "names", "opaqueValue",
+	                  "defaultColor", "otherFooList", "outer"}) {
+		expected.emplace_back(name, describe(full, name));
+		CHECK(expected.back().second != "none");
+	}
+	for (auto name : {"main", "fail", "otherUnit"}) {
+		Function *function = full.findFunctionByName(name);
+		CHECK(function != nullptr);
+		// the id is the one of the first declaration or definition seen,
+		// which differs between the lazy and the full parse
+		expected.emplace_back(std::string(name) + "()", function ?
+			std::to_string(function->getAddress()) : "none");
+	}
+
+	SymbolManager lazy;
+	DwarfParser::parseDwarfFromFilenameLazy(options.binary, &lazy);
+	std::vector<int> differences(4);
+	std::vector<std::thread> threads;
+	for (size_t t = 0; t < differences.size(); t++) {
+		threads.emplace_back([&, t]() {
+			differences[t] = lookupAll(lazy, expected,
+			                           t * expected.size() / differences.size());
+		});
+	}
+	for (auto &thread : threads) {
+		thread.join();
+	}
+	for (auto count : differences) {
+		CHECK_EQUAL(count, 0);
+	}
+
+	// and the same after loading the rest
+	lazy.freeze();
+	CHECK_EQUAL(lookupAll(lazy, expected, 0), 0);
+	return testResult();
+}
@@ -0,0 +1,162 @@
+/*
+ * The word at a time LEB128 functions of leb128.h against their bytewise
+ * definitions: values of 1 to 10 bytes, values ending at or cut off by
+ * the end of the buffer, signed values and skipping.
+ *
+ * Usage: test_leb128, the binary argument of make check is ignored.
+ */
+#include "leb128.h"
+
+#include <vector>
+
+#include "test.h"
+
+static uint64_t randomState = 0x9e3779b97f4a7c15ULL;
+
+static uint64_t random64() {
+	randomState ^= randomState << 13;
+	randomState ^= randomState >> 7;
+	randomState ^= randomState << 17;
+	return randomState;
+}
+
+/**
+ * @return A random LEB128 value of exactly length bytes, with padding
+ * bytes of value 0 for some of them.
+ */
+static std::vector<uint8_t> randomLEB128(size_t length) {
+	std::vector<uint8_t> bytes;
+	for (size_t i = 0; i < length; i++) {
+		uint8_t byte = (random64() % 4 == 0) ? 0 : random64() & 0x7f;
+		bytes.push_back((i + 1 < length) ? (byte | 0x80) : byte);
+	}
+	return bytes;
+}
+
+static std::vector<uint8_t> encodeSLEB128(int64_t value) {
+	std::vector<uint8_t> bytes;
+	while (true) {
+		uint8_t byte = value & 0x7f;
+		value >>= 7;
+		if ((value == 0 && !(byte & 0x40)) || (value == -1 && (byte & 0x40))) {
+			bytes.push_back(byte);
+			return bytes;
+		}
+		bytes.push_back(byte | 0x80);
+	}
+}
+
+/**
+ * Decode bytes followed by filler bytes, with end at every position from
+ * the start of the value to past the word that contains it.
+ */
+static void checkULEB128(const std::vector<uint8_t> &bytes, uint8_t filler) {
+	std::vector<uint8_t> buffer(bytes);
+	buffer.resize(bytes.size() + 16, filler);
+	for (size_t size = 0; size <= buffer.size(); size++) {
+		const uint8_t *end = buffer.data() + size;
+		uint64_t expected = 0;
+		uint64_t value = 0;
+		size_t expectedLength =
+			decodeULEB128Bytewise(buffer.data(), end, expected);
+		size_t length = decodeULEB128(buffer.data(), end, value);
+		CHECK_EQUAL(length, expectedLength);
+		CHECK_EQUAL(length, (size < bytes.size()) ? 0 : bytes.size());
+		if (length) {
+			CHECK_EQUAL(value, expected);
+		}
+	}
+}
+
+static void checkSLEB128(int64_t expected) {
+	std::vector<uint8_t> bytes = encodeSLEB128(expected);
+	std::vector<uint8_t> buffer(bytes);
+	buffer.resize(bytes.size() + 16, 0xff);
+	for (size_t size : {bytes.size() - 1, bytes.size(), buffer.size()}) {
+		int64_t value = 0;
+		size_t length = decodeSLEB128(buffer.data(), buffer.data() + size,
+		                              value);
+		CHECK_EQUAL(length, (size < bytes.size()) ? 0 : bytes.size());
+		if (length) {
+			CHECK_EQUAL(value, expected);
+		}
+	}
+}
+
+static void checkCompact() {
+	for (unsigned length = 1; length <= 8; length++) {
+		for (int i = 0; i < 1000; i++) {
+			uint64_t word = random64();
+			uint64_t expected = 0;
+			for (unsigned byte = 0; byte < length; byte++) {
+				expected |= ((word >> (byte * 8)) & 0x7f) << (byte * 7);
+			}
+			CHECK_EQUAL(compactLEB128Word(word, length), expected);
+		}
+	}
+}
+
+/**
+ * @return The position after count values, nullptr if there are less.
+ */
+static const uint8_t *skipBytewise(const uint8_t *pos, const uint8_t *end,
+                                   size_t count) {
+	uint64_t value;
+	for (; count; count--) {
+		size_t length = decodeULEB128Bytewise(pos, end, value);
+		if (!length) {
+			return nullptr;
+		}
+		pos += length;
+	}
+	return pos;
+}
+
+static void checkSkip() {
+	for (int i = 0; i < 200; i++) {
+		std::vector<uint8_t> buffer;
+		size_t values = random64() % 20;
+		for (size_t value = 0; value < values; value++) {
+			// mostly short values, as in .debug_info
+			std::vector<uint8_t> bytes =
+				randomLEB128((random64() % 3) ? 1 + random64() % 3 :
+				                                1 + random64() % 10);
+			buffer.insert(buffer.end(), bytes.begin(), bytes.end());
+		}
+		for (size_t size = 0; size <= buffer.size(); size++) {
+			const uint8_t *end = buffer.data() + size;
+			for (size_t count = 0; count <= values + 1; count++) {
+				CHECK(skipLEB128(buffer.data(), end, count) ==
+				      skipBytewise(buffer.data(), end, count));
+			}
+		}
+	}
+}
+
+int main() {
+	for (size_t length = 1; length <= 10; length++) {
+		for (int i = 0; i < 200; i++) {
+			std::vector<uint8_t> bytes = randomLEB128(length);
+			checkULEB128(bytes, 0x00);
+			checkULEB128(bytes, 0x80);
+		}
+	}
+	// all 64 bits, and bits beyond them that are dropped
+	checkULEB128({0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x01},
+	             0x00);
+	checkULEB128({0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x7f},
+	             0x80);
+
+	for (int64_t value : {0LL, 1LL, -1LL, 63LL, -64LL, 64LL, -65LL,
+	                      (long long)INT32_MAX, (long long)INT32_MIN,
+	                      (long long)INT64_MAX, (long long)INT64_MIN}) {
+		checkSLEB128(value);
+	}
+	for (int i = 0; i < 10000; i++) {
+		checkSLEB128((int64_t)random64() >> (random64() % 64));
+	}
+
+	checkCompact();
+	checkSkip();
+	return testResult();
+}
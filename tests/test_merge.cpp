@@ -0,0 +1,91 @@
+/*
+ * Merging of equal types of different compilation units: same named
+ * types that differ stay apart, and the nested types and methods of a
+ * merged class are still parsed. Serial and parallel parses agree.
+ * With native, only the built-in decoder is run.
+ */
+#include "libdwarfparser.h"
+
+#include <string>
+
+#include "test.h"
+
+/**
+ * @return The struct a pointer variable points to.
+ */
+static Structured *getPointedStruct(SymbolManager &mgr, const std::string &name) {
+	Variable *variable = mgr.findVariableByName(name);
+	if (!variable) {
+		return nullptr;
+	}
+	Pointer *pointer = kind_cast<Pointer>(variable->getBaseType());
+	return pointer ? kind_cast<Structured>(pointer->getBaseType()) : nullptr;
+}
+
+static void checkManager(SymbolManager &mgr) {
+	// two different struct foo
+	Structured *foo = getPointedStruct(mgr, "fooList");
+	Structured *otherFoo = getPointedStruct(mgr, "otherFooList");
+	CHECK(foo && otherFoo);
+	if (foo && otherFoo) {
+		CHECK(foo != otherFoo);
+		CHECK(foo->memberByName("a") != nullptr);
+		CHECK(foo->memberByName("b") == nullptr);
+		CHECK(otherFoo->memberByName("b") != nullptr);
+		CHECK_EQUAL(otherFoo->getByteSize(), (uint32_t)24);
+	}
+
+	// class Outer of sample3.cpp and sample4.cpp
+	Structured *outer = mgr.findBaseTypeByName<Structured>("Outer");
+	CHECK(outer != nullptr);
+	if (outer) {
+		CHECK(outer->memberByName("first") != nullptr);
+		CHECK(outer->memberByName("mode") != nullptr);
+		CHECK_EQUAL(outer->getMembers().size(),
+		            outer->memberByName("instances") ? (size_t)3 : (size_t)2);
+	}
+	Structured *inner = mgr.findBaseTypeByName<Structured>("Inner");
+	CHECK(inner != nullptr);
+	if (inner) {
+		CHECK_EQUAL(inner->getMembers().size(), (size_t)2);
+		CHECK(inner->memberByName("depth") != nullptr);
+	}
+	Enum *mode = mgr.findBaseTypeByName<Enum>("Mode");
+	CHECK(mode != nullptr);
+	if (mode) {
+		CHECK_EQUAL(mode->enumValue("BUSY"), (uint32_t)1);
+	}
+	// the definition refers to the declaration in the merged copy
+	uint64_t address = mgr.getElfSymbolAddress("_ZN5Outer6methodEi");
+	Function *method = mgr.findFunctionByAddress(address);
+	CHECK(address != 0);
+	CHECK(method && method->getName() == "method");
+	Variable *instances = mgr.findVariableByName("instances");
+	CHECK(instances != nullptr);
+	if (instances) {
+		CHECK(instances->getLocation() != 0);
+	}
+}
+
+int main(int argc, char **argv) {
+	TestOptions options(argc, argv);
+
+	for (bool native : {false, true}) {
+		if (!native && options.native) {
+			continue;
+		}
+		TestOptions run = options;
+		run.native = native;
+		SymbolManager serial;
+		run.parse(&serial);
+		serial.loadElfSymbols(options.binary);
+		checkManager(serial);
+
+		SymbolManager parallel;
+		run.parse(&parallel, 4);
+		parallel.loadElfSymbols(options.binary);
+		checkManager(parallel);
+		CHECK_EQUAL(serial.numberOfSymbols(), parallel.numberOfSymbols());
+	}
+	return testResult();
+}
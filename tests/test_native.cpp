@@ -0,0 +1,107 @@
+/*
+ * Differential test of the native .debug_info decoder: parse a binary
+ * with libdwarf and with DwarfDecoder and compare every symbol.
+ */
+#include "libdwarfparser.h"
+
+#include <fcntl.h>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+
+#include "test.h"
+
+/**
+ * @return All properties of sym that the parser fills in.
+ */
+static std::string describe(Symbol *sym) {
+	std::ostringstream out;
+	out << (int)sym->getKind() << " " << sym->getID() << " "
+	    << sym->getName();
+
+	// the size of a RefBaseType is the one of the type it refers to
+	if (RefBaseType *ref = kind_cast<RefBaseType>(sym)) {
+		out << " type " << ref->getType();
+	} else if (BaseType *type = kind_cast<BaseType>(sym)) {
+		out << " size " << type->getByteSize()
+		    << " encoding " << type->getEncoding();
+	}
+	if (Array *array = kind_cast<Array>(sym)) {
+		out << " length " << array->getLength();
+	}
+	if (Structured *structured = kind_cast<Structured>(sym)) {
+		for (auto member : structured->getMembers()) {
+			out << " member " << member->getName()
+			    << " " << member->getMemberLocation()
+			    << " " << member->getBitSize()
+			    << " " << member->getBitOffset()
+			    << " " << member->getTypeID();
+		}
+	}
+	if (Enum *enumType = kind_cast<Enum>(sym)) {
+		enumType->printEnumMembers(out);
+	}
+	if (Function *function = kind_cast<Function>(sym)) {
+		out << " address " << function->getAddress()
+		    << " returns " << function->getRetTypeID();
+		for (auto &range : function->getRanges()) {
+			out << " range " << range.first << "-" << range.second;
+		}
+		for (auto &param : function->getParamList()) {
+			out << " param " << param.first << " " << param.second;
+		}
+	}
+	if (Variable *variable = kind_cast<Variable>(sym)) {
+		out << " location " << variable->getLocation()
+		    << " type " << variable->getTypeID();
+	}
+	return out.str();
+}
+
+int main(int argc, char **argv) {
+	TestOptions options(argc, argv);
+
+	int fd = open(options.binary.c_str(), O_RDONLY);
+	CHECK(fd >= 0);
+	if (fd < 0) {
+		return testResult();
+	}
+	DwarfDecoder decoder(fd);
+	CHECK(decoder.isValid());
+	uint64_t end = decoder.getUnits().empty() ? 0 :
+	               decoder.getUnits().back().end;
+	close(fd);
+
+	SymbolManager libdwarf;
+	DwarfParser::parseDwarfFromFilename(options.binary, &libdwarf, 1, false);
+	libdwarf.freeze();
+	SymbolManager native;
+	DwarfParser::parseDwarfFromFilename(options.binary, &native, 1, true);
+	native.freeze();
+
+	CHECK(native.numberOfSymbols() > 0);
+	CHECK_EQUAL(libdwarf.numberOfSymbols(), native.numberOfSymbols());
+
+	// the only file of a manager has the index 1, its ids are the DIE
+	// offsets with that index in the upper bits
+	size_t compared = 0, differences = 0;
+	for (uint64_t offset = 0; offset < end; offset++) {
+		uint64_t id = (1ULL << IDTable::offsetBits) | offset;
+		Symbol *expected = libdwarf.findSymbolByID(id);
+		Symbol *found = native.findSymbolByID(id);
+		if (!expected && !found) {
+			continue;
+		}
+		std::string expectedText = expected ? describe(expected) : "none";
+		std::string foundText = found ? describe(found) : "none";
+		compared++;
+		if (expectedText != foundText && differences++ < 10) {
+			std::cout << "DIE 0x" << std::hex << offset << std::dec
+			          << "\n  libdwarf: " << expectedText
+			          << "\n  native:   " << foundText << std::endl;
+		}
+	}
+	CHECK(compared > 0);
+	CHECK_EQUAL(differences, (size_t)0);
+	return testResult();
+}
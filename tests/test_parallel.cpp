@@ -0,0 +1,57 @@
+/*
+ * A parallel parse creates the same symbols as a serial one: the same
+ * number of symbols and the same variables, at the same locations and
+ * of the same types.
+ */
+#include "libdwarfparser.h"
+
+#include <string>
+#include <vector>
+
+#include "test.h"
+
+/**
+ * @return Names and sizes of the type chain of variable.
+ */
+static std::string describeType(Variable *variable) {
+	std::string description;
+	BaseType *type = variable->getBaseType();
+	for (int depth = 0; type && depth < 8; depth++) {
+		description += type->getName() + ":" +
+		               std::to_string(type->getByteSize()) + " ";
+		RefBaseType *ref = dynamic_cast<RefBaseType *>(type);
+		type = ref ? ref->getBaseType() : nullptr;
+	}
+	return description;
+}
+
+static void compare(SymbolManager &serial, SymbolManager &parallel) {
+	CHECK(serial.numberOfSymbols() > 0);
+	CHECK_EQUAL(serial.numberOfSymbols(), parallel.numberOfSymbols());
+
+	std::vector<std::string> names = serial.getVarNames();
+	CHECK(!names.empty());
+	CHECK_EQUAL(names.size(), parallel.getVarNames().size());
+	for (auto &name : names) {
+		Variable *expected = serial.findVariableByName(name);
+		Variable *found = parallel.findVariableByName(name);
+		CHECK(expected && found);
+		if (expected && found) {
+			CHECK_EQUAL(expected->getLocation(), found->getLocation());
+			CHECK_EQUAL(describeType(expected), describeType(found));
+		}
+	}
+}
+
+int main(int argc, char **argv) {
+	TestOptions options(argc, argv);
+
+	SymbolManager serial;
+	options.parse(&serial);
+	for (unsigned int threads : {4, 0}) {
+		SymbolManager parallel;
+		options.parse(&parallel, threads);
+		compare(serial, parallel);
+	}
+	return testResult();
+}
@@ -0,0 +1,144 @@
+/*
+ * Save a SymbolManager to a symbol database and compare the lookups of a
+ * SymbolStore on it with the manager.
+ */
+#include "libdwarfparser.h"
+#include "symboldatabase.h"
+#include "symbolstore.h"
+
+#include <cstdio>
+#include <string>
+
+#include "test.h"
+
+/**
+ * The stored symbols have the ids of the parsed ones.
+ */
+static void compareByID(SymbolManager &parsed, const SymbolStore &store) {
+	for (auto &name : parsed.getVarNames()) {
+		Variable *variable = parsed.findVariableByName(name);
+		StoredSymbol stored = store.findSymbolByID(variable->getID());
+		CHECK(stored.isValid());
+		if (stored.isValid()) {
+			CHECK(stored.getKind() == DatabaseKind::Variable);
+			CHECK_EQUAL(std::string(stored.getName()), variable->getName());
+			CHECK_EQUAL(stored.getAddress(), variable->getLocation());
+			BaseType *type = variable->getBaseType();
+			CHECK_EQUAL(stored.getType().getID(), type ? type->getID() : 0);
+		}
+	}
+
+	Variable *fooList = parsed.findVariableByName("fooList");
+	CHECK(fooList != nullptr);
+	Pointer *pointer = fooList ?
+		kind_cast<Pointer>(fooList->getBaseType()) : nullptr;
+	Structured *foo = pointer ?
+		kind_cast<Structured>(pointer->getBaseType()) : nullptr;
+	CHECK(foo != nullptr);
+	if (foo) {
+		StoredSymbol storedFoo = store.findSymbolByID(foo->getID());
+		CHECK(storedFoo.getKind() == DatabaseKind::Struct);
+		CHECK_EQUAL(storedFoo.getByteSize(), foo->getByteSize());
+		CHECK_EQUAL(storedFoo.getMemberCount(), (uint32_t)2);
+		for (auto member : {"next", "a"}) {
+			StoredSymbol stored = storedFoo.memberByName(member);
+			CHECK(stored.isValid());
+			CHECK_EQUAL(stored.getMemberLocation(),
+			            (uint64_t)foo->memberOffset(member));
+		}
+		CHECK(!storedFoo.memberByName("b").isValid());
+	}
+
+	for (auto name : {"main", "fail", "otherUnit"}) {
+		Function *function = parsed.findFunctionByName(name);
+		CHECK(function != nullptr);
+		if (function) {
+			StoredSymbol stored = store.findSymbolByID(function->getID());
+			CHECK(stored.getKind() == DatabaseKind::Function);
+			CHECK_EQUAL(stored.getAddress(), function->getAddress());
+		}
+	}
+	CHECK(!store.findSymbolByID(0).isValid());
+}
+
+int main(int argc, char **argv) {
+	TestOptions options(argc, argv);
+	std::string database = options.binary + ".store.db";
+	DatabaseKey key = DatabaseKey::fromFilename(options.binary);
+
+	SymbolManager parsed;
+	options.parse(&parsed);
+	CHECK(parsed.loadElfSymbols(options.binary) > 0);
+	parsed.saveDatabase(database, key);
+
+	SymbolStore store(database);
+	CHECK(store.matches(key));
+	CHECK_EQUAL(store.numberOfSymbols(), parsed.numberOfSymbols());
+	compareByID(parsed, store);
+
+	Structured *point = parsed.findBaseTypeByName<Structured>("point");
+	StoredSymbol storedPoint = store.findBaseTypeByName("point",
+	                                                    DatabaseKind::Struct);
+	CHECK(point != nullptr);
+	CHECK(storedPoint.isValid());
+	if (point && storedPoint.isValid()) {
+		CHECK_EQUAL(storedPoint.getID(), point->getID());
+		CHECK_EQUAL(storedPoint.getByteSize(), point->getByteSize());
+		CHECK_EQUAL(storedPoint.getMemberCount(),
+		            (uint32_t)point->getMembers().size());
+		for (auto member : point->getMembers()) {
+			StoredSymbol stored = storedPoint.memberByName(member->getName());
+			CHECK(stored.isValid());
+			CHECK_EQUAL(stored.getMemberLocation(),
+			            (uint64_t)member->getMemberLocation());
+			CHECK_EQUAL(stored.getBitSize(), member->getBitSize());
+			CHECK_EQUAL(stored.getType().getID(),
+			            member->getBaseType()->getID());
+		}
+		CHECK_EQUAL(std::string(storedPoint.memberByOffset(4).getName()),
+		            std::string("y"));
+	}
+	CHECK_EQUAL(store.findBaseTypeByName("int").getByteSize(), (uint32_t)4);
+	CHECK(store.findBaseTypeByName("color").getKind() == DatabaseKind::Enum);
+
+	StoredSymbol storedTypedef = store.findRefBaseTypeByName("point_t");
+	CHECK(storedTypedef.isValid());
+	CHECK(storedTypedef.getKind() == DatabaseKind::Typedef);
+	CHECK_EQUAL(storedTypedef.getType().getID(), storedPoint.getID());
+
+	for (auto name : {"main", "fail", "otherUnit"}) {
+		Function *function = parsed.findFunctionByName(name);
+		StoredSymbol stored = store.findFunctionByName(name);
+		CHECK(function != nullptr);
+		CHECK(stored.isValid());
+		if (function) {
+			CHECK_EQUAL(stored.getAddress(), function->getAddress());
+			CHECK_EQUAL(store.getSymbolAddress(name),
+			            parsed.getSymbolAddress(name));
+		}
+	}
+
+	for (auto name : {"matrix", "names", "fooList", "otherFooList"}) {
+		Variable *variable = parsed.findVariableByName(name);
+		StoredSymbol stored = store.findVariableByName(name);
+		CHECK(variable != nullptr);
+		CHECK(stored.isValid());
+		if (variable) {
+			CHECK_EQUAL(stored.getAddress(), variable->getLocation());
+			CHECK(store.getSymbolAddress(name) != 0);
+			CHECK_EQUAL(store.getSymbolAddress(name),
+			            parsed.getSymbolAddress(name));
+		}
+	}
+
+	CHECK(store.getElfSymbolAddress("main") != 0);
+	CHECK_EQUAL(store.getElfSymbolAddress("main"),
+	            parsed.getElfSymbolAddress("main"));
+	CHECK_EQUAL(store.getFunctionAddress("main"),
+	            parsed.getFunctionAddress("main"));
+	CHECK(!store.findFunctionByName("missing").isValid());
+	CHECK_EQUAL(store.getSymbolAddress("missing"), (uint64_t)0);
+
+	remove(database.c_str());
+	return testResult();
+}